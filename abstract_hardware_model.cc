@@ -82,6 +82,23 @@ void gpgpu_functional_sim_config::reg_options(class OptionParser * opp)
    option_parser_register(opp, "-gpgpu_ptx_inst_debug_thread_uid", OPT_INT32, &g_ptx_inst_debug_thread_uid, 
                "Thread UID for executed instructions' debug output", 
                "1");
+   option_parser_register(opp, "-gpgpu_simt_reconvergence", OPT_CSTR, &m_simt_model_opt, 
+               "SIMT divergence model: pdom (post-dominator stack) or "
+               "its[:<yield interval>] (independent thread scheduling with convergence barriers)", 
+               "pdom");
+}
+
+void gpgpu_functional_sim_config::init()
+{
+   m_simt_model = SIMT_PDOM_STACK;
+   m_its_yield_interval = 64;
+   if( strncmp(m_simt_model_opt,"its",3) == 0 ) {
+      m_simt_model = SIMT_CONVERGENCE_BARRIER;
+      sscanf(m_simt_model_opt,"its:%u",&m_its_yield_interval);
+   } else if( strcmp(m_simt_model_opt,"pdom") != 0 ) {
+      printf("GPGPU-Sim: unknown SIMT reconvergence model \"%s\" (expected pdom or its[:<yield interval>])\n", m_simt_model_opt);
+      abort();
+   }
 }
 
 void gpgpu_functional_sim_config::ptx_set_tex_cache_linesize(unsigned linesize)
@@ -548,6 +565,8 @@ kernel_info_t::kernel_info_t( dim3 gridDim, dim3 blockDim, class function_info *
     m_next_cta.z=0;
     m_next_tid=m_next_cta;
     m_num_cores_running=0;
+    m_stream_uid=0;
+    m_num_sim_insn=0;
     m_uid = m_next_uid++;
     m_param_mem = new memory_space_impl<8192>("param",64*1024);
 }
@@ -745,6 +764,267 @@ void simt_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, addre
         ptx_file_line_stats_add_warp_divergence(top_pc, 1); 
     }
 }
+//--------------------------------------   convergence_barrier_stack  ------------------------------------------------
+convergence_barrier_stack::convergence_barrier_stack( unsigned wid, unsigned warpSize, unsigned yield_interval )
+    : simt_stack(wid,warpSize)
+{
+    m_yield_interval = yield_interval;
+    reset();
+}
+
+void convergence_barrier_stack::reset()
+{
+    for (unsigned i = 0; i < MAX_WARP_SIZE_SIMT_STACK; i++)
+        m_thread_pc[i] = (address_type)-1;
+    m_done.set();
+    m_active.reset();
+    m_active_pc = (address_type)-1;
+    m_num_barriers = 0;
+    m_issued_since_switch = 0;
+}
+
+void convergence_barrier_stack::launch( address_type start_pc, const simt_mask_t &active_mask )
+{
+    reset();
+    for (unsigned i = 0; i < m_warp_size; i++) {
+        if (active_mask.test(i)) {
+            m_thread_pc[i] = start_pc;
+            m_done.reset(i);
+        }
+    }
+    m_active = active_mask;
+    m_active_pc = start_pc;
+}
+
+const simt_mask_t &convergence_barrier_stack::get_active_mask() const
+{
+    return m_active;
+}
+
+// the innermost armed barrier the sub-warp takes part in
+address_type convergence_barrier_stack::barrier_rp( const simt_mask_t &mask ) const
+{
+    for (int b = (int)m_num_barriers - 1; b >= 0; b--) {
+        if ((m_barrier[b].m_participants & mask).any())
+            return m_barrier[b].m_pc;
+    }
+    return (address_type)-1;
+}
+
+void convergence_barrier_stack::get_pdom_stack_top_info( unsigned *pc, unsigned *rpc ) const
+{
+    *pc = m_active_pc;
+    *rpc = barrier_rp(m_active);
+}
+
+unsigned convergence_barrier_stack::get_rp() const
+{
+    return barrier_rp(m_active);
+}
+
+simt_mask_t convergence_barrier_stack::waiting_mask() const
+{
+    simt_mask_t waiting;
+    for (unsigned b = 0; b < m_num_barriers; b++) {
+        simt_mask_t live = m_barrier[b].m_participants & ~m_done;
+        for (unsigned i = 0; i < m_warp_size; i++) {
+            if (live.test(i) && m_thread_pc[i] == m_barrier[b].m_pc)
+                waiting.set(i);
+        }
+    }
+    return waiting;
+}
+
+void convergence_barrier_stack::release_barriers()
+{
+    for (unsigned b = 0; b < m_num_barriers; ) {
+        simt_mask_t live = m_barrier[b].m_participants & ~m_done;
+        bool all_arrived = true;
+        for (unsigned i = 0; i < m_warp_size && all_arrived; i++) {
+            if (live.test(i) && m_thread_pc[i] != m_barrier[b].m_pc)
+                all_arrived = false;
+        }
+        if (all_arrived) {
+            // keep the remaining barriers in arming order (innermost last)
+            for (unsigned k = b + 1; k < m_num_barriers; k++)
+                m_barrier[k-1] = m_barrier[k];
+            m_num_barriers--;
+        } else {
+            b++;
+        }
+    }
+}
+
+void convergence_barrier_stack::select_subwarp( address_type prefer_pc )
+{
+    simt_mask_t live = ~m_done;
+    simt_mask_t ready = live & ~waiting_mask();
+    while (ready.none() && live.any()) {
+        // every live thread waits on a barrier that cannot complete (a
+        // participant is held at another one): drop the innermost barrier
+        assert(m_num_barriers > 0);
+        m_num_barriers--;
+        ready = live & ~waiting_mask();
+    }
+    if (ready.none()) {
+        m_active.reset();
+        m_active_pc = (address_type)-1;
+        return;
+    }
+
+    // group the ready threads by PC
+    address_type group_pc[MAX_WARP_SIZE_SIMT_STACK];
+    simt_mask_t  group_mask[MAX_WARP_SIZE_SIMT_STACK];
+    unsigned n = 0;
+    for (unsigned i = 0; i < m_warp_size; i++) {
+        if (!ready.test(i))
+            continue;
+        unsigned g = 0;
+        while (g < n && group_pc[g] != m_thread_pc[i])
+            g++;
+        if (g == n) {
+            group_pc[n] = m_thread_pc[i];
+            group_mask[n].reset();
+            n++;
+        }
+        group_mask[g].set(i);
+    }
+
+    if (n == 1) {
+        m_issued_since_switch = 0;
+        m_active = group_mask[0];
+        m_active_pc = group_pc[0];
+        return;
+    }
+
+    // bar.sync counts whole warps in the timing model: hold a partial
+    // sub-warp back from it while other threads can still catch up
+    bool eligible[MAX_WARP_SIZE_SIMT_STACK];
+    bool any_eligible = false;
+    for (unsigned g = 0; g < n; g++) {
+        eligible[g] = !(ptx_fetch_inst(group_pc[g])->op == BARRIER_OP && group_mask[g] != live);
+        any_eligible |= eligible[g];
+    }
+    if (!any_eligible) {
+        for (unsigned g = 0; g < n; g++)
+            eligible[g] = true;
+    }
+
+    // keep issuing the current sub-warp until it has had its share, then
+    // rotate to the next PC so spinning threads cannot starve the others;
+    // otherwise take the lowest PC, which tends to reach the barriers first
+    bool yield = m_yield_interval && (m_issued_since_switch >= m_yield_interval);
+    int pick = -1;
+    if (!yield) {
+        for (unsigned g = 0; g < n && pick < 0; g++) {
+            if (eligible[g] && group_pc[g] == prefer_pc)
+                pick = g;
+        }
+    } else {
+        for (unsigned g = 0; g < n; g++) {
+            if (eligible[g] && group_pc[g] > prefer_pc && (pick < 0 || group_pc[g] < group_pc[pick]))
+                pick = g;
+        }
+    }
+    if (pick < 0) {
+        for (unsigned g = 0; g < n; g++) {
+            if (eligible[g] && (pick < 0 || group_pc[g] < group_pc[pick]))
+                pick = g;
+        }
+    }
+    assert(pick >= 0);
+    if (yield || group_pc[pick] != prefer_pc)
+        m_issued_since_switch = 0;
+    m_active = group_mask[pick];
+    m_active_pc = group_pc[pick];
+}
+
+void convergence_barrier_stack::update( simt_mask_t &thread_done, addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op )
+{
+    assert( next_pc.size() == m_warp_size );
+
+    const address_type null_pc = -1;
+    simt_mask_t executed = m_active;
+    address_type top_pc = m_active_pc; // the pc of the instruction just executed
+
+    // the functional threads hold the authoritative PCs
+    for (unsigned i = 0; i < m_warp_size; i++) {
+        if (thread_done.test(i))
+            m_done.set(i);
+        else
+            m_thread_pc[i] = next_pc[i];
+    }
+
+    simt_mask_t issued = executed & ~m_done;
+    address_type cont_pc = null_pc;
+    bool warp_diverged = false;
+    for (unsigned i = 0; i < m_warp_size; i++) {
+        if (!issued.test(i))
+            continue;
+        if (cont_pc == null_pc)
+            cont_pc = m_thread_pc[i];
+        else if (m_thread_pc[i] != cont_pc)
+            warp_diverged = true;
+    }
+
+    if (warp_diverged) {
+        ptx_file_line_stats_add_warp_divergence(top_pc, 1); 
+        if (recvg_pc != null_pc && next_inst_op != CALL_OPS && next_inst_op != RET_OPS) {
+            // arm a convergence barrier at the immediate post-dominator
+            unsigned b = 0;
+            while (b < m_num_barriers && m_barrier[b].m_pc != recvg_pc)
+                b++;
+            if (b < m_num_barriers) {
+                m_barrier[b].m_participants |= issued;
+            } else if (m_num_barriers < MAX_CONVERGENCE_BARRIERS) {
+                m_barrier[m_num_barriers].m_pc = recvg_pc;
+                m_barrier[m_num_barriers].m_participants = issued;
+                m_num_barriers++;
+            }
+        }
+        cont_pc = null_pc;
+    }
+
+    release_barriers();
+    m_issued_since_switch++;
+    select_subwarp(cont_pc);
+}
+
+void convergence_barrier_stack::print( FILE *fout ) const
+{
+    simt_mask_t waiting = waiting_mask();
+    simt_mask_t listed;
+    unsigned k = 0;
+    for (unsigned i = 0; i < m_warp_size; i++) {
+        if (m_done.test(i) || listed.test(i))
+            continue;
+        simt_mask_t group;
+        for (unsigned j = i; j < m_warp_size; j++) {
+            if (!m_done.test(j) && m_thread_pc[j] == m_thread_pc[i])
+                group.set(j);
+        }
+        listed |= group;
+        if ( k==0 ) {
+            fprintf(fout, "w%02d %1u ", m_warp_id, k );
+        } else {
+            fprintf(fout, "    %1u ", k );
+        }
+        for (unsigned j=0; j<m_warp_size; j++)
+            fprintf(fout, "%c", (group.test(j)?'1':'0') );
+        const char *state = (group == m_active)? "A" : ((group & waiting).any()? "W" : "R"); // active, waiting at barrier, ready
+        fprintf(fout, " pc: 0x%03x, state:%s, ", m_thread_pc[i], state );
+        ptx_print_insn( m_thread_pc[i], fout );
+        fprintf(fout,"\n");
+        k++;
+    }
+    for (unsigned b = 0; b < m_num_barriers; b++) {
+        fprintf(fout, "    b%u ", b );
+        for (unsigned j=0; j<m_warp_size; j++)
+            fprintf(fout, "%c", (m_barrier[b].m_participants.test(j)?'1':'0') );
+        fprintf(fout, " rp: 0x%03x\n", m_barrier[b].m_pc );
+    }
+}
+
 //-----------------------------------------------   core_t   ------------------------------------------------------------
 void core_t::execute_warp_inst_t(warp_inst_t &inst, unsigned warpId)
 {
@@ -771,6 +1051,7 @@ void core_t::updateSIMTStack(unsigned warpId, warp_inst_t * inst)
     simt_mask_t    thread_done;
     addr_vector_t  next_pc;
     unsigned       wtid = warpId * m_warp_size;
+    next_pc.reserve(m_warp_size);
     for (unsigned i = 0; i < m_warp_size; i++) {
         if( ptx_thread_done(wtid+i) ) {
             thread_done.set(i);
@@ -806,9 +1087,14 @@ void core_t::deleteSIMTStack()
 
 void core_t::initilizeSIMTStack(unsigned warp_count, unsigned warp_size)// warp num, warp size
 { 
+    const gpgpu_functional_sim_config &config = m_gpu->get_config();
     m_simt_stack = new simt_stack*[warp_count];
-    for (unsigned i = 0; i < warp_count; ++i) 
-        m_simt_stack[i] = new simt_stack(i,warp_size);
+    for (unsigned i = 0; i < warp_count; ++i) {
+        if (config.get_simt_model() == SIMT_CONVERGENCE_BARRIER)
+            m_simt_stack[i] = new convergence_barrier_stack(i,warp_size,config.get_its_yield_interval());
+        else
+            m_simt_stack[i] = new simt_stack(i,warp_size);
+    }
     m_warp_size = warp_size;
     m_warp_count = warp_count;
 }
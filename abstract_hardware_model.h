@@ -79,7 +79,10 @@ enum uarch_op_t {
    BARRIER_OP,
    MEMORY_BARRIER_OP,//?? differ form LOAD_OP
    CALL_OPS,
-   RET_OPS
+   RET_OPS,
+   TENSOR_CORE_OP,
+   BULK_COPY_OP,      // asynchronous global -> shared copy, streamed by the ldst unit
+   BULK_COPY_WAIT_OP  // wait for the bulk copies of a barrier
 };
 typedef enum uarch_op_t op_type;// 指令操作类型
 
@@ -110,7 +113,8 @@ enum operation_pipeline_t {
     UNKOWN_OP,
     SP__OP,
     SFU__OP,
-    MEM__OP
+    MEM__OP,
+    TENSOR__OP
 };
 typedef enum operation_pipeline_t operation_pipeline; //流水线操作类型
 enum mem_operation_t {
@@ -207,6 +211,13 @@ public:
    unsigned get_uid() const { return m_uid; }
    std::string name() const;
 
+   // stream the kernel was launched from (used for stream priorities)
+   void set_stream_uid( unsigned uid ) { m_stream_uid = uid; }
+   unsigned get_stream_uid() const { return m_stream_uid; }
+   // thread instructions committed by the timing model
+   void inc_sim_insn( unsigned n ) { m_num_sim_insn += n; }
+   unsigned long long get_sim_insn() const { return m_num_sim_insn; }
+
    std::list<class ptx_thread_info *> &active_threads() { return m_active_threads; }
    class memory_space *get_param_memory() { return m_param_mem; }
 
@@ -225,6 +236,8 @@ private:
    dim3 m_next_tid;//下一个线程id
 
    unsigned m_num_cores_running;//记录多少个core=sm，在运行本kernel
+   unsigned m_stream_uid;
+   unsigned long long m_num_sim_insn;
 
    std::list<class ptx_thread_info *> m_active_threads; // 线程信息的list
    class memory_space *m_param_mem;                     // 参数内存
@@ -276,18 +289,24 @@ typedef std::bitset<MAX_WARP_SIZE> active_mask_t; // 32位的掩码
 typedef std::bitset<MAX_WARP_SIZE_SIMT_STACK> simt_mask_t;
 typedef std::vector<address_type> addr_vector_t;  // 地址向量vector
 
+enum simt_reconvergence_model {
+   SIMT_PDOM_STACK = 0,         // immediate post-dominator reconvergence stack
+   SIMT_CONVERGENCE_BARRIER     // per-thread PCs, sub-warps meet at convergence barriers
+};
+
 class simt_stack {
 public:
     simt_stack( unsigned wid,  unsigned warpSize);// warp size做实验用户可调，不大于32即可
+    virtual ~simt_stack() {}
 
-    void reset();
-    void launch( address_type start_pc, const simt_mask_t &active_mask );
-    void update( simt_mask_t &thread_done, addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op );
+    virtual void reset();
+    virtual void launch( address_type start_pc, const simt_mask_t &active_mask );
+    virtual void update( simt_mask_t &thread_done, addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op );
 
-    const simt_mask_t &get_active_mask() const;
-    void     get_pdom_stack_top_info( unsigned *pc, unsigned *rpc ) const;
-    unsigned get_rp() const;
-    void     print(FILE*fp) const;
+    virtual const simt_mask_t &get_active_mask() const;
+    virtual void     get_pdom_stack_top_info( unsigned *pc, unsigned *rpc ) const;
+    virtual unsigned get_rp() const;
+    virtual void     print(FILE*fp) const;
 
 protected:
     unsigned m_warp_id;//- 每个warp有一个simt stack。
@@ -312,6 +331,49 @@ protected:
     std::deque<simt_stack_entry> m_stack; // stack是一个entry的双向队列
 }; // end of class
 
+// Independent thread scheduling: every thread keeps its own PC and the warp
+// issues one sub-warp (the threads sharing a PC) at a time.  Divergent
+// branches arm a convergence barrier at their immediate post-dominator;
+// threads that reach it wait until every participant still alive arrives.
+// All state is fixed-size, so update() does no allocation.
+class convergence_barrier_stack : public simt_stack {
+public:
+    convergence_barrier_stack( unsigned wid, unsigned warpSize, unsigned yield_interval );
+
+    virtual void reset();
+    virtual void launch( address_type start_pc, const simt_mask_t &active_mask );
+    virtual void update( simt_mask_t &thread_done, addr_vector_t &next_pc, address_type recvg_pc, op_type next_inst_op );
+
+    virtual const simt_mask_t &get_active_mask() const;
+    virtual void     get_pdom_stack_top_info( unsigned *pc, unsigned *rpc ) const;
+    virtual unsigned get_rp() const;
+    virtual void     print(FILE*fp) const;
+
+private:
+    static const unsigned MAX_CONVERGENCE_BARRIERS = MAX_WARP_SIZE_SIMT_STACK;
+
+    struct convergence_barrier {
+        address_type m_pc;          // reconvergence point (immediate post-dominator)
+        simt_mask_t  m_participants;
+    };
+
+    simt_mask_t waiting_mask() const;
+    void release_barriers();
+    void select_subwarp( address_type prefer_pc );
+    address_type barrier_rp( const simt_mask_t &mask ) const;
+
+    address_type m_thread_pc[MAX_WARP_SIZE_SIMT_STACK];
+    simt_mask_t  m_done;          // exited (or never launched) threads
+    simt_mask_t  m_active;        // sub-warp issued next
+    address_type m_active_pc;
+
+    convergence_barrier m_barrier[MAX_CONVERGENCE_BARRIERS];
+    unsigned m_num_barriers;
+
+    unsigned m_yield_interval;    // switch sub-warps after this many issues while others are ready, 0 = never
+    unsigned m_issued_since_switch;
+};
+
 #define GLOBAL_HEAP_START 0x80000000    // 全局内存起始地址？？？
    // start allocating from this address (lower values used for allocating globals in .ptx file)
 #define SHARED_MEM_SIZE_MAX (64*1024) //64k
@@ -407,6 +469,10 @@ public:
     int         get_ptx_inst_debug_thread_uid() const { return g_ptx_inst_debug_thread_uid; }
     unsigned    get_texcache_linesize() const { return m_texcache_linesize; }
 
+    void init();
+    enum simt_reconvergence_model get_simt_model() const { return m_simt_model; }
+    unsigned get_its_yield_interval() const { return m_its_yield_interval; }
+
 private:
     // PTX options
     int m_ptx_convert_to_ptxplus;
@@ -419,6 +485,10 @@ private:
     int   g_ptx_inst_debug_thread_uid;
 
     unsigned m_texcache_linesize;
+
+    char *m_simt_model_opt;
+    enum simt_reconvergence_model m_simt_model;
+    unsigned m_its_yield_interval;
 };
 
 class gpgpu_t {
@@ -558,6 +628,9 @@ MA_TUP_BEGIN( mem_access_type ) \
    MA_TUP( INST_ACC_R ), \
    MA_TUP( L1_WR_ALLOC_R ), \
    MA_TUP( L2_WR_ALLOC_R ), \
+   MA_TUP( DMA_ACC_R ), \
+   MA_TUP( DMA_ACC_W ), \
+   MA_TUP( PTW_ACC_R ), \
    MA_TUP( NUM_MEM_ACCESS_TYPE ) \
 MA_TUP_END( mem_access_type )
 // GLOBAL_ACC_R          0  
@@ -571,7 +644,10 @@ MA_TUP_END( mem_access_type )
 // INST_ACC_R            8  
 // L1_WR_ALLOC_R         9  
 // L2_WR_ALLOC_R        10 
-// NUM_MEM_ACCESS_TYPE  11 
+// DMA_ACC_R            11 
+// DMA_ACC_W            12 
+// PTW_ACC_R            13 
+// NUM_MEM_ACCESS_TYPE  14 
 #define MA_TUP_BEGIN(X) enum X {
 #define MA_TUP(X) X
 #define MA_TUP_END(X) };
@@ -716,6 +792,9 @@ public:
         is_vectorout=0;
         space = memory_space_t();
         cache_op = CACHE_UNDEFINED;
+        is_reduction = false;
+        mma_m = mma_n = mma_k = 0;
+        bulk_copy_barrier = 0;
         latency = 1;
         initiation_interval = 1;
         for( unsigned i=0; i < MAX_REG_OPERANDS; i++ ) {
@@ -767,6 +846,9 @@ public:
     unsigned        data_size;          // what is the size of the word being operated on?
     memory_space_t  space;
     cache_operator_type cache_op;
+    bool            is_reduction;       // red.*: atomic whose old value is not returned
+    unsigned        mma_m, mma_n, mma_k; // shape of a matrix multiply-accumulate, 0 otherwise
+    unsigned        bulk_copy_barrier;   // barrier a bulk copy arrives on or a bulk copy wait waits for
 
 protected:
     bool            m_decoded;
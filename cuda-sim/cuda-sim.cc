@@ -33,6 +33,8 @@
 #include "ptx.tab.h"
 #include "ptx_sim.h"
 #include <stdio.h>
+#include <pthread.h>
+#include <sys/time.h>
 
 #include "opcodes.h"
 #include "../statwrapper.h"
@@ -251,7 +253,6 @@ void function_info::ptx_assemble()
    bool modified = false; 
    do {
       find_dominators();
-      find_idominators();
       modified = connect_break_targets(); 
    } while (modified == true);
 
@@ -264,7 +265,6 @@ void function_info::ptx_assemble()
       print_dominators();
    }
    find_postdominators();
-   find_ipostdominators();
    if ( g_debug_execution>=50 ) {
       print_postdominators();
       print_ipostdominators();
@@ -281,6 +281,15 @@ void function_info::ptx_assemble()
    m_assembled = true;
 }
 
+void function_info::find_callees( std::vector<function_info*> &callees ) const
+{
+   for( std::list<ptx_instruction*>::const_iterator i=m_instructions.begin(); i != m_instructions.end(); i++ ) {
+      const ptx_instruction *pI = *i;
+      if( pI->get_opcode() == CALL_OP && pI->func_addr().is_function_address() ) 
+         callees.push_back( pI->func_addr().get_symbol()->get_pc() );
+   }
+}
+
 addr_t shared_to_generic( unsigned smid, addr_t addr )
 {
    assert( addr < SHARED_MEM_SIZE_MAX );
@@ -468,7 +477,7 @@ std::string ptx_get_insn_str( address_type pc )
 
 void ptx_instruction::set_fp_or_int_archop(){
     oprnd_type=UN_OP;
-	if((m_opcode == MEMBAR_OP)||(m_opcode == SSY_OP )||(m_opcode == BRA_OP) || (m_opcode == BAR_OP) || (m_opcode == RET_OP) || (m_opcode == RETP_OP) || (m_opcode == NOP_OP) || (m_opcode == EXIT_OP) || (m_opcode == CALLP_OP) || (m_opcode == CALL_OP)){
+	if((m_opcode == MEMBAR_OP)||(m_opcode == SSY_OP )||(m_opcode == BRA_OP) || (m_opcode == BAR_OP) || (m_opcode == RET_OP) || (m_opcode == RETP_OP) || (m_opcode == NOP_OP) || (m_opcode == EXIT_OP) || (m_opcode == CALLP_OP) || (m_opcode == CALL_OP) || (m_opcode == CP_ASYNC_BULK_OP) || (m_opcode == CP_ASYNC_BULK_WAIT_OP)){
 			// do nothing
 	}else if((m_opcode == CVT_OP || m_opcode == SET_OP || m_opcode == SLCT_OP)){
 		if(get_type2()==F16_TYPE || get_type2()==F32_TYPE || get_type2() == F64_TYPE || get_type2() == FF64_TYPE){
@@ -483,7 +492,7 @@ void ptx_instruction::set_fp_or_int_archop(){
 }
 void ptx_instruction::set_mul_div_or_other_archop(){
     sp_op=OTHER_OP;
-	if((m_opcode != MEMBAR_OP) && (m_opcode != SSY_OP) && (m_opcode != BRA_OP) && (m_opcode != BAR_OP) && (m_opcode != EXIT_OP) && (m_opcode != NOP_OP) && (m_opcode != RETP_OP) && (m_opcode != RET_OP) && (m_opcode != CALLP_OP) && (m_opcode != CALL_OP)){
+	if((m_opcode != MEMBAR_OP) && (m_opcode != SSY_OP) && (m_opcode != BRA_OP) && (m_opcode != BAR_OP) && (m_opcode != EXIT_OP) && (m_opcode != NOP_OP) && (m_opcode != RETP_OP) && (m_opcode != RET_OP) && (m_opcode != CALLP_OP) && (m_opcode != CALL_OP) && (m_opcode != CP_ASYNC_BULK_OP) && (m_opcode != CP_ASYNC_BULK_WAIT_OP)){
 		if(get_type()==F32_TYPE || get_type() == F64_TYPE || get_type() == FF64_TYPE){
 			switch(get_opcode()){
 				case MUL_OP:
@@ -600,8 +609,11 @@ void ptx_instruction::set_opcode_and_latency()
    case BREAKADDR_OP: op = BRANCH_OP; break;
    case TEX_OP: op = LOAD_OP; mem_op=TEX; break;
    case ATOM_OP: op = LOAD_OP; break;
+   case RED_OP: op = LOAD_OP; is_reduction = true; break;
    case BAR_OP: op = BARRIER_OP; break;
    case MEMBAR_OP: op = MEMORY_BARRIER_OP; break;
+   case CP_ASYNC_BULK_OP: op = BULK_COPY_OP; break;
+   case CP_ASYNC_BULK_WAIT_OP: op = BULK_COPY_WAIT_OP; break;
    case CALL_OP:
    {
        if(m_is_printf)
@@ -619,6 +631,19 @@ void ptx_instruction::set_opcode_and_latency()
            break;
    }
    case RET_OP: case RETP_OP:  op = RET_OPS;break;
+   case MMA_OP:
+       // timed as a double precision MAD on the SP pipeline; when the core has
+       // tensor core units the tensor core model replaces this at issue
+       op = TENSOR_CORE_OP;
+       latency = dp_latency[3];
+       initiation_interval = dp_init[3];
+       switch( m_mma_shape ) {
+       case M8N8K4_OPTION: mma_m = 8; mma_n = 8; mma_k = 4; break;
+       default:
+           printf("GPGPU-Sim PTX: ERROR ** mma without a supported shape (%s)\n", m_source.c_str());
+           abort();
+       }
+       break;
    case ADD_OP: case ADDP_OP: case ADDC_OP: case SUB_OP: case SUBC_OP:
 	   //ADD,SUB latency
 	   switch(get_type()){
@@ -831,8 +856,10 @@ void ptx_instruction::pre_decode()
          cache_op = CACHE_ALL;
       else if( m_opcode == ST_OP ) 
          cache_op = CACHE_WRITE_BACK;
-      else if( m_opcode == ATOM_OP ) 
+      else if( m_opcode == ATOM_OP || m_opcode == RED_OP ) 
          cache_op = CACHE_GLOBAL;
+      else if( m_opcode == CP_ASYNC_BULK_OP ) 
+         cache_op = CACHE_GLOBAL; // streamed into shared memory, not allocated in L1
       break;
    }
 
@@ -873,13 +900,15 @@ void ptx_instruction::pre_decode()
             //assert(m == 0); //only support 1 vector operand (for textures) right now
             is_vectorout = 1;
             unsigned num_elem = o.get_vect_nelem();
-            if( num_elem >= 1 ) in[0] = o.reg1_num();
-            if( num_elem >= 2 ) in[1] = o.reg2_num();
-            if( num_elem >= 3 ) in[2] = o.reg3_num();
-            if( num_elem >= 4 ) in[3] = o.reg4_num();
+            // several vector sources (mma fragments) are packed one after the other
+            assert( m + num_elem <= MAX_REG_OPERANDS );
+            if( num_elem >= 1 && m < 4 ) in[m] = o.reg1_num();
+            if( num_elem >= 2 && m+1 < 4 ) in[m+1] = o.reg2_num();
+            if( num_elem >= 3 && m+2 < 4 ) in[m+2] = o.reg3_num();
+            if( num_elem >= 4 && m+3 < 4 ) in[m+3] = o.reg4_num();
             for (int i = 0; i < num_elem; i++) 
-               arch_reg.src[i] = o.arch_reg_num(i);
-            m+=4;
+               arch_reg.src[m+i] = o.arch_reg_num(i);
+            m+=num_elem;
          }
       }
    }
@@ -934,6 +963,29 @@ void ptx_instruction::pre_decode()
       }
    }
 
+   // cp.async.bulk.shared.global [dst], [src], size, bar; and cp.async.bulk.wait bar;
+   // the barrier is an immediate; the copy reads the address registers of both memory operands
+   if( m_opcode == CP_ASYNC_BULK_OP || m_opcode == CP_ASYNC_BULK_WAIT_OP ) {
+      const operand_info &bar = (m_opcode == CP_ASYNC_BULK_OP)? src3() : dst();
+      if( !bar.is_literal() ) {
+         printf("GPGPU-Sim PTX: ERROR ** %s needs an immediate barrier (%s)\n", get_opcode_cstr(), m_source.c_str());
+         abort();
+      }
+      bulk_copy_barrier = bar.get_literal_value().u32;
+   }
+   if( m_opcode == CP_ASYNC_BULK_OP ) {
+      const operand_info &d = dst();
+      const operand_info &s = src1();
+      if( d.is_memory_operand() && d.get_symbol()->type()->get_key().is_reg() ) {
+         ar1 = d.reg_num();
+         arch_reg.src[4] = d.arch_reg_num();
+      }
+      if( s.is_memory_operand() && s.get_symbol()->type()->get_key().is_reg() ) {
+         ar2 = s.reg_num();
+         arch_reg.src[5] = s.arch_reg_num();
+      }
+   }
+
    // get reconvergence pc
    reconvergence_pc = get_converge_point(pc);
 
@@ -1258,7 +1310,7 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
       insn_memory_op = pI->has_memory_read() ? memory_load : memory_store;
    }
    
-   if ( pI->get_opcode() == ATOM_OP ) {
+   if ( pI->get_opcode() == ATOM_OP || pI->get_opcode() == RED_OP ) {
       insn_memaddr = last_eaddr();
       insn_space = last_space();
       inst.add_callback( lane_id, last_callback().function, last_callback().instruction, this );
@@ -1266,6 +1318,13 @@ void ptx_thread_info::ptx_exec_inst( warp_inst_t &inst, unsigned lane_id)
       insn_data_size = datatype2size(to_type);
    }
 
+   if ( pI->get_opcode() == CP_ASYNC_BULK_OP ) {
+      // the ldst unit streams data_size bytes from this global address into shared memory;
+      // the space is left undefined so the bulk copy bypasses the regular memory stages
+      insn_memaddr = last_eaddr();
+      insn_data_size = pI->src2().get_literal_value().u32;
+   }
+
    if (pI->get_opcode() == TEX_OP) {
       inst.set_addr(lane_id, last_eaddr() );
       assert( inst.space == last_space() );
@@ -1954,6 +2013,49 @@ struct rec_pts find_reconvergence_points( function_info *finfo )
    return tmp;
 }
 
+static pthread_mutex_t g_ptx_assemble_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned g_ptx_num_assembled = 0;
+static double g_ptx_assemble_time = 0;
+
+/// Assemble a kernel and every function it can call, and find their 
+/// reconvergence points, the first time the kernel is launched. The loader 
+/// only parses, so libraries with many kernels do not pay for the analysis 
+/// of the ones that never run. Instruction addresses are therefore handed out 
+/// in launch order rather than file order.
+void gpgpu_ptx_assemble_kernel( function_info *entry )
+{
+   pthread_mutex_lock(&g_ptx_assemble_lock);
+   if( entry->is_assembled() ) {
+      pthread_mutex_unlock(&g_ptx_assemble_lock);
+      return;
+   }
+   struct timeval start, end;
+   gettimeofday(&start, NULL);
+   unsigned num_assembled = 0;
+   std::set<function_info*> visited;
+   std::vector<function_info*> worklist(1, entry);
+   while( !worklist.empty() ) {
+      function_info *f = worklist.back();
+      worklist.pop_back();
+      if( f == NULL || !visited.insert(f).second ) 
+         continue;
+      if( !f->is_assembled() && !f->is_extern() ) {
+         gpgpu_ptx_assemble( f->get_name(), f );
+         find_reconvergence_points( f );
+         num_assembled++;
+      }
+      f->find_callees(worklist);
+   }
+   gettimeofday(&end, NULL);
+   double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1e6;
+   g_ptx_num_assembled += num_assembled;
+   g_ptx_assemble_time += elapsed;
+   printf("GPGPU-Sim PTX: assembled %u functions for \'%s\' in %.3f s (%u functions, %.3f s in total)\n",
+          num_assembled, entry->get_name().c_str(), elapsed, g_ptx_num_assembled, g_ptx_assemble_time );
+   fflush(stdout);
+   pthread_mutex_unlock(&g_ptx_assemble_lock);
+}
+
 address_type get_return_pc( void *thd )
 {
     // function call return
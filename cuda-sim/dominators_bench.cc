@@ -0,0 +1,254 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt, Ali Bakhoda, Wilson W.L. Fung,
+// George L. Yuan
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Standalone driver for the dominator analysis run by ptx_assemble(): builds
+// synthetic flow graphs, times find_idoms() the way find_dominators() and
+// find_postdominators() call it, and checks the immediate (post)dominators and 
+// the dom()/pdom() tree numbering against the iterative set-intersection 
+// algorithm (Muchnick Fig 7.14/7.15) it replaced. Build with 
+// 'make dominators_bench' in cuda-sim.
+//
+// usage: dominators_bench [num_random_graphs [max_random_blocks [unrolled_blocks [seed]]]]
+
+#include "ptx_ir.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+static double elapsed_ms( const struct timeval &start, const struct timeval &end )
+{
+   return (end.tv_sec - start.tv_sec)*1000.0 + (end.tv_usec - start.tv_usec)/1000.0;
+}
+
+static void add_edge( std::vector<basic_block_t*> &bbs, int from, int to )
+{
+   bbs[from]->successor_ids.insert(to);
+   bbs[to]->predecessor_ids.insert(from);
+}
+
+static std::vector<basic_block_t*> new_graph( unsigned n )
+{
+   std::vector<basic_block_t*> bbs;
+   for (unsigned i = 0; i < n; i++) 
+      bbs.push_back( new basic_block_t(i, NULL, NULL, i == 0, i == n-1) );
+   return bbs;
+}
+
+static void delete_graph( std::vector<basic_block_t*> &bbs )
+{
+   for (unsigned i = 0; i < bbs.size(); i++) 
+      delete bbs[i];
+   bbs.clear();
+}
+
+// every block falls through to the next one, so all blocks are reachable from
+// the entry and reach the exit, plus random forward branches and loops
+static std::vector<basic_block_t*> random_graph( unsigned n )
+{
+   std::vector<basic_block_t*> bbs = new_graph(n);
+   for (unsigned i = 0; i < n-1; i++) {
+      add_edge(bbs, i, i+1);
+      if (n > 2 && rand() % 3 == 0) 
+         add_edge(bbs, i, 1 + rand() % (n-1));
+   }
+   return bbs;
+}
+
+// an unrolled loop body: a chain of if-then and if-then-else regions with 
+// early exits to the epilogue and a back edge around the whole body
+static std::vector<basic_block_t*> unrolled_graph( unsigned n )
+{
+   std::vector<basic_block_t*> bbs = new_graph(n);
+   unsigned epilogue = n-2;
+   unsigned b = 1;
+   add_edge(bbs, 0, 1);
+   while (b + 3 < epilogue) {
+      if (b % 2) { // if-then
+         add_edge(bbs, b, b+1);
+         add_edge(bbs, b, b+2);
+         add_edge(bbs, b+1, b+2);
+         b += 2;
+      } else {     // if-then-else with an early exit
+         add_edge(bbs, b, b+1);
+         add_edge(bbs, b, b+2);
+         add_edge(bbs, b+1, b+3);
+         add_edge(bbs, b+2, b+3);
+         add_edge(bbs, b+2, epilogue);
+         b += 3;
+      }
+   }
+   for (; b < epilogue; b++) 
+      add_edge(bbs, b, b+1);
+   add_edge(bbs, epilogue-1, 1); // loop back
+   add_edge(bbs, epilogue, n-1);
+   return bbs;
+}
+
+// the dominator sets of the iterative algorithm the analysis used before, 
+// immediate dominators are the closest strict dominators
+static void ref_idoms( const std::vector<basic_block_t*> &bbs, int root, bool reverse, 
+                       std::vector<std::set<int> > &doms, std::vector<int> &idom )
+{
+   unsigned n = bbs.size();
+   std::set<int> all;
+   for (unsigned i = 0; i < n; i++) 
+      all.insert(i);
+   doms.assign(n, all);
+   doms[root].clear();
+   doms[root].insert(root);
+   bool change = true;
+   while (change) {
+      change = false;
+      for (unsigned k = 0; k < n; k++) {
+         int h = reverse? n-1-k : k;
+         if (h == root) 
+            continue;
+         const std::set<int> &in = reverse? bbs[h]->successor_ids : bbs[h]->predecessor_ids;
+         std::set<int> T = all;
+         for (std::set<int>::const_iterator p = in.begin(); p != in.end(); p++) {
+            std::set<int> tmp;
+            for (std::set<int>::const_iterator t = T.begin(); t != T.end(); t++) 
+               if (doms[*p].count(*t)) 
+                  tmp.insert(*t);
+            T.swap(tmp);
+         }
+         T.insert(h);
+         if (T != doms[h]) {
+            doms[h] = T;
+            change = true;
+         }
+      }
+   }
+   idom.assign(n, -1);
+   for (unsigned h = 0; h < n; h++) {
+      if ((int)h == root) 
+         continue;
+      unsigned depth = 0;
+      for (std::set<int>::const_iterator d = doms[h].begin(); d != doms[h].end(); d++) {
+         if (*d != (int)h && doms[*d].size() > depth) {
+            depth = doms[*d].size();
+            idom[h] = *d;
+         }
+      }
+   }
+}
+
+// fill in the basic blocks as find_dominators()/find_postdominators() do
+static double run_idoms( std::vector<basic_block_t*> &bbs, bool reverse, std::vector<int> &idom )
+{
+   struct timeval start, end;
+   int root = reverse? bbs.size()-1 : 0;
+   std::vector<int> pre, post;
+   gettimeofday(&start, NULL);
+   find_idoms(bbs, root, reverse, idom);
+   number_dom_tree(idom, root, pre, post);
+   for (unsigned i = 0; i < bbs.size(); i++) {
+      if (reverse) {
+         bbs[i]->immediatepostdominator_id = idom[i];
+         bbs[i]->pdom_pre = pre[i];
+         bbs[i]->pdom_post = post[i];
+      } else {
+         bbs[i]->immediatedominator_id = idom[i];
+         bbs[i]->dom_pre = pre[i];
+         bbs[i]->dom_post = post[i];
+      }
+   }
+   gettimeofday(&end, NULL);
+   return elapsed_ms(start, end);
+}
+
+static double run_ref_idoms( const std::vector<basic_block_t*> &bbs, bool reverse, 
+                             std::vector<std::set<int> > &doms, std::vector<int> &idom )
+{
+   struct timeval start, end;
+   gettimeofday(&start, NULL);
+   ref_idoms(bbs, reverse? bbs.size()-1 : 0, reverse, doms, idom);
+   gettimeofday(&end, NULL);
+   return elapsed_ms(start, end);
+}
+
+// returns the number of mismatches against the reference
+static unsigned check_graph( std::vector<basic_block_t*> &bbs, bool reverse, double &new_ms, double &ref_ms )
+{
+   std::vector<int> idom, ref_idom;
+   std::vector<std::set<int> > doms;
+   new_ms += run_idoms(bbs, reverse, idom);
+   ref_ms += run_ref_idoms(bbs, reverse, doms, ref_idom);
+   unsigned errors = 0;
+   for (unsigned b = 0; b < bbs.size(); b++) {
+      if (idom[b] != ref_idom[b]) {
+         printf("ERROR ** %s of block %u is %d, expected %d\n", reverse? "ipdom" : "idom", b, idom[b], ref_idom[b]);
+         errors++;
+      }
+      for (unsigned a = 0; a < bbs.size(); a++) {
+         bool d = reverse? bbs[a]->pdom(bbs[b]) : bbs[a]->dom(bbs[b]);
+         if (d != (doms[b].count(a) != 0)) {
+            printf("ERROR ** block %u %s block %u is %d, expected %d\n", a, reverse? "pdom" : "dom", b, d, !d);
+            errors++;
+         }
+      }
+   }
+   return errors;
+}
+
+int main( int argc, char *argv[] )
+{
+   unsigned num_graphs = argc > 1 ? atoi(argv[1]) : 1000;
+   unsigned max_blocks = argc > 2 ? atoi(argv[2]) : 64;
+   unsigned unrolled_blocks = argc > 3 ? atoi(argv[3]) : 1500;
+   unsigned seed = argc > 4 ? atoi(argv[4]) : 1;
+   srand(seed);
+   unsigned errors = 0;
+
+   double new_ms = 0, ref_ms = 0;
+   for (unsigned g = 0; g < num_graphs; g++) {
+      std::vector<basic_block_t*> bbs = random_graph(2 + rand() % (max_blocks-1));
+      errors += check_graph(bbs, false, new_ms, ref_ms);
+      errors += check_graph(bbs, true, new_ms, ref_ms);
+      delete_graph(bbs);
+   }
+   printf("%u random graphs of 2-%u blocks: dominators+postdominators %.3f ms, iterative %.3f ms\n", 
+          num_graphs, max_blocks, new_ms, ref_ms);
+
+   if (unrolled_blocks >= 8) {
+      std::vector<basic_block_t*> bbs = unrolled_graph(unrolled_blocks);
+      double dom_ms = 0, dom_ref_ms = 0, pdom_ms = 0, pdom_ref_ms = 0;
+      errors += check_graph(bbs, false, dom_ms, dom_ref_ms);
+      errors += check_graph(bbs, true, pdom_ms, pdom_ref_ms);
+      printf("unrolled graph of %u blocks: dominators %.3f ms (iterative %.3f ms), postdominators %.3f ms (iterative %.3f ms)\n", 
+             unrolled_blocks, dom_ms, dom_ref_ms, pdom_ms, pdom_ref_ms);
+      delete_graph(bbs);
+   }
+
+   if (errors) {
+      printf("FAILED: %u mismatches against the iterative algorithm\n", errors);
+      return 1;
+   }
+   printf("PASSED\n");
+   return 0;
+}
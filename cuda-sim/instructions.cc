@@ -884,13 +884,18 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread )
    bool data_ready = false;
 
    // Get operand info of sources and destination
-   const operand_info &dst  = pI->dst();     // d
-   const operand_info &src1 = pI->src1();    // a
-   const operand_info &src2 = pI->src2();    // b
+   // red.space.operation.type a, b; has no destination register: the
+   // address is the first operand and the value the second
+   const bool is_red = (pI->get_opcode() == RED_OP);
+   const operand_info &dst  = pI->dst();                        // d
+   const operand_info &src1 = is_red ? pI->dst()  : pI->src1(); // a
+   const operand_info &src2 = is_red ? pI->src1() : pI->src2(); // b
 
    // Get operand values
    src1_data = thread->get_operand_value(src1, src1, to_type, thread, 1);        // a
-   if (dst.get_symbol()->type()){
+   if (is_red) {
+      src2_data = thread->get_operand_value(src2, src2, to_type, thread, 1);     // b
+   } else if (dst.get_symbol()->type()){
       src2_data = thread->get_operand_value(src2, dst, to_type, thread, 1);      // b
    } else {
 	   //This is the case whent he first argument (dest) is '_'
@@ -926,7 +931,7 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread )
    // Copy value pointed to in operand 'a' into register 'd'
    // (i.e. copy src1_data to dst)
    mem->read(effective_address,size/8,&data.s64);
-   if (dst.get_symbol()->type()){
+   if (!is_red && dst.get_symbol()->type()){
 	   thread->set_operand_value(dst, data, to_type, thread, pI);                         // Write value into register 'd'
    }
 
@@ -1177,17 +1182,15 @@ void atom_callback( const inst_t* inst, ptx_thread_info* thread )
 }
 
 // atom_impl will now result in a callback being called in mem_ctrl_pop (gpu-sim.c)
-void atom_impl( const ptx_instruction *pI, ptx_thread_info *thread )
-{   
-   // SYNTAX
-   // atom.space.operation.type d, a, b[, c]; (now read in callback)
-
+// shared by atom and red: compute the effective address held in operand 'src1'
+// and defer the read-modify-write to atom_callback, which runs when the
+// request reaches memory
+static void atom_red_setup( const ptx_instruction *pI, ptx_thread_info *thread, const operand_info &src1 )
+{
    // obtain memory space of the operation 
    memory_space_t space = pI->get_space(); 
 
    // get the memory address
-   const operand_info &src1 = pI->src1();
-   // const operand_info &dst  = pI->dst();  // not needed for effective address calculation 
    unsigned i_type = pI->get_type();
    ptx_reg_t src1_data;
    src1_data = thread->get_operand_value(src1, src1, i_type, thread, 1);
@@ -1221,6 +1224,13 @@ void atom_impl( const ptx_instruction *pI, ptx_thread_info *thread )
    thread->m_last_dram_callback.instruction = pI; 
 }
 
+void atom_impl( const ptx_instruction *pI, ptx_thread_info *thread )
+{   
+   // SYNTAX
+   // atom.space.operation.type d, a, b[, c]; (now read in callback)
+   atom_red_setup( pI, thread, pI->src1() );
+}
+
 void bar_sync_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
 { 
    const operand_info &dst  = pI->dst();
@@ -2186,6 +2196,47 @@ void decode_space( memory_space_t &space, ptx_thread_info *thread, const operand
    }
 }
 
+// cp.async.bulk.shared.global [dst], [src], size, bar;
+// The data is copied at once here; the timing model streams it through the
+// ldst unit and arrives on barrier bar of the CTA when the last byte is in
+// shared memory (see cp.async.bulk.wait).
+void cp_async_bulk_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
+{
+   const operand_info &dst  = pI->dst();
+   const operand_info &src1 = pI->src1();
+   const operand_info &src2 = pI->src2();
+
+   ptx_reg_t dst_data = thread->get_operand_value(dst, dst, U32_TYPE, thread, 1);
+   ptx_reg_t src_data = thread->get_operand_value(src1, src1, U32_TYPE, thread, 1);
+   unsigned size = src2.get_literal_value().u32;
+   if( size == 0 || (size % 16) ) {
+      printf("GPGPU-Sim PTX: ERROR ** cp.async.bulk size %u is not a non-zero multiple of 16 bytes\n", size);
+      abort();
+   }
+
+   memory_space_t dst_space = shared_space;
+   memory_space_t src_space = global_space;
+   memory_space *dst_mem = NULL;
+   memory_space *src_mem = NULL;
+   addr_t dst_addr = dst_data.u32;
+   addr_t src_addr = src_data.u32;
+   decode_space(dst_space,thread,dst,dst_mem,dst_addr);
+   decode_space(src_space,thread,src1,src_mem,src_addr);
+
+   unsigned char buffer[16];
+   for( unsigned b=0; b < size; b+=16 ) {
+      src_mem->read(src_addr+b,16,buffer);
+      dst_mem->write(dst_addr+b,16,buffer,thread,pI);
+   }
+   thread->m_last_effective_address = src_addr;
+   thread->m_last_memory_space = src_space; 
+}
+
+void cp_async_bulk_wait_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
+{
+   // handled by timing simulator 
+}
+
 void ld_exec( const ptx_instruction *pI, ptx_thread_info *thread ) 
 { 
    const operand_info &dst = pI->dst();
@@ -2510,7 +2561,69 @@ void min_impl( const ptx_instruction *pI, ptx_thread_info *thread )
    thread->set_operand_value(dst,d, i_type, thread, pI);
 }
 
-void mov_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
+// mma.sync.aligned.m8n8k4.row.col.f64.f64.f64.f64 {d0,d1}, {a0}, {b0}, {c0,c1}
+// Warp-wide like vote: the fragments of all lanes are gathered and D = A*B + C
+// is written back once the last active lane has executed. Lane l holds
+// A[l/4][l%4], B[l%4][l/4] and C/D[l/4][2*(l%4)+i]; inactive lanes read as 0.
+void mma_impl( const ptx_instruction *pI, ptx_thread_info *thread )
+{
+   static bool first_in_warp = true;
+   static double a[8][4], b[4][8], c[8][8];
+   static std::list<ptx_thread_info*> threads_in_warp;
+   static unsigned last_tid;
+
+   if( pI->mma_shape() != M8N8K4_OPTION || pI->get_type() != F64_TYPE || pI->warp_size() != 32
+       || pI->mma_layout_a() != ROW_OPTION || pI->mma_layout_b() != COL_OPTION ) {
+      printf("GPGPU-Sim PTX: ERROR ** only mma.sync.aligned.m8n8k4.row.col.f64 is implemented (%s)\n",
+             pI->get_source());
+      abort();
+   }
+
+   if( first_in_warp ) {
+      first_in_warp = false;
+      threads_in_warp.clear();
+      memset(a,0,sizeof(a));
+      memset(b,0,sizeof(b));
+      memset(c,0,sizeof(c));
+      int offset=31;
+      while( (offset>=0) && !pI->active(offset) )
+         offset--;
+      assert( offset >= 0 );
+      last_tid = (thread->get_hw_tid() - (thread->get_hw_tid()%pI->warp_size())) + offset;
+   }
+
+   unsigned lane = thread->get_hw_tid() % pI->warp_size();
+   unsigned group = lane / 4;
+   unsigned tig = lane % 4; // thread in group
+   ptx_reg_t v[4];
+   assert( pI->src1().is_vector() && pI->src2().is_vector() && pI->src3().is_vector() );
+   thread->get_vector_operand_values(pI->src1(), v, 1);
+   a[group][tig] = v[0].f64;
+   thread->get_vector_operand_values(pI->src2(), v, 1);
+   b[tig][group] = v[0].f64;
+   thread->get_vector_operand_values(pI->src3(), v, 2);
+   c[group][2*tig] = v[0].f64;
+   c[group][2*tig+1] = v[1].f64;
+   threads_in_warp.push_back(thread);
+
+   if( thread->get_hw_tid() == last_tid ) {
+      for( std::list<ptx_thread_info*>::iterator t=threads_in_warp.begin(); t!=threads_in_warp.end(); ++t ) {
+         unsigned l = (*t)->get_hw_tid() % pI->warp_size();
+         ptx_reg_t d[2];
+         for( unsigned i=0; i < 2; i++ ) {
+            unsigned row = l / 4, col = 2*(l%4) + i;
+            double sum = c[row][col];
+            for( unsigned k=0; k < 4; k++ )
+               sum += a[row][k] * b[k][col];
+            d[i].f64 = sum;
+         }
+         (*t)->set_vector_operand_values(pI->dst(),d[0],d[1],d[1],d[1]);
+      }
+      first_in_warp = true;
+   }
+}
+
+void mov_impl( const ptx_instruction *pI, ptx_thread_info *thread )
 {
    ptx_reg_t data;
 
@@ -2939,7 +3052,12 @@ void rcp_impl( const ptx_instruction *pI, ptx_thread_info *thread )
    thread->set_operand_value(dst,data, i_type, thread, pI);
 }
 
-void red_impl( const ptx_instruction *pI, ptx_thread_info *thread ) { inst_not_implemented(pI); }
+void red_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
+{
+   // SYNTAX
+   // red.space.operation.type a, b; (read in callback, no value returned)
+   atom_red_setup( pI, thread, pI->dst() );
+}
 
 void rem_impl( const ptx_instruction *pI, ptx_thread_info *thread ) 
 { 
@@ -187,6 +187,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 %token  CV_OPTION;
 %token  WB_OPTION;
 %token  WT_OPTION;
+%token  SYNC_OPTION;
+%token  ALIGNED_OPTION;
+%token  ROW_OPTION;
+%token  COL_OPTION;
+%token  M8N8K4_OPTION;
 
 %type <int_value> function_decl_header
 %type <ptr_value> function_decl
@@ -436,6 +441,11 @@ option: type_spec
 	| CV_OPTION { add_option(CV_OPTION); }
 	| WB_OPTION { add_option(WB_OPTION); }
 	| WT_OPTION { add_option(WT_OPTION); }
+	| SYNC_OPTION { add_option(SYNC_OPTION); }
+	| ALIGNED_OPTION { add_option(ALIGNED_OPTION); }
+	| ROW_OPTION { add_option(ROW_OPTION); }
+	| COL_OPTION { add_option(COL_OPTION); }
+	| M8N8K4_OPTION { add_option(M8N8K4_OPTION); }
 	;
 
 atomic_operation_spec: ATOMIC_AND { add_option(ATOMIC_AND); } 
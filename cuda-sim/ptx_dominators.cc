@@ -0,0 +1,137 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt, Ali Bakhoda, Wilson W.L. Fung,
+// George L. Yuan
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "ptx_ir.h"
+
+// dominator analysis of the basic block flow graph, kept apart from the rest 
+// of the ptx IR so that it can be linked into the dominators_bench driver
+
+// Immediate dominators of the flow graph rooted at root, using the algorithm of
+// Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm" (2001).
+// The dominator tree is kept as a dense idom array and every pass visits the
+// blocks once in reverse postorder, intersecting along the tree instead of 
+// over dominator sets. With reverse set the edges are followed backwards, which
+// gives postdominators. Blocks that cannot be reached from root get -1, as 
+// does root itself. Returns the number of blocks reached.
+unsigned find_idoms( const std::vector<basic_block_t*> &bbs, int root, bool reverse, std::vector<int> &idom )
+{
+   unsigned n = bbs.size();
+   std::vector<int> po_num(n,-1); // postorder number
+   std::vector<int> postorder;
+   std::vector<std::set<int>::const_iterator> next_edge(n);
+   std::vector<int> stack;
+   postorder.reserve(n);
+
+   // iterative depth first search, large unrolled kernels make for deep graphs
+   stack.push_back(root);
+   po_num[root] = n; // on stack
+   next_edge[root] = (reverse? bbs[root]->predecessor_ids : bbs[root]->successor_ids).begin();
+   while (!stack.empty()) {
+      int b = stack.back();
+      const std::set<int> &out = reverse? bbs[b]->predecessor_ids : bbs[b]->successor_ids;
+      if (next_edge[b] != out.end()) {
+         int s = *next_edge[b];
+         next_edge[b]++;
+         if (po_num[s] == -1) {
+            po_num[s] = n;
+            next_edge[s] = (reverse? bbs[s]->predecessor_ids : bbs[s]->successor_ids).begin();
+            stack.push_back(s);
+         }
+      } else {
+         po_num[b] = postorder.size();
+         postorder.push_back(b);
+         stack.pop_back();
+      }
+   }
+
+   idom.assign(n,-1);
+   idom[root] = root;
+   bool change = true;
+   while (change) {
+      change = false;
+      for (int i = (int)postorder.size()-2/*skip root*/; i >= 0; --i) {
+         int b = postorder[i];
+         const std::set<int> &in = reverse? bbs[b]->successor_ids : bbs[b]->predecessor_ids;
+         int new_idom = -1;
+         for (std::set<int>::const_iterator p = in.begin(); p != in.end(); p++) {
+            if (idom[*p] == -1) 
+               continue; // not processed yet, or unreachable
+            if (new_idom == -1) {
+               new_idom = *p;
+               continue;
+            }
+            int a = *p;
+            while (a != new_idom) {
+               while (po_num[a] < po_num[new_idom]) a = idom[a];
+               while (po_num[new_idom] < po_num[a]) new_idom = idom[new_idom];
+            }
+         }
+         if (idom[b] != new_idom) {
+            idom[b] = new_idom;
+            change = true;
+         }
+      }
+   }
+   idom[root] = -1;
+   return postorder.size();
+}
+
+// Number the tree given by idom in depth first order, so that a block a is an 
+// ancestor of b iff pre[a] <= pre[b] and post[b] <= post[a]. 
+void number_dom_tree( const std::vector<int> &idom, int root, std::vector<int> &pre, std::vector<int> &post )
+{
+   unsigned n = idom.size();
+   std::vector<int> first_child(n,-1), next_sibling(n,-1);
+   for (int b = n-1; b >= 0; --b) {
+      if (idom[b] != -1) {
+         next_sibling[b] = first_child[idom[b]];
+         first_child[idom[b]] = b;
+      }
+   }
+   pre.assign(n,-1);
+   post.assign(n,-1);
+   int count = 0;
+   std::vector<int> stack;
+   std::vector<int> child(n,-1);
+   stack.push_back(root);
+   pre[root] = count++;
+   child[root] = first_child[root];
+   while (!stack.empty()) {
+      int b = stack.back();
+      if (child[b] != -1) {
+         int c = child[b];
+         child[b] = next_sibling[c];
+         pre[c] = count++;
+         child[c] = first_child[c];
+         stack.push_back(c);
+      } else {
+         post[b] = count++;
+         stack.pop_back();
+      }
+   }
+}
@@ -535,30 +535,6 @@ bool function_info::connect_break_targets() //connecting break instructions with
 
    return modified; 
 }
-void intersect( std::set<int> &A, const std::set<int> &B )
-{
-   // return intersection of A and B in A
-   for( std::set<int>::iterator a=A.begin(); a!=A.end(); ) {    
-      std::set<int>::iterator a_next = a;
-      a_next++;
-      if( B.find(*a) == B.end() ) {
-         A.erase(*a);
-         a = a_next;
-      } else 
-         a++;
-   }
-}
-
-bool is_equal( const std::set<int> &A, const std::set<int> &B )
-{
-   if( A.size() != B.size() ) 
-      return false;
-   for( std::set<int>::iterator b=B.begin(); b!=B.end(); b++ ) 
-      if( A.find(*b) == A.end() ) 
-         return false;
-   return true;
-}
-
 void print_set(const std::set<int> &A)
 {
    std::set<int>::iterator a;
@@ -570,160 +546,46 @@ void print_set(const std::set<int> &A)
 
 void function_info::find_dominators( )
 {  
-   // find dominators using algorithm of Muchnick's Adv. Compiler Design & Implemmntation Fig 7.14 
    printf("GPGPU-Sim PTX: Finding dominators for \'%s\'...\n", m_name.c_str() );
    fflush(stdout);
    assert( m_basic_blocks.size() >= 2 ); // must have a distinquished entry block
-   std::vector<basic_block_t*>::iterator bb_itr = m_basic_blocks.begin();
-   (*bb_itr)->dominator_ids.insert((*bb_itr)->bb_id);  // the only dominator of the entry block is the entry
-   //copy all basic blocks to all dominator lists EXCEPT for the entry block
-   for (++bb_itr;bb_itr != m_basic_blocks.end(); bb_itr++) { 
-      for (unsigned i = 0; i < m_basic_blocks.size(); i++) 
-         (*bb_itr)->dominator_ids.insert(i);
-   }
-   bool change = true;
-   while (change) {
-      change = false;
-      for ( int h = 1/*skip entry*/; h < m_basic_blocks.size(); ++h ) {
-         assert( m_basic_blocks[h]->bb_id == (unsigned)h );
-         std::set<int> T;
-         for (unsigned i=0;i< m_basic_blocks.size();i++) 
-            T.insert(i);
-         for ( std::set<int>::iterator s = m_basic_blocks[h]->predecessor_ids.begin();s != m_basic_blocks[h]->predecessor_ids.end();s++) 
-            intersect(T, m_basic_blocks[*s]->dominator_ids);
-         T.insert(h);
-         if (!is_equal(T, m_basic_blocks[h]->dominator_ids)) {
-            change = true;
-            m_basic_blocks[h]->dominator_ids = T;
-         }
-      }
-   }
-   //clean the basic block of dominators of it has no predecessors -- except for entry block
-   bb_itr = m_basic_blocks.begin();
-   for (++bb_itr;bb_itr != m_basic_blocks.end(); bb_itr++) {
-	  if ((*bb_itr)->predecessor_ids.empty())
-         (*bb_itr)->dominator_ids.clear();
+   std::vector<int> idom, pre, post;
+   unsigned num_reached = find_idoms(m_basic_blocks, 0, false, idom);
+   number_dom_tree(idom, 0, pre, post);
+   unsigned num_idoms = 0;
+   for (unsigned i=0; i<m_basic_blocks.size(); i++) {
+      assert( m_basic_blocks[i]->bb_id == i );
+      m_basic_blocks[i]->immediatedominator_id = idom[i];
+      m_basic_blocks[i]->dom_pre = pre[i];
+      m_basic_blocks[i]->dom_post = post[i];
+      if (idom[i] != -1) 
+         num_idoms++;
    }
+   assert( num_idoms == num_reached-1 );
+      // the entry node does not have an immediate dominator, but everyone reachable from it should
 }
 
 void function_info::find_postdominators( )
 {  
-   // find postdominators using algorithm of Muchnick's Adv. Compiler Design & Implemmntation Fig 7.14 
    printf("GPGPU-Sim PTX: Finding postdominators for \'%s\'...\n", m_name.c_str() );
    fflush(stdout);
    assert( m_basic_blocks.size() >= 2 ); // must have a distinquished exit block
-   std::vector<basic_block_t*>::reverse_iterator bb_itr = m_basic_blocks.rbegin();
-   (*bb_itr)->postdominator_ids.insert((*bb_itr)->bb_id);  // the only postdominator of the exit block is the exit
-   for (++bb_itr;bb_itr != m_basic_blocks.rend();bb_itr++) { //copy all basic blocks to all postdominator lists EXCEPT for the exit block
-      for (unsigned i=0; i<m_basic_blocks.size(); i++) 
-         (*bb_itr)->postdominator_ids.insert(i);
-   }
-   bool change = true;
-   while (change) {
-      change = false;
-      for ( int h = m_basic_blocks.size()-2/*skip exit*/; h >= 0 ; --h ) {
-         assert( m_basic_blocks[h]->bb_id == (unsigned)h );
-         std::set<int> T;
-         for (unsigned i=0;i< m_basic_blocks.size();i++) 
-            T.insert(i);
-         for ( std::set<int>::iterator s = m_basic_blocks[h]->successor_ids.begin();s != m_basic_blocks[h]->successor_ids.end();s++) 
-            intersect(T, m_basic_blocks[*s]->postdominator_ids);
-         T.insert(h);
-         if (!is_equal(T,m_basic_blocks[h]->postdominator_ids)) {
-            change = true;
-            m_basic_blocks[h]->postdominator_ids = T;
-         }
-      }
-   }
-}
-
-void function_info::find_ipostdominators( )
-{  
-   // find immediate postdominator blocks, using algorithm of
-   // Muchnick's Adv. Compiler Design & Implemmntation Fig 7.15 
-   printf("GPGPU-Sim PTX: Finding immediate postdominators for \'%s\'...\n", m_name.c_str() );
-   fflush(stdout);
-   assert( m_basic_blocks.size() >= 2 ); // must have a distinquished exit block
-   for (unsigned i=0; i<m_basic_blocks.size(); i++) { //initialize Tmp(n) to all pdoms of n except for n
-      m_basic_blocks[i]->Tmp_ids = m_basic_blocks[i]->postdominator_ids;
+   std::vector<int> ipdom, pre, post;
+   int exit = m_basic_blocks.size()-1;
+   find_idoms(m_basic_blocks, exit, true, ipdom);
+   number_dom_tree(ipdom, exit, pre, post);
+   unsigned num_ipdoms = 0;
+   for (unsigned i=0; i<m_basic_blocks.size(); i++) {
       assert( m_basic_blocks[i]->bb_id == i );
-      m_basic_blocks[i]->Tmp_ids.erase(i);
-   }
-   for ( int n = m_basic_blocks.size()-2; n >=0;--n) {
-      // point iterator to basic block before the exit
-      for( std::set<int>::iterator s=m_basic_blocks[n]->Tmp_ids.begin(); s != m_basic_blocks[n]->Tmp_ids.end(); s++ ) {
-         int bb_s = *s;
-         for( std::set<int>::iterator t=m_basic_blocks[n]->Tmp_ids.begin(); t != m_basic_blocks[n]->Tmp_ids.end(); ) {
-            std::set<int>::iterator t_next = t; t_next++; // might erase thing pointed to be t, invalidating iterator t
-            if( *s == *t ) {
-               t = t_next;
-               continue;
-            }
-            int bb_t = *t;
-            if( m_basic_blocks[bb_s]->postdominator_ids.find(bb_t) != m_basic_blocks[bb_s]->postdominator_ids.end() ) 
-                m_basic_blocks[n]->Tmp_ids.erase(bb_t);
-            t = t_next;
-         }
-      }
-   }
-   unsigned num_ipdoms=0;
-   for ( int n = m_basic_blocks.size()-1; n >=0;--n) {
-      assert( m_basic_blocks[n]->Tmp_ids.size() <= 1 ); 
-         // if the above assert fails we have an error in either postdominator 
-         // computation, the flow graph does not have a unique exit, or some other error
-      if( !m_basic_blocks[n]->Tmp_ids.empty() ) {
-         m_basic_blocks[n]->immediatepostdominator_id = *m_basic_blocks[n]->Tmp_ids.begin();
+      m_basic_blocks[i]->immediatepostdominator_id = ipdom[i];
+      m_basic_blocks[i]->pdom_pre = pre[i];
+      m_basic_blocks[i]->pdom_post = post[i];
+      if (ipdom[i] != -1) 
          num_ipdoms++;
-      }
    }
    assert( num_ipdoms == m_basic_blocks.size()-1 ); 
       // the exit node does not have an immediate post dominator, but everyone else should
-}
-
-void function_info::find_idominators( )
-{  
-   // find immediate dominator blocks, using algorithm of
-   // Muchnick's Adv. Compiler Design & Implemmntation Fig 7.15 
-   printf("GPGPU-Sim PTX: Finding immediate dominators for \'%s\'...\n", m_name.c_str() );
-   fflush(stdout);
-   assert( m_basic_blocks.size() >= 2 ); // must have a distinquished entry block
-   for (unsigned i=0; i<m_basic_blocks.size(); i++) { //initialize Tmp(n) to all doms of n except for n
-      m_basic_blocks[i]->Tmp_ids = m_basic_blocks[i]->dominator_ids;
-      assert( m_basic_blocks[i]->bb_id == i );
-      m_basic_blocks[i]->Tmp_ids.erase(i);
-   }
-   for ( int n = 0; n < m_basic_blocks.size(); ++n) {
-      // point iterator to basic block before the exit
-      for( std::set<int>::iterator s=m_basic_blocks[n]->Tmp_ids.begin(); s != m_basic_blocks[n]->Tmp_ids.end(); s++ ) {
-         int bb_s = *s;
-         for( std::set<int>::iterator t=m_basic_blocks[n]->Tmp_ids.begin(); t != m_basic_blocks[n]->Tmp_ids.end(); ) {
-            std::set<int>::iterator t_next = t; t_next++; // might erase thing pointed to be t, invalidating iterator t
-            if( *s == *t ) {
-               t = t_next;
-               continue;
-            }
-            int bb_t = *t;
-            if( m_basic_blocks[bb_s]->dominator_ids.find(bb_t) != m_basic_blocks[bb_s]->dominator_ids.end() ) 
-                m_basic_blocks[n]->Tmp_ids.erase(bb_t);
-            t = t_next;
-         }
-      }
-   }
-   unsigned num_idoms=0;
-   unsigned num_nopred = 0;
-   for ( int n = 0; n < m_basic_blocks.size(); ++n) {
-      //assert( m_basic_blocks[n]->Tmp_ids.size() <= 1 );
-         // if the above assert fails we have an error in either dominator
-         // computation, the flow graph does not have a unique entry, or some other error
-      if( !m_basic_blocks[n]->Tmp_ids.empty() ) {
-         m_basic_blocks[n]->immediatedominator_id = *m_basic_blocks[n]->Tmp_ids.begin();
-         num_idoms++;
-      } else if (m_basic_blocks[n]->predecessor_ids.empty()) {
-    	  num_nopred += 1;
-      }
-   }
-   assert( num_idoms == m_basic_blocks.size()-num_nopred );
-      // the entry node does not have an immediate dominator, but everyone else should
+      // if this fails some block cannot reach the exit or the flow graph does not have a unique exit
 }
 
 void function_info::print_dominators()
@@ -732,7 +594,12 @@ void function_info::print_dominators()
    std::vector<int>::iterator bb_itr;
    for (unsigned i = 0; i < m_basic_blocks.size(); i++) {
       printf("ID: %d\t:", i);
-      for( std::set<int>::iterator j=m_basic_blocks[i]->dominator_ids.begin(); j!=m_basic_blocks[i]->dominator_ids.end(); j++) 
+      std::set<int> dominator_ids;
+      if (i == 0 || m_basic_blocks[i]->immediatedominator_id != -1) {
+         for (int d = i; d != -1; d = m_basic_blocks[d]->immediatedominator_id) 
+            dominator_ids.insert(d);
+      }
+      for( std::set<int>::iterator j=dominator_ids.begin(); j!=dominator_ids.end(); j++) 
          printf(" %d", *j );
       printf("\n");
    }
@@ -744,7 +611,10 @@ void function_info::print_postdominators()
    std::vector<int>::iterator bb_itr;
    for (unsigned i = 0; i < m_basic_blocks.size(); i++) {
       printf("ID: %d\t:", i);
-      for( std::set<int>::iterator j=m_basic_blocks[i]->postdominator_ids.begin(); j!=m_basic_blocks[i]->postdominator_ids.end(); j++) 
+      std::set<int> postdominator_ids;
+      for (int d = i; d != -1; d = m_basic_blocks[d]->immediatepostdominator_id) 
+         postdominator_ids.insert(d);
+      for( std::set<int>::iterator j=postdominator_ids.begin(); j!=postdominator_ids.end(); j++) 
          printf(" %d", *j );
       printf("\n");
    }
@@ -955,7 +825,7 @@ static std::list<operand_info> check_operands( int opcode,
                                         const std::list<operand_info> &operands )
 {
    static int g_warn_literal_operands_two_type_inst;
-    if( (opcode == CVT_OP) || (opcode == SET_OP) || (opcode == SLCT_OP) || (opcode == TEX_OP) ) {
+    if( (opcode == CVT_OP) || (opcode == SET_OP) || (opcode == SLCT_OP) || (opcode == TEX_OP) || (opcode == MMA_OP) ) {
         // just make sure these do not have have const operands... 
         if( !g_warn_literal_operands_two_type_inst ) {
             std::list<operand_info>::const_iterator o;
@@ -1037,6 +907,9 @@ ptx_instruction::ptx_instruction( int opcode,
    m_vector_spec = 0;
    m_atomic_spec = 0;
    m_membar_level = 0;
+   m_mma_shape = 0;
+   m_mma_layout[0] = m_mma_layout[1] = 0;
+   unsigned num_mma_layouts = 0;
    m_inst_size = 8; // bytes
 
    std::list<int>::const_iterator i;
@@ -1162,6 +1035,17 @@ ptx_instruction::ptx_instruction( int opcode,
       case HALF_OPTION:
          m_inst_size = 4; // bytes
          break;
+      case SYNC_OPTION:
+      case ALIGNED_OPTION:
+         break;
+      case M8N8K4_OPTION:
+         m_mma_shape = last_ptx_inst_option;
+         break;
+      case ROW_OPTION:
+      case COL_OPTION:
+         assert( num_mma_layouts < 2 );
+         m_mma_layout[num_mma_layouts++] = last_ptx_inst_option;
+         break;
       default:
          assert(0);
          break;
@@ -807,32 +807,40 @@ struct basic_block_t {
       is_exit=ex;
       immediatepostdominator_id = -1;
       immediatedominator_id = -1;
+      dom_pre = dom_post = -1;
+      pdom_pre = pdom_post = -1;
    }
 
    ptx_instruction* ptx_begin;
    ptx_instruction* ptx_end;
    std::set<int> predecessor_ids; //indices of other basic blocks in m_basic_blocks array
    std::set<int> successor_ids;
-   std::set<int> postdominator_ids;
-   std::set<int> dominator_ids;
-   std::set<int> Tmp_ids;
    int immediatepostdominator_id;
    int immediatedominator_id;
+   // depth first numbering of the (post)dominator tree, -1 if not in the tree
+   int dom_pre, dom_post;
+   int pdom_pre, pdom_post;
    bool is_entry;
    bool is_exit;
    unsigned bb_id;
 
    // if this basic block dom B
    bool dom(const basic_block_t *B) {
-      return (B->dominator_ids.find(this->bb_id) != B->dominator_ids.end());
+      return (B->dom_pre != -1 && this->dom_pre <= B->dom_pre && B->dom_post <= this->dom_post);
    }
 
    // if this basic block pdom B
    bool pdom(const basic_block_t *B) {
-      return (B->postdominator_ids.find(this->bb_id) != B->postdominator_ids.end());
+      return (B->pdom_pre != -1 && this->pdom_pre <= B->pdom_pre && B->pdom_post <= this->pdom_post);
    }
 };
 
+// immediate (post)dominators of the flow graph bbs rooted at root, edges are 
+// followed backwards if reverse is set; returns the number of blocks reached
+unsigned find_idoms( const std::vector<basic_block_t*> &bbs, int root, bool reverse, std::vector<int> &idom );
+// depth first pre/post numbering of the tree given by idom
+void number_dom_tree( const std::vector<int> &idom, int root, std::vector<int> &pre, std::vector<int> &post );
+
 struct gpgpu_recon_t {
    address_type source_pc;
    address_type target_pc;
@@ -996,6 +1004,9 @@ public:
    enum vote_mode_t vote_mode() const { return m_vote_mode; }
 
    int membar_level() const { return m_membar_level; }
+   int mma_shape() const { return m_mma_shape; }
+   int mma_layout_a() const { return m_mma_layout[0]; }
+   int mma_layout_b() const { return m_mma_layout[1]; }
 
    bool has_memory_read() const {
       if( m_opcode == LD_OP || m_opcode == LDU_OP || m_opcode == TEX_OP ) 
@@ -1062,6 +1073,8 @@ private:
    int m_atomic_spec;
    enum vote_mode_t m_vote_mode;
    int m_membar_level;
+   int m_mma_shape;
+   int m_mma_layout[2]; // row/col of the A and B fragments
    int m_instr_mem_index; //index into m_instr_mem array
    unsigned m_inst_size; // bytes
 
@@ -1144,23 +1157,17 @@ public:
    bool connect_break_targets(); //connecting break instructions with proper targets
 
    //iterate across m_basic_blocks of function, 
-   //finding dominator blocks, using algorithm of
-   //Muchnick's Adv. Compiler Design & Implemmntation Fig 7.14 
+   //finding the immediate dominator of every block, using the algorithm of
+   //Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm" 
    void find_dominators( );
    void print_dominators();
-   void find_idominators();
    void print_idominators();
 
    //iterate across m_basic_blocks of function, 
-   //finding postdominator blocks, using algorithm of
-   //Muchnick's Adv. Compiler Design & Implemmntation Fig 7.14 
+   //finding the immediate postdominator of every block, same algorithm 
+   //over the reversed flow graph 
    void find_postdominators( );
    void print_postdominators();
-
-   //iterate across m_basic_blocks of function, 
-   //finding immediate postdominator blocks, using algorithm of
-   //Muchnick's Adv. Compiler Design & Implemmntation Fig 7.15 
-   void find_ipostdominators( );
    void print_ipostdominators();
 
 
@@ -1171,6 +1178,8 @@ public:
    unsigned get_function_size() { return m_instructions.size();}
 
    void ptx_assemble();
+   bool is_assembled() const { return m_assembled; }
+   void find_callees( std::vector<function_info*> &callees ) const; // targets of call instructions
  
    unsigned ptx_get_inst_op( ptx_thread_info *thread );
    void add_param( const char *name, struct param_t value )
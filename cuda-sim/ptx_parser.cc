@@ -204,10 +204,10 @@ void end_function()
    g_max_regs_per_thread = mymax( g_max_regs_per_thread, (g_current_symbol_table->next_reg_num()-1)); 
    g_func_info->add_inst( g_instructions );
    g_instructions.clear();
-   gpgpu_ptx_assemble( g_func_info->get_name(), g_func_info );
+   // assembly and control flow analysis wait until the kernel is first launched (gpgpu_ptx_assemble_kernel)
    g_current_symbol_table = g_global_symbol_table;
 
-   PTX_PARSE_DPRINTF("function %s, PC = %d\n", g_func_info->get_name().c_str(), g_func_info->get_start_PC());
+   PTX_PARSE_DPRINTF("function %s\n", g_func_info->get_name().c_str());
 }
 
 #define parse_error(msg, ...) parse_error_impl(__FILE__,__LINE__, msg, ##__VA_ARGS__)
@@ -590,8 +590,8 @@ void add_scalar_type_spec( int type_spec )
    g_scalar_type.push_back( type_spec );
    if ( g_scalar_type.size() > 1 ) {
       parse_assert( (g_opcode == -1) || (g_opcode == CVT_OP) || (g_opcode == SET_OP) || (g_opcode == SLCT_OP)
-                    || (g_opcode == TEX_OP), 
-                    "only cvt, set, slct, and tex can have more than one type specifier.");
+                    || (g_opcode == TEX_OP) || (g_opcode == MMA_OP), 
+                    "only cvt, set, slct, tex and mma can have more than one type specifier.");
    }
    g_scalar_type_spec = type_spec;
 }
@@ -71,6 +71,9 @@ void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp)
    option_parser_register(opp, "-gpgpu_mem_addr_test", OPT_BOOL, &run_test,
       "run sweep test to check address mapping for aliased address",
       "0");
+   option_parser_register(opp, "-gpgpu_mem_addr_hash", OPT_INT32, &gpgpu_mem_addr_hash, 
+               "hash the row bits into the channel and bank id (0 = none, 1 = XOR folding, 2 = IPOLY)",
+               "0");
    option_parser_register(opp, "-gpgpu_mem_address_mask", OPT_INT32, &gpgpu_mem_address_mask, 
                "0 = old addressing mask, 1 = new addressing mask, 2 = new add. mask + flipped bank sel and chip sel bits",
                "0");
@@ -79,15 +82,15 @@ void linear_to_raw_address_translation::addrdec_setoption(option_parser_t opp)
 new_addr_type linear_to_raw_address_translation::partition_address( new_addr_type addr ) const 
 { 
    if (!gap) {
-      return addrdec_packbits( ~(addrdec_mask[CHIP] | sub_partition_id_mask), addr, 64, 0 ); 
+      // removes the chip bits and the sub partition id bits 
+      return m_partition_lut(addr); 
    } else {
       // see addrdec_tlx for explanation 
       unsigned long long int partition_addr; 
       partition_addr = ( (addr>>ADDR_CHIP_S) / m_n_channel) << ADDR_CHIP_S; 
       partition_addr |= addr & ((1 << ADDR_CHIP_S) - 1); 
       // remove the part of address that constributes to the sub partition ID
-      partition_addr = addrdec_packbits( ~sub_partition_id_mask, partition_addr, 64, 0); 
-      return partition_addr; 
+      return m_partition_lut(partition_addr); 
    }
 }
 
@@ -95,11 +98,17 @@ void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr, addrdec_
 {  
    unsigned long long int addr_for_chip,rest_of_addr;
    if (!gap) {
-      tlx->chip = addrdec_packbits(addrdec_mask[CHIP], addr, addrdec_mkhigh[CHIP], addrdec_mklow[CHIP]);
-      tlx->bk   = addrdec_packbits(addrdec_mask[BK], addr, addrdec_mkhigh[BK], addrdec_mklow[BK]);
-      tlx->row  = addrdec_packbits(addrdec_mask[ROW], addr, addrdec_mkhigh[ROW], addrdec_mklow[ROW]);
-      tlx->col  = addrdec_packbits(addrdec_mask[COL], addr, addrdec_mkhigh[COL], addrdec_mklow[COL]);
-      tlx->burst= addrdec_packbits(addrdec_mask[BURST], addr, addrdec_mkhigh[BURST], addrdec_mklow[BURST]);
+      tlx->chip = m_field_lut[CHIP](addr);
+      tlx->bk   = m_field_lut[BK](addr);
+      tlx->row  = m_field_lut[ROW](addr);
+      tlx->col  = m_field_lut[COL](addr);
+      tlx->burst= m_field_lut[BURST](addr);
+      if (gpgpu_mem_addr_hash != ADDR_HASH_NONE) {
+         // the hash only depends on the row bits, which are kept in tlx, 
+         // so the mapping stays one-to-one 
+         tlx->chip ^= m_chip_hash_lut(addr); 
+         tlx->bk   ^= m_bk_hash_lut(addr); 
+      }
    } else {
       // Split the given address at ADDR_CHIP_S into (MSBs,LSBs)
       // - extract chip address using modulus of MSBs
@@ -109,10 +118,15 @@ void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr, addrdec_
       rest_of_addr |= addr & ((1 << ADDR_CHIP_S) - 1); 
 
       tlx->chip = addr_for_chip; 
-      tlx->bk   = addrdec_packbits(addrdec_mask[BK], rest_of_addr, addrdec_mkhigh[BK], addrdec_mklow[BK]);
-      tlx->row  = addrdec_packbits(addrdec_mask[ROW], rest_of_addr, addrdec_mkhigh[ROW], addrdec_mklow[ROW]);
-      tlx->col  = addrdec_packbits(addrdec_mask[COL], rest_of_addr, addrdec_mkhigh[COL], addrdec_mklow[COL]);
-      tlx->burst= addrdec_packbits(addrdec_mask[BURST], rest_of_addr, addrdec_mkhigh[BURST], addrdec_mklow[BURST]);
+      tlx->bk   = m_field_lut[BK](rest_of_addr);
+      tlx->row  = m_field_lut[ROW](rest_of_addr);
+      tlx->col  = m_field_lut[COL](rest_of_addr);
+      tlx->burst= m_field_lut[BURST](rest_of_addr);
+      if (gpgpu_mem_addr_hash != ADDR_HASH_NONE) {
+         // rotate the channel by the row hash so that it stays within m_n_channel
+         tlx->chip = (tlx->chip + m_chip_hash_lut(rest_of_addr)) % m_n_channel; 
+         tlx->bk  ^= m_bk_hash_lut(rest_of_addr); 
+      }
    }
 
    // combine the chip address and the lower bits of DRAM bank address to form the subpartition ID
@@ -121,6 +135,67 @@ void linear_to_raw_address_translation::addrdec_tlx(new_addr_type addr, addrdec_
                         + (tlx->bk & sub_partition_addr_mask); 
 }
 
+void addrdec_lut::init( const new_addr_type contrib[64] )
+{
+   m_mask = 0; 
+   m_is_extract = false; 
+   for (unsigned b = 0; b < 8; b++) {
+      for (unsigned v = 0; v < 256; v++) {
+         new_addr_type r = 0; 
+         for (unsigned i = 0; i < 8; i++) {
+            if (v & (1 << i)) 
+               r ^= contrib[b * 8 + i]; 
+         }
+         m_table[b][v] = r; 
+      }
+   }
+}
+
+void addrdec_lut::init_extract( new_addr_type mask )
+{
+   new_addr_type contrib[64]; 
+   unsigned pos = 0; 
+   for (unsigned i = 0; i < 64; i++) {
+      if (mask & (1ULL << i)) {
+         contrib[i] = 1ULL << pos; 
+         pos++; 
+      } else {
+         contrib[i] = 0; 
+      }
+   }
+   init(contrib); 
+   m_mask = mask; 
+   m_is_extract = true; 
+}
+
+// irreducible polynomials over GF(2) used by IPOLY hashing, indexed by degree
+static const unsigned ipoly_poly[] = { 0x1, 0x3, 0x7, 0xb, 0x13, 0x25, 0x43, 0x83, 0x11d }; 
+
+// builds a hash of the row bits that yields an n_bits wide value 
+void linear_to_raw_address_translation::init_hash( addrdec_lut &lut, unsigned n_bits ) const
+{
+   new_addr_type contrib[64]; 
+   memset(contrib, 0, sizeof(contrib)); 
+   if (n_bits > 0) {
+      assert(n_bits < sizeof(ipoly_poly) / sizeof(ipoly_poly[0])); 
+      unsigned residue = 1; // x^pos mod P
+      unsigned pos = 0; 
+      for (unsigned i = 0; i < 64; i++) {
+         if ((addrdec_mask[ROW] & (1ULL << i)) == 0) continue; 
+         if (gpgpu_mem_addr_hash == ADDR_HASH_XOR) {
+            contrib[i] = 1ULL << (pos % n_bits); 
+         } else {
+            contrib[i] = residue; 
+            residue <<= 1; 
+            if (residue & (1 << n_bits)) 
+               residue ^= ipoly_poly[n_bits]; 
+         }
+         pos++; 
+      }
+   }
+   lut.init(contrib); 
+}
+
 void linear_to_raw_address_translation::addrdec_parseoption(const char *option)
 {
    unsigned int dramid_start = 0;
@@ -344,6 +419,21 @@ void linear_to_raw_address_translation::init(unsigned int n_channel, unsigned in
    }
    printf("sub_partition_id_mask = %016llx\n", sub_partition_id_mask);
 
+   for (i = 0; i < N_ADDRDEC; i++) 
+      m_field_lut[i].init_extract(addrdec_mask[i]); 
+   if (!gap) 
+      m_partition_lut.init_extract(~(addrdec_mask[CHIP] | sub_partition_id_mask)); 
+   else 
+      m_partition_lut.init_extract(~sub_partition_id_mask); 
+
+   assert(gpgpu_mem_addr_hash >= ADDR_HASH_NONE && gpgpu_mem_addr_hash <= ADDR_HASH_IPOLY); 
+   if (gpgpu_mem_addr_hash != ADDR_HASH_NONE) {
+      // the chip field is empty in gap mode; hash into the full channel range instead
+      init_hash(m_chip_hash_lut, nchipbits); 
+      init_hash(m_bk_hash_lut, __builtin_popcountll(addrdec_mask[BK])); 
+      printf("address hashing = %s\n", (gpgpu_mem_addr_hash == ADDR_HASH_XOR)? "xor" : "ipoly"); 
+   }
+
    // cjllean
    printf("[cjllean] %s\n ADDR_CHIP_S=%d,channel=%d,sub partition=%d\n ",this->addrdec_option,
 									   this->ADDR_CHIP_S,
@@ -395,6 +485,12 @@ void linear_to_raw_address_translation::sweep_test() const
       addrdec_t tlx; 
       addrdec_tlx(raw_addr, &tlx); 
 
+      // the table driven decoder must agree with the reference bit loop 
+      for (unsigned f = 0; f < N_ADDRDEC; f++) {
+         assert(m_field_lut[f](raw_addr) == 
+                addrdec_packbits(addrdec_mask[f], raw_addr, addrdec_mkhigh[f], addrdec_mklow[f])); 
+      }
+
       history_map_t::iterator h = history_map.find(tlx); 
 
       if (h != history_map.end()) {
@@ -35,6 +35,10 @@
 
 #include "../abstract_hardware_model.h"
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 struct addrdec_t {
    void print( FILE *fp ) const;
     
@@ -47,6 +51,40 @@ struct addrdec_t {
    unsigned sub_partition; 
 };
 
+enum addrdec_hash_t {
+   ADDR_HASH_NONE  = 0, // plain bit extraction (or modulo when the channel count is not a power of two)
+   ADDR_HASH_XOR   = 1, // fold the row bits into channel/bank with XOR
+   ADDR_HASH_IPOLY = 2  // channel/bank = row bits modulo an irreducible polynomial over GF(2), XORed in
+};
+
+// Table-driven linear map (over GF(2)) from a 64-bit address to a packed value.
+// Every address byte indexes a 256-entry table of precomputed contributions, so
+// both field extraction and XOR/IPOLY hashing cost eight lookups instead of a
+// per-bit loop. Pure extraction uses the BMI2 pext instruction when available.
+class addrdec_lut {
+public:
+   addrdec_lut() : m_mask(0), m_is_extract(false) {}
+   void init( const new_addr_type contrib[64] );
+   void init_extract( new_addr_type mask );
+
+   new_addr_type operator()( new_addr_type addr ) const 
+   {
+#ifdef __BMI2__
+      if (m_is_extract) 
+         return _pext_u64(addr, m_mask);
+#endif
+      return m_table[0][addr & 0xff]         ^ m_table[1][(addr >> 8) & 0xff]
+           ^ m_table[2][(addr >> 16) & 0xff] ^ m_table[3][(addr >> 24) & 0xff]
+           ^ m_table[4][(addr >> 32) & 0xff] ^ m_table[5][(addr >> 40) & 0xff]
+           ^ m_table[6][(addr >> 48) & 0xff] ^ m_table[7][(addr >> 56) & 0xff];
+   }
+
+private:
+   new_addr_type m_mask;
+   bool m_is_extract;
+   new_addr_type m_table[8][256];
+};
+
 class linear_to_raw_address_translation {
 public:
    linear_to_raw_address_translation();
@@ -60,6 +98,7 @@ public:
 private:
    void addrdec_parseoption(const char *option);
    void sweep_test() const; // sanity check to ensure no overlapping
+   void init_hash( addrdec_lut &lut, unsigned n_bits ) const;
 
    enum {
       CHIP  = 0,
@@ -72,6 +111,7 @@ private:
 
    const char *addrdec_option;
    int gpgpu_mem_address_mask;
+   int gpgpu_mem_addr_hash;
    bool run_test; 
 
    int ADDR_CHIP_S;
@@ -80,6 +120,12 @@ private:
    new_addr_type addrdec_mask[N_ADDRDEC];
    new_addr_type sub_partition_id_mask; 
 
+   // precomputed decoders for addrdec_tlx() and partition_address() 
+   addrdec_lut m_field_lut[N_ADDRDEC];
+   addrdec_lut m_partition_lut;
+   addrdec_lut m_chip_hash_lut;
+   addrdec_lut m_bk_hash_lut;
+
    unsigned int gap;
    int m_n_channel;
    int m_n_sub_partition_in_channel; 
@@ -0,0 +1,307 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include "copy_engine.h"
+#include <assert.h>
+#include <stdlib.h>
+#include "../option_parser.h"
+#include "../stream_manager.h"
+#include "gpu-sim.h"
+#include "l2cache.h"
+#include "mem_fetch.h"
+#include "shader.h"
+
+void copy_engine_config::reg_options( class OptionParser * opp )
+{
+   option_parser_register(opp, "-gpgpu_copy_engines", OPT_UINT32, &n_engines,
+                          "Number of copy engines servicing stream memcpy operations (0 = memcpy takes no simulated time)", "0");
+   option_parser_register(opp, "-gpgpu_copy_link_bandwidth", OPT_FLOAT, &link_bandwidth,
+                          "Host link (PCIe) bandwidth seen by one copy engine in GB/s", "12.0");
+   option_parser_register(opp, "-gpgpu_copy_link_latency", OPT_UINT32, &link_latency,
+                          "Host link (PCIe) latency charged once per memcpy (core cycles)", "1000");
+   option_parser_register(opp, "-gpgpu_copy_dma_traffic", OPT_BOOL, &dma_traffic,
+                          "Copy engines inject DMA requests into the memory partitions (1=on, 0=off)", "1");
+   option_parser_register(opp, "-gpgpu_copy_dma_chunk", OPT_UINT32, &dma_chunk,
+                          "Bytes per DMA request issued by a copy engine", "128");
+   option_parser_register(opp, "-gpgpu_copy_dma_max_pending", OPT_UINT32, &dma_max_pending,
+                          "Maximum outstanding DMA requests per copy engine", "32");
+}
+
+void copy_engine_config::init( double core_freq )
+{
+   bytes_per_cycle = 0;
+   if (!enabled()) 
+      return;
+   assert( dma_chunk > 0 && dma_chunk <= MAX_MEMORY_ACCESS_SIZE );
+   assert( dma_max_pending > 0 );
+   bytes_per_cycle = (double)link_bandwidth * 1e9 / core_freq;
+   if (bytes_per_cycle <= 0) {
+      printf("GPGPU-Sim uArch: ERROR ** -gpgpu_copy_link_bandwidth must be positive\n");
+      abort();
+   }
+}
+
+copy_engine::copy_engine( const copy_engine_config &config, 
+                          const class memory_config *mem_config, 
+                          class memory_sub_partition **sub_partition )
+   : m_config(config)
+{
+   m_memory_config = mem_config;
+   m_sub_partition = sub_partition;
+   m_engine.resize(m_config.n_engines);
+   m_engine_busy.assign(m_config.n_engines, false);
+   m_n_busy = 0;
+   m_busy_cycles = 0;
+   m_n_dma_reads = 0;
+   m_n_dma_writes = 0;
+   m_dma_stalls = 0;
+   printf("GPGPU-Sim uArch: %u copy engine(s), link = %.2f GB/s (%.2f bytes/cycle), latency = %u cycles, DMA traffic %s\n",
+          m_config.n_engines, m_config.link_bandwidth, m_config.bytes_per_cycle, m_config.link_latency,
+          m_config.dma_traffic? "on" : "off");
+}
+
+void copy_engine::launch( struct CUstream_st *stream, enum copy_direction dir, 
+                          new_addr_type dst, new_addr_type src, size_t count, bool dma )
+{
+   // called by gpu simulation thread (stream_operation::do_operation)
+   transfer t;
+   t.stream = stream;
+   t.dir = dir;
+   t.dst = dst;
+   t.src = src;
+   t.count = count;
+   t.dma = dma && m_config.dma_traffic;
+   t.queued = gpu_sim_cycle + gpu_tot_sim_cycle;
+   t.start = 0;
+   t.link_ready = 0;
+   t.link_bytes = 0;
+   t.link_credit = 0;
+   t.issued = 0;
+   t.acked = 0;
+   t.pending = 0;
+   m_queue.push_back(t);
+}
+
+bool copy_engine::busy() const
+{
+   return m_n_busy > 0 || !m_queue.empty();
+}
+
+struct CUstream_st *copy_engine::finished()
+{
+   if (m_finished.empty()) 
+      return NULL;
+   struct CUstream_st *stream = m_finished.front();
+   m_finished.pop_front();
+   return stream;
+}
+
+void copy_engine::advance_link( transfer &t, size_t limit )
+{
+   assert( limit >= t.link_bytes );
+   t.link_credit += m_config.bytes_per_cycle;
+   size_t n = (size_t)t.link_credit;
+   if (n >= limit - t.link_bytes) {
+      // starved (or finished): unused bandwidth is lost, not banked
+      n = limit - t.link_bytes;
+      t.link_credit = 0;
+   } else {
+      t.link_credit -= n;
+   }
+   t.link_bytes += n;
+}
+
+bool copy_engine::issue_dma( unsigned engine, transfer &t, new_addr_type addr, unsigned size, bool write )
+{
+   addrdec_t tlx;
+   m_memory_config->m_address_mapping.addrdec_tlx(addr,&tlx);
+   memory_sub_partition *sub_partition = m_sub_partition[tlx.sub_partition];
+   if (sub_partition->full()) {
+      m_dma_stalls++;
+      return false;
+   }
+
+   mem_access_byte_mask_t byte_mask;
+   for (unsigned b=0; b < size; b++) 
+      byte_mask.set(b);
+   mem_access_t access( write? DMA_ACC_W : DMA_ACC_R, addr, size, write, active_mask_t(), byte_mask );
+   // DMA requests do not belong to any shader core; the warp id field names 
+   // the copy engine so the reply can be routed back in dma_reply()
+   mem_fetch *mf = new mem_fetch( access, 
+                                  NULL,
+                                  write? WRITE_PACKET_SIZE : READ_PACKET_SIZE, 
+                                  engine, 
+                                  -1, 
+                                  -1,
+                                  m_memory_config );
+   sub_partition->push( mf, gpu_sim_cycle + gpu_tot_sim_cycle );
+   t.pending++;
+   if (write) 
+      m_n_dma_writes++;
+   else 
+      m_n_dma_reads++;
+   return true;
+}
+
+void copy_engine::issue_requests( unsigned engine, transfer &t, size_t limit )
+{
+   // at most one DMA request per engine per cycle; D2D writes go first so 
+   // that data read by the engine does not pile up inside it
+   if (t.pending >= m_config.dma_max_pending) 
+      return;
+   if (!t.writes.empty()) {
+      if (issue_dma(engine, t, t.writes.front().first, t.writes.front().second, true)) 
+         t.writes.pop_front();
+      return;
+   }
+   if (t.issued >= limit) 
+      return;
+
+   new_addr_type base = (t.dir == COPY_HOST_TO_DEVICE)? t.dst : t.src;
+   new_addr_type addr = base + t.issued;
+   unsigned size = m_config.dma_chunk - (unsigned)(addr % m_config.dma_chunk);
+   if (size > t.count - t.issued) 
+      size = t.count - t.issued;
+   if (t.issued + size > limit) 
+      return; // wait until the whole chunk crossed the link
+   if (issue_dma(engine, t, addr, size, t.dir == COPY_HOST_TO_DEVICE)) 
+      t.issued += size;
+}
+
+void copy_engine::dma_reply( class mem_fetch *mf )
+{
+   unsigned engine = mf->get_wid();
+   assert( engine < m_engine.size() && m_engine_busy[engine] );
+   transfer &t = m_engine[engine];
+   assert( t.pending > 0 );
+   t.pending--;
+   unsigned size = mf->get_data_size();
+   if (t.dir == COPY_DEVICE_TO_DEVICE && mf->get_access_type() == DMA_ACC_R) 
+      t.writes.push_back( std::make_pair(t.dst + (mf->get_addr() - t.src), size) );
+   else 
+      t.acked += size;
+   delete mf;
+}
+
+bool copy_engine::done( const transfer &t, unsigned long long now ) const
+{
+   if (t.pending > 0 || now < t.link_ready) 
+      return false;
+   if (t.dir == COPY_DEVICE_TO_HOST) 
+      return t.link_bytes == t.count;
+   return t.acked == t.count;
+}
+
+void copy_engine::retire( unsigned engine, unsigned long long now )
+{
+   transfer &t = m_engine[engine];
+   stream_stats &s = m_stream_stats[t.stream->get_uid()];
+   s.n_copies++;
+   s.bytes[t.dir] += t.count;
+   s.queue_cycles += t.start - t.queued;
+   s.transfer_cycles += now - t.start;
+   m_finished.push_back(t.stream);
+   m_engine_busy[engine] = false;
+   m_n_busy--;
+}
+
+void copy_engine::cycle()
+{
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+   for (unsigned e=0; e < m_engine.size(); e++) {
+      if (!m_engine_busy[e]) {
+         if (m_queue.empty()) 
+            continue;
+         m_engine[e] = m_queue.front();
+         m_queue.pop_front();
+         m_engine[e].start = now;
+         m_engine[e].link_ready = now;
+         if (m_engine[e].dir != COPY_DEVICE_TO_DEVICE) 
+            m_engine[e].link_ready += m_config.link_latency;
+         m_engine_busy[e] = true;
+         m_n_busy++;
+      }
+      transfer &t = m_engine[e];
+      switch (t.dir) {
+      case COPY_HOST_TO_DEVICE:
+         // data crosses the link first, then is written into device memory
+         if (now >= t.link_ready) 
+            advance_link(t, t.count);
+         if (t.dma) 
+            issue_requests(e, t, t.link_bytes);
+         else 
+            t.acked = t.link_bytes;
+         break;
+      case COPY_DEVICE_TO_HOST:
+         // data crosses the link as soon as it has been read from device memory
+         if (t.dma) 
+            issue_requests(e, t, t.count);
+         else 
+            t.acked = t.count;
+         if (now >= t.link_ready) 
+            advance_link(t, t.acked);
+         break;
+      case COPY_DEVICE_TO_DEVICE:
+         // does not use the host link
+         if (t.dma) 
+            issue_requests(e, t, t.count);
+         else 
+            t.acked = t.count;
+         break;
+      default: 
+         abort();
+      }
+      if (done(t, now)) 
+         retire(e, now);
+   }
+   if (m_n_busy) 
+      m_busy_cycles++;
+}
+
+void copy_engine::print_stats( FILE *fout ) const
+{
+   static const char *dir_str[N_COPY_DIRECTIONS] = { "H2D", "D2H", "D2D" };
+   fprintf(fout, "copy_engine_busy_cycles = %llu\n", m_busy_cycles);
+   fprintf(fout, "copy_engine_dma_reads = %llu\n", m_n_dma_reads);
+   fprintf(fout, "copy_engine_dma_writes = %llu\n", m_n_dma_writes);
+   fprintf(fout, "copy_engine_dma_stalls = %llu\n", m_dma_stalls);
+   std::map<unsigned, stream_stats>::const_iterator i;
+   for (i = m_stream_stats.begin(); i != m_stream_stats.end(); i++) {
+      const stream_stats &s = i->second;
+      unsigned long long tot_bytes = 0;
+      fprintf(fout, "copy_stream[%u]: copies = %u, ", i->first, s.n_copies);
+      for (unsigned d=0; d < N_COPY_DIRECTIONS; d++) {
+         fprintf(fout, "%s = %llu B, ", dir_str[d], s.bytes[d]);
+         tot_bytes += s.bytes[d];
+      }
+      fprintf(fout, "queue_cycles = %llu, transfer_cycles = %llu, bytes/cycle = %.2f\n", 
+              s.queue_cycles, s.transfer_cycles, 
+              s.transfer_cycles? (double)tot_bytes / s.transfer_cycles : 0.0);
+   }
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef COPY_ENGINE_H
+#define COPY_ENGINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <list>
+#include <map>
+#include <vector>
+#include "../abstract_hardware_model.h"
+
+// Timed host<->device copy engines (-gpgpu_copy_engines > 0).
+//
+// Stream memcpy operations are still performed functionally when they are
+// started, but the stream operation only retires once the copy engine that
+// owns it has moved the data across the PCIe link (bandwidth + latency) and,
+// optionally, through the memory partitions as DMA requests. Kernels and
+// copies from different streams therefore overlap in simulated time.
+
+enum copy_direction {
+   COPY_HOST_TO_DEVICE = 0,
+   COPY_DEVICE_TO_HOST,
+   COPY_DEVICE_TO_DEVICE,
+   N_COPY_DIRECTIONS
+};
+
+struct copy_engine_config {
+   void reg_options( class OptionParser * opp );
+   void init( double core_freq );
+   bool enabled() const { return n_engines > 0; }
+
+   unsigned n_engines;        // 0 = memcpy completes instantaneously
+   float    link_bandwidth;   // GB/s per transfer
+   unsigned link_latency;     // core cycles charged once per transfer
+   bool     dma_traffic;      // inject DMA requests into the memory partitions
+   unsigned dma_chunk;        // bytes per DMA request
+   unsigned dma_max_pending;  // outstanding DMA requests per engine
+
+   double bytes_per_cycle;    // link bandwidth in bytes per core cycle
+};
+
+class copy_engine {
+public:
+   copy_engine( const copy_engine_config &config, 
+                const class memory_config *mem_config, 
+                class memory_sub_partition **sub_partition );
+
+   void launch( struct CUstream_st *stream, enum copy_direction dir, 
+                new_addr_type dst, new_addr_type src, size_t count, bool dma );
+   void cycle();
+   bool busy() const;
+   void dma_reply( class mem_fetch *mf );
+   struct CUstream_st *finished();
+   void print_stats( FILE *fout ) const;
+
+private:
+   struct transfer {
+      struct CUstream_st *stream;
+      enum copy_direction dir;
+      new_addr_type dst;
+      new_addr_type src;
+      size_t count;
+      bool dma;
+
+      unsigned long long queued;     // cycle the copy was handed to the engines
+      unsigned long long start;      // cycle an engine picked it up
+      unsigned long long link_ready; // first cycle data may cross the link
+
+      size_t link_bytes;   // bytes that crossed the link
+      double link_credit;  // fractional link bandwidth carried across cycles
+      size_t issued;       // bytes requested from the memory partitions (reads for D2H/D2D)
+      size_t acked;        // bytes whose DMA requests completed (writes for H2D/D2D)
+      unsigned pending;    // DMA requests in flight
+      std::list<std::pair<new_addr_type,unsigned> > writes; // D2D writes waiting to be issued
+   };
+
+   struct stream_stats {
+      stream_stats() : n_copies(0), queue_cycles(0), transfer_cycles(0) 
+      {
+         for (unsigned d=0; d < N_COPY_DIRECTIONS; d++) 
+            bytes[d] = 0;
+      }
+      unsigned n_copies;
+      unsigned long long bytes[N_COPY_DIRECTIONS];
+      unsigned long long queue_cycles;
+      unsigned long long transfer_cycles;
+   };
+
+   void advance_link( transfer &t, size_t limit );
+   bool issue_dma( unsigned engine, transfer &t, new_addr_type addr, unsigned size, bool write );
+   void issue_requests( unsigned engine, transfer &t, size_t limit );
+   bool done( const transfer &t, unsigned long long now ) const;
+   void retire( unsigned engine, unsigned long long now );
+
+   const copy_engine_config &m_config;
+   const class memory_config *m_memory_config;
+   class memory_sub_partition **m_sub_partition;
+
+   std::list<transfer> m_queue;         // copies waiting for a free engine
+   std::vector<transfer> m_engine;      // [engine] copy in progress
+   std::vector<bool> m_engine_busy;     // [engine]
+   unsigned m_n_busy;
+   std::list<struct CUstream_st *> m_finished;
+
+   // stats
+   std::map<unsigned, stream_stats> m_stream_stats; // indexed by stream uid
+   unsigned long long m_busy_cycles;
+   unsigned long long m_n_dma_reads;
+   unsigned long long m_n_dma_writes;
+   unsigned long long m_dma_stalls;
+};
+
+#endif
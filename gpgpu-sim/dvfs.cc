@@ -0,0 +1,217 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "dvfs.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../option_parser.h"
+#include "shader.h"
+
+void dvfs_config::reg_options( class OptionParser * opp )
+{
+   option_parser_register(opp, "-dvfs_governor", OPT_CSTR, &governor_string,
+                          "SIMT cluster DVFS governor {none | static:<level> | util | powercap:<watts>}", "none");
+   option_parser_register(opp, "-dvfs_levels", OPT_CSTR, &levels_string,
+                          "DVFS operating points relative to the nominal core clock, fastest first {<freq scale>:<volt scale>,...}",
+                          "1.0:1.0,0.85:0.92,0.7:0.85,0.55:0.78");
+   option_parser_register(opp, "-dvfs_interval", OPT_UINT32, &interval,
+                          "Core cycles between DVFS governor decisions", "5000");
+   option_parser_register(opp, "-dvfs_util_thresholds", OPT_CSTR, &util_string,
+                          "Issue utilization below/above which the util governor lowers/raises a cluster's level {<low>:<high>}", "0.3:0.7");
+}
+
+void dvfs_config::init()
+{
+   governor = DVFS_NONE;
+   static_level = 0;
+   power_cap = 0;
+   if (!strcmp(governor_string, "none")) {
+      return;
+   } else if (sscanf(governor_string, "static:%u", &static_level) == 1) {
+      governor = DVFS_STATIC;
+   } else if (!strcmp(governor_string, "util")) {
+      governor = DVFS_UTIL;
+   } else if (sscanf(governor_string, "powercap:%lf", &power_cap) == 1 && power_cap > 0) {
+      governor = DVFS_POWERCAP;
+   } else {
+      printf("GPGPU-Sim uArch: ERROR ** invalid -dvfs_governor \"%s\"\n", governor_string);
+      abort();
+   }
+
+   const char *s = levels_string;
+   while (*s) {
+      double f, v;
+      int n = 0;
+      if (sscanf(s, "%lf:%lf%n", &f, &v, &n) != 2 || f <= 0 || f > 1 || v <= 0 || v > 1) {
+         printf("GPGPU-Sim uArch: ERROR ** invalid -dvfs_levels \"%s\" (scales must be in (0,1])\n", levels_string);
+         abort();
+      }
+      if (!freq_scale.empty() && f > freq_scale.back()) {
+         printf("GPGPU-Sim uArch: ERROR ** -dvfs_levels must be listed fastest first\n");
+         abort();
+      }
+      freq_scale.push_back(f);
+      volt_scale.push_back(v);
+      s += n;
+      if (*s == ',') s++;
+   }
+   if (freq_scale.empty() || static_level >= freq_scale.size()) {
+      printf("GPGPU-Sim uArch: ERROR ** -dvfs_governor level out of range of -dvfs_levels\n");
+      abort();
+   }
+   if (sscanf(util_string, "%lf:%lf", &util_low, &util_high) != 2 || util_low > util_high) {
+      printf("GPGPU-Sim uArch: ERROR ** invalid -dvfs_util_thresholds \"%s\"\n", util_string);
+      abort();
+   }
+   if (interval == 0) {
+      printf("GPGPU-Sim uArch: ERROR ** -dvfs_interval must be non-zero\n");
+      abort();
+   }
+}
+
+dvfs_controller::dvfs_controller( const dvfs_config &config, const struct shader_core_config *shader_config )
+   : m_config(config), m_shader_config(shader_config)
+{
+   m_n_clusters = shader_config->n_simt_clusters;
+   unsigned init_level = (config.governor == DVFS_STATIC)? config.static_level : 0;
+   m_level.resize(m_n_clusters, init_level);
+   m_credit.resize(m_n_clusters, 0.0);
+   m_tick.resize(m_n_clusters, true);
+   m_interval_ticks.resize(m_n_clusters, 0);
+   m_last_winsn.resize(m_n_clusters, 0);
+   m_v2_sum.resize(m_n_clusters, 0.0);
+   m_v2_cycles = 0;
+   m_last_power = 0;
+   m_residency.resize(num_levels(), 0);
+   m_n_transitions = 0;
+}
+
+void dvfs_controller::clock()
+{
+   for (unsigned c=0; c < m_n_clusters; c++) {
+      unsigned l = m_level[c];
+      m_credit[c] += m_config.freq_scale[l];
+      m_tick[c] = (m_credit[c] >= 1.0);
+      if (m_tick[c]) {
+         m_credit[c] -= 1.0;
+         m_interval_ticks[c]++;
+      }
+      double v = m_config.volt_scale[l];
+      m_v2_sum[c] += v * v;
+      m_residency[l]++;
+   }
+   m_v2_cycles++;
+}
+
+void dvfs_controller::cycle( const class shader_core_stats *stats, unsigned long long cycle )
+{
+   if (cycle % m_config.interval) 
+      return;
+   switch (m_config.governor) {
+   case DVFS_UTIL:     util_governor(stats); break;
+   case DVFS_POWERCAP: powercap_governor(); break;
+   default: break;
+   }
+   for (unsigned c=0; c < m_n_clusters; c++) 
+      m_interval_ticks[c] = 0;
+}
+
+void dvfs_controller::util_governor( const class shader_core_stats *stats )
+{
+   unsigned max_issue = m_shader_config->n_simt_cores_per_cluster * m_shader_config->gpgpu_num_sched_per_core;
+   for (unsigned c=0; c < m_n_clusters; c++) {
+      unsigned long long winsn = 0;
+      for (unsigned i=0; i < m_shader_config->n_simt_cores_per_cluster; i++) 
+         winsn += stats->m_num_sim_winsn[m_shader_config->cid_to_sid(i,c)];
+      unsigned long long issued = winsn - m_last_winsn[c];
+      m_last_winsn[c] = winsn;
+      if (m_interval_ticks[c] == 0) 
+         continue;
+      double util = (double)issued / ((double)m_interval_ticks[c] * max_issue);
+      if (util < m_config.util_low && m_level[c] + 1 < num_levels()) 
+         set_level(c, m_level[c] + 1);
+      else if (util > m_config.util_high && m_level[c] > 0) 
+         set_level(c, m_level[c] - 1);
+   }
+}
+
+void dvfs_controller::powercap_governor()
+{
+   for (unsigned c=0; c < m_n_clusters; c++) {
+      if (m_last_power > m_config.power_cap && m_level[c] + 1 < num_levels()) 
+         set_level(c, m_level[c] + 1);
+      else if (m_last_power < 0.9 * m_config.power_cap && m_level[c] > 0) 
+         set_level(c, m_level[c] - 1);
+   }
+}
+
+void dvfs_controller::set_level( unsigned cluster_id, unsigned level )
+{
+   assert(level < num_levels());
+   if (m_level[cluster_id] != level) {
+      m_level[cluster_id] = level;
+      m_n_transitions++;
+   }
+}
+
+double dvfs_controller::power_scale( unsigned cluster_id ) const
+{
+   if (m_v2_cycles == 0) {
+      double v = m_config.volt_scale[m_level[cluster_id]];
+      return v * v;
+   }
+   return m_v2_sum[cluster_id] / m_v2_cycles;
+}
+
+void dvfs_controller::reset_power_scale()
+{
+   for (unsigned c=0; c < m_n_clusters; c++) 
+      m_v2_sum[c] = 0;
+   m_v2_cycles = 0;
+}
+
+void dvfs_controller::print_stats( FILE *fout ) const
+{
+   unsigned long long total = 0;
+   double freq = 0;
+   for (unsigned l=0; l < num_levels(); l++) {
+      total += m_residency[l];
+      freq += m_residency[l] * m_config.freq_scale[l];
+   }
+   fprintf(fout, "dvfs_governor = %s\n", m_config.governor_string);
+   fprintf(fout, "dvfs_level_residency = ");
+   for (unsigned l=0; l < num_levels(); l++) 
+      fprintf(fout, "%.4f ", total? (double)m_residency[l] / total : 0.0);
+   fprintf(fout, "\n");
+   fprintf(fout, "dvfs_avg_freq_scale = %.4f\n", total? freq / total : 1.0);
+   fprintf(fout, "dvfs_transitions = %llu\n", m_n_transitions);
+   fprintf(fout, "dvfs_cluster_level = ");
+   for (unsigned c=0; c < m_n_clusters; c++) 
+      fprintf(fout, "%u ", m_level[c]);
+   fprintf(fout, "\n");
+}
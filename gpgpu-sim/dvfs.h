@@ -0,0 +1,121 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef DVFS_H
+#define DVFS_H
+
+#include <stdio.h>
+#include <vector>
+
+// Dynamic voltage and frequency scaling of the SIMT clusters (-dvfs_governor).
+//
+// Each cluster runs at one of the operating points in -dvfs_levels, given as a 
+// frequency and a voltage scale relative to the nominal core clock. A cluster 
+// at frequency scale f executes a core clock edge on a fraction f of the CORE 
+// edges from next_clock_domain(); the interconnect, L2 and DRAM keep their own 
+// clocks. The average (V/Vnom)^2 of every cluster over a power sample is given 
+// to the power model, which scales that SM's dynamic power by it.
+//
+// The governor re-evaluates the levels every -dvfs_interval core cycles:
+//   none           all clusters at the nominal clock, no gating
+//   static:<l>     all clusters pinned at level <l>
+//   util           per cluster, step down a level when issue utilization is 
+//                  below the low -dvfs_util_thresholds and up when above high
+//   powercap:<W>   all clusters step down while the last power sample is above
+//                  W watts and back up once it is 10% below (needs the power model)
+
+enum dvfs_governor_type {
+   DVFS_NONE = 0,
+   DVFS_STATIC,
+   DVFS_UTIL,
+   DVFS_POWERCAP
+};
+
+struct dvfs_config {
+   void reg_options( class OptionParser * opp );
+   void init();
+   bool enabled() const { return governor != DVFS_NONE; }
+
+   char    *governor_string;
+   char    *levels_string;     // <freq scale>:<volt scale>,... fastest first
+   char    *util_string;       // <low>:<high> issue utilization thresholds
+   unsigned interval;          // core cycles between governor decisions
+
+   enum dvfs_governor_type governor;
+   unsigned static_level;
+   double   power_cap;         // watts
+   double   util_low, util_high;
+   std::vector<double> freq_scale; // per level
+   std::vector<double> volt_scale; // per level
+};
+
+class dvfs_controller {
+public:
+   dvfs_controller( const dvfs_config &config, const struct shader_core_config *shader_config );
+
+   // once per nominal CORE clock edge, decides which clusters take it
+   void clock();
+   bool cluster_tick( unsigned cluster_id ) const { return m_tick[cluster_id]; }
+
+   // once per core cycle after the clusters ran, applies the governor at interval boundaries
+   void cycle( const class shader_core_stats *stats, unsigned long long cycle );
+
+   // runtime interface for governors and external policies
+   void set_level( unsigned cluster_id, unsigned level );
+   unsigned get_level( unsigned cluster_id ) const { return m_level[cluster_id]; }
+   unsigned num_levels() const { return m_config.freq_scale.size(); }
+   void set_power_sample( double watts ) { m_last_power = watts; }
+
+   // average (V/Vnom)^2 of a cluster since the last reset_power_scale()
+   double power_scale( unsigned cluster_id ) const;
+   void reset_power_scale();
+
+   void print_stats( FILE *fout ) const;
+
+private:
+   void util_governor( const class shader_core_stats *stats );
+   void powercap_governor();
+
+   const dvfs_config &m_config;
+   const struct shader_core_config *m_shader_config;
+   unsigned m_n_clusters;
+
+   std::vector<unsigned> m_level;
+   std::vector<double>   m_credit;       // fraction of a cluster clock edge accumulated
+   std::vector<bool>     m_tick;
+   std::vector<unsigned> m_interval_ticks;
+   std::vector<unsigned long long> m_last_winsn; // warp instructions at the last decision
+   std::vector<double>   m_v2_sum;
+   unsigned              m_v2_cycles;
+   double                m_last_power;
+
+   // stats
+   std::vector<unsigned long long> m_residency; // nominal cluster cycles per level
+   unsigned long long m_n_transitions;
+};
+
+#endif
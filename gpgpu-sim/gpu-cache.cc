@@ -29,7 +29,16 @@
 #include "stat-tool.h"
 #include <assert.h>
 #include <iostream>
-#define MAX_DEFAULT_CACHE_SIZE_MULTIBLIER 4
+
+// replacement policy parameters (RRIP, DRRIP set dueling, SHiP, bypass predictor)
+#define RRPV_MAX 3              // 2-bit re-reference prediction values
+#define BRRIP_LONG_PERIOD 32    // BRRIP inserts with a long interval once every 32 fills
+#define DUEL_PERIOD 32          // one SRRIP and one BRRIP leader set every 32 sets
+#define PSEL_MAX 1023           // 10-bit policy selection counter
+#define SHCT_BITS 14
+#define SHCT_SIZE (1 << SHCT_BITS)
+#define SHCT_MAX 7              // 3-bit signature history counters
+#define BYPASS_SAMPLE_PERIOD 32 // one in 32 predicted bypasses still allocates
 
 long g_mshr_changed=0; // global vars. define/init/use only in this file. 
 
@@ -107,6 +116,10 @@ void tag_array::init( int core_id, int type_id )
     m_prev_snapshot_pending_hit = 0;
     m_core_id = core_id; 
     m_type_id = type_id;
+    m_psel = PSEL_MAX / 2;
+    m_brrip_count = 0;
+    m_bypass_count = 0;
+    m_shct.assign(SHCT_SIZE, 1); // weakly predict reuse
 }
 // search in cache,return 4 type: hit/pending_hit/miss/reservation_fail. if miss ,idx is the evict line.
 enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx ) const {
@@ -155,6 +168,10 @@ enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx )
                         valid_timestamp = line->m_alloc_time;
                         valid_line = index;
                     }
+                } else if ( m_config.rrip_replacement() ) {
+                    // the line predicted to be re-referenced furthest in the future 
+                    if ( valid_line == (unsigned)-1 || line->m_rrpv > m_lines[valid_line].m_rrpv ) 
+                        valid_line = index;
                 }
             }
         }
@@ -174,16 +191,16 @@ enum cache_request_status tag_array::probe( new_addr_type addr, unsigned &idx )
     return MISS;
 }
 //- 3 params
-enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx )
+enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx, const mem_fetch *mf )
 {
     bool wb=false;
     cache_block_t evicted;
-    enum cache_request_status result = access(addr,time,idx,wb,evicted);
+    enum cache_request_status result = access(addr,time,idx,wb,evicted,mf);
     assert(!wb);
     return result;
 }
 //- 4 params. return 4 type.
-enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted ) 
+enum cache_request_status tag_array::access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted, const mem_fetch *mf ) 
 {
     m_access++;
     shader_cache_access_log(m_core_id, m_type_id, 0); // log accesses to cache
@@ -193,15 +210,18 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
         m_pending_hit++;  //HIT_RESERVED ->  pending hit 
     case HIT: 
         m_lines[idx].m_last_access_time=time; 
+        replacement_hit(idx);
         break;
     case MISS:
         m_miss++;
         shader_cache_access_log(m_core_id, m_type_id, 1); // log cache misses
+        replacement_miss(idx);
         if ( m_config.m_alloc_policy == ON_MISS )  {
             if( m_lines[idx].m_status == MODIFIED ) {
                 wb = true;
                 evicted = m_lines[idx];
             }
+            replacement_insert(idx, mf);
             m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
         }
         break;
@@ -217,12 +237,13 @@ enum cache_request_status tag_array::access( new_addr_type addr, unsigned time,
     return status;
 }
 
-void tag_array::fill( new_addr_type addr, unsigned time )//-cache block : L2 -> icnt -> L1.tag_array[]
+void tag_array::fill( new_addr_type addr, unsigned time, const mem_fetch *mf )//-cache block : L2 -> icnt -> L1.tag_array[]
 {
     assert( m_config.m_alloc_policy == ON_FILL );
     unsigned idx;
     enum cache_request_status status = probe(addr,idx);
     assert(status==MISS); // MSHR should have prevented redundant memory request
+    replacement_insert(idx, mf);
     m_lines[idx].allocate( m_config.tag(addr), m_config.block_addr(addr), time );
     m_lines[idx].fill(time);
 }
@@ -233,6 +254,113 @@ void tag_array::fill( unsigned index, unsigned time )
     m_lines[index].fill(time);
 }
 
+/****** Replacement policies beyond LRU/FIFO ******/
+// RRIP keeps a 2-bit re-reference prediction value (RRPV) per line: a hit 
+// predicts near-immediate reuse (0), an insertion predicts a long (max-1) or 
+// distant (max) re-reference interval, and the victim is the line with the 
+// largest RRPV. Aging is applied at insertion so that probe() stays const.
+
+enum replacement_policy_t tag_array::policy_of_set( unsigned set_index ) const
+{
+    if ( m_config.m_replacement_policy != DRRIP ) 
+        return m_config.m_replacement_policy;
+    // dedicated leader sets for each policy, the followers use the winner
+    switch ( set_index % DUEL_PERIOD ) {
+    case 0: return SRRIP;
+    case 1: return BRRIP;
+    default: return (m_psel > PSEL_MAX / 2)? BRRIP : SRRIP;
+    }
+}
+
+enum replacement_policy_t tag_array::set_policy( new_addr_type addr ) const
+{
+    return policy_of_set( m_config.set_index(addr) );
+}
+
+unsigned tag_array::signature( const mem_fetch *mf ) const
+{
+    if ( mf == NULL || mf->get_pc() == (address_type)-1 ) 
+        return 0;
+    address_type pc = mf->get_pc();
+    return (pc ^ (pc >> SHCT_BITS)) & (SHCT_SIZE - 1);
+}
+
+bool tag_array::predict_bypass( const mem_fetch *mf )
+{
+    if ( m_config.m_bypass_policy != BYPASS_PREDICT || mf->isatomic() || mf->get_pc() == (address_type)-1 ) 
+        return false;
+    if ( m_shct[signature(mf)] != 0 ) 
+        return false;
+    // keep sampling the PC so that the predictor can learn about reuse again
+    m_bypass_count++;
+    return (m_bypass_count % BYPASS_SAMPLE_PERIOD) != 0;
+}
+
+void tag_array::replacement_hit( unsigned idx )
+{
+    cache_block_t &line = m_lines[idx];
+    line.m_rrpv = 0;
+    if ( m_config.m_replacement_policy == SHIP || m_config.m_bypass_policy == BYPASS_PREDICT ) {
+        if ( m_shct[line.m_signature] < SHCT_MAX ) 
+            m_shct[line.m_signature]++;
+        line.m_reused = true;
+    }
+}
+
+void tag_array::replacement_miss( unsigned idx )
+{
+    if ( m_config.m_replacement_policy != DRRIP ) 
+        return;
+    // a miss in a leader set votes against its policy
+    switch ( (idx / m_config.m_assoc) % DUEL_PERIOD ) {
+    case 0: if ( m_psel < PSEL_MAX ) m_psel++; break;
+    case 1: if ( m_psel > 0 ) m_psel--; break;
+    default: break;
+    }
+}
+
+void tag_array::replacement_insert( unsigned idx, const mem_fetch *mf )
+{
+    cache_block_t &victim = m_lines[idx];
+    bool victim_valid = (victim.m_status == VALID || victim.m_status == MODIFIED);
+    if ( victim_valid && !victim.m_reused && 
+         (m_config.m_replacement_policy == SHIP || m_config.m_bypass_policy == BYPASS_PREDICT) ) {
+        if ( m_shct[victim.m_signature] > 0 ) 
+            m_shct[victim.m_signature]--;
+    }
+
+    victim.m_signature = signature(mf);
+    victim.m_reused = false;
+    if ( !m_config.rrip_replacement() ) 
+        return;
+
+    // age the set so that the victim would have reached the distant RRPV
+    unsigned set_index = idx / m_config.m_assoc;
+    if ( victim_valid && victim.m_rrpv < RRPV_MAX ) {
+        unsigned delta = RRPV_MAX - victim.m_rrpv;
+        for ( unsigned way=0; way < m_config.m_assoc; way++ ) {
+            cache_block_t &line = m_lines[set_index * m_config.m_assoc + way];
+            if ( &line == &victim || line.m_status == INVALID ) 
+                continue;
+            line.m_rrpv = (line.m_rrpv + delta > RRPV_MAX)? RRPV_MAX : line.m_rrpv + delta;
+        }
+    }
+
+    switch ( policy_of_set(set_index) ) {
+    case SRRIP: 
+        victim.m_rrpv = RRPV_MAX - 1; 
+        break;
+    case BRRIP: 
+        victim.m_rrpv = (++m_brrip_count % BRRIP_LONG_PERIOD == 0)? RRPV_MAX - 1 : RRPV_MAX; 
+        break;
+    case SHIP: 
+        victim.m_rrpv = (m_shct[victim.m_signature] == 0)? RRPV_MAX : RRPV_MAX - 1; 
+        break;
+    default: 
+        abort();
+    }
+}
+
 void tag_array::flush() 
 {
     for (unsigned i=0; i < m_config.get_num_lines(); i++)
@@ -391,6 +519,11 @@ cache_stats::cache_stats(){
     m_cache_port_available_cycles = 0; 
     m_cache_data_port_busy_cycles = 0; 
     m_cache_fill_port_busy_cycles = 0; 
+    for(unsigned p=0; p<N_REPLACEMENT_POLICY; ++p){
+        m_policy_access[p] = 0;
+        m_policy_hit[p] = 0;
+    }
+    m_bypass = 0;
 }
 
 void cache_stats::clear(){
@@ -403,6 +536,22 @@ void cache_stats::clear(){
     m_cache_port_available_cycles = 0; 
     m_cache_data_port_busy_cycles = 0; 
     m_cache_fill_port_busy_cycles = 0; 
+    for(unsigned p=0; p<N_REPLACEMENT_POLICY; ++p){
+        m_policy_access[p] = 0;
+        m_policy_hit[p] = 0;
+    }
+    m_bypass = 0;
+}
+
+void cache_stats::inc_policy_stats(enum replacement_policy_t policy, enum cache_request_status status){
+    ///
+    /// Count accesses (not reservation fails) and hits per replacement policy.
+    ///
+    if(status == RESERVATION_FAIL)
+        return;
+    m_policy_access[policy]++;
+    if(status == HIT)
+        m_policy_hit[policy]++;
 }
 
 void cache_stats::inc_stats(int access_type, int access_outcome){
@@ -460,6 +609,11 @@ cache_stats cache_stats::operator+(const cache_stats &cs){
     ret.m_cache_port_available_cycles = m_cache_port_available_cycles + cs.m_cache_port_available_cycles; 
     ret.m_cache_data_port_busy_cycles = m_cache_data_port_busy_cycles + cs.m_cache_data_port_busy_cycles; 
     ret.m_cache_fill_port_busy_cycles = m_cache_fill_port_busy_cycles + cs.m_cache_fill_port_busy_cycles; 
+    for(unsigned p=0; p<N_REPLACEMENT_POLICY; ++p){
+        ret.m_policy_access[p] = m_policy_access[p] + cs.m_policy_access[p];
+        ret.m_policy_hit[p] = m_policy_hit[p] + cs.m_policy_hit[p];
+    }
+    ret.m_bypass = m_bypass + cs.m_bypass;
     return ret;
 }
 
@@ -475,6 +629,11 @@ cache_stats &cache_stats::operator+=(const cache_stats &cs){
     m_cache_port_available_cycles += cs.m_cache_port_available_cycles; 
     m_cache_data_port_busy_cycles += cs.m_cache_data_port_busy_cycles; 
     m_cache_fill_port_busy_cycles += cs.m_cache_fill_port_busy_cycles; 
+    for(unsigned p=0; p<N_REPLACEMENT_POLICY; ++p){
+        m_policy_access[p] += cs.m_policy_access[p];
+        m_policy_hit[p] += cs.m_policy_hit[p];
+    }
+    m_bypass += cs.m_bypass;
     return *this;
 }
 
@@ -497,6 +656,16 @@ void cache_stats::print_stats(FILE *fout, const char *cache_name) const{
             }
         }
     }
+    static const char *policy_str[N_REPLACEMENT_POLICY] = { "LRU", "FIFO", "SRRIP", "BRRIP", "DRRIP", "SHiP" };
+    for (unsigned p = 0; p < N_REPLACEMENT_POLICY; ++p) {
+        if(m_policy_access[p] > 0){
+            fprintf(fout, "\t%s_policy[%5s] = %llu accesses, hit rate = %.4f\n",
+                m_cache_name.c_str(), policy_str[p], m_policy_access[p],
+                (double)m_policy_hit[p] / m_policy_access[p]);
+        }
+    }
+    if(m_bypass > 0)
+        fprintf(fout, "\t%s_bypass = %llu\n", m_cache_name.c_str(), m_bypass);
 }
 
 void cache_sub_stats::print_port_stats(FILE *fout, const char *cache_name) const
@@ -590,7 +759,11 @@ baseline_cache::bandwidth_management::bandwidth_management(cache_config &config)
 /// use the data port based on the outcome and events generated by the mem_fetch request 
 void baseline_cache::bandwidth_management::use_data_port(mem_fetch *mf, enum cache_request_status outcome, const std::list<cache_event> &events)
 {
-    unsigned data_size = mf->get_data_size(); 
+    use_data_port(mf->get_data_size(), outcome, events); 
+}
+
+void baseline_cache::bandwidth_management::use_data_port(unsigned data_size, enum cache_request_status outcome, const std::list<cache_event> &events)
+{
     unsigned port_width = m_config.m_data_port_width; 
     switch (outcome) {
     case HIT: {
@@ -669,14 +842,17 @@ void baseline_cache::fill(mem_fetch *mf, unsigned time){//- mf insert to cache
     assert( e != m_extra_mf_fields.end() );
     assert( e->second.m_valid );
     mf->set_data_size( e->second.m_data_size );
-    if ( m_config.m_alloc_policy == ON_MISS )
+    bool bypassed = m_bypass_blocks.erase(e->second.m_block_addr) > 0;
+    if ( bypassed )
+        ; // no line was allocated for this block
+    else if ( m_config.m_alloc_policy == ON_MISS )
         m_tag_array->fill(e->second.m_cache_index,time);//- this fill(addr) only for ON_MISS
     else if ( m_config.m_alloc_policy == ON_FILL )
-        m_tag_array->fill(e->second.m_block_addr,time);//- this fill( idx ) only for ON_FILL
+        m_tag_array->fill(e->second.m_block_addr,time,mf);//- this fill( idx ) only for ON_FILL
     else abort();
     bool has_atomic = false;
     m_mshrs.mark_ready(e->second.m_block_addr, has_atomic);
-    if (has_atomic) {
+    if (has_atomic && !bypassed) {
         assert(m_config.m_alloc_policy == ON_MISS);
         cache_block_t &block = m_tag_array->get_block(e->second.m_cache_index);
         block.m_status = MODIFIED; // mark line as dirty for atomic operation
@@ -718,18 +894,26 @@ void baseline_cache::send_read_request(new_addr_type addr, new_addr_type block_a
     bool mshr_hit = m_mshrs.probe(block_addr);
     bool mshr_avail = !m_mshrs.full(block_addr);
     if ( mshr_hit && mshr_avail ) {
-    	if(read_only)
-    		m_tag_array->access(block_addr,time,cache_index);
-    	else
-    		m_tag_array->access(block_addr,time,cache_index,wb,evicted);
+        // merging into a bypassing miss must not allocate a line that would never be filled
+        if( m_bypass_blocks.find(block_addr) == m_bypass_blocks.end() ) {
+    	    if(read_only)
+    		    m_tag_array->access(block_addr,time,cache_index,mf);
+    	    else
+    		    m_tag_array->access(block_addr,time,cache_index,wb,evicted,mf);
+        }
 
         m_mshrs.add(block_addr,mf);
         do_miss = true;
     } else if ( !mshr_hit && mshr_avail && (m_miss_queue.size() < m_config.m_miss_queue_size) ) {
-    	if(read_only)
-    		m_tag_array->access(block_addr,time,cache_index);
+        if( m_tag_array->predict_bypass(mf) ) {
+            // streaming access: fetch the block without allocating a line
+            m_bypass_blocks.insert(block_addr);
+            m_stats.inc_bypass();
+            cache_index = (unsigned)-1;
+        } else if(read_only)
+    		m_tag_array->access(block_addr,time,cache_index,mf);
     	else
-    		m_tag_array->access(block_addr,time,cache_index,wb,evicted);
+    		m_tag_array->access(block_addr,time,cache_index,wb,evicted,mf);
 
         m_mshrs.add(block_addr,mf);
         m_extra_mf_fields[mf] = extra_mf_fields(block_addr,cache_index, mf->get_data_size());
@@ -980,6 +1164,31 @@ read_only_cache::access( new_addr_type addr,
     }
     //-this access record in m_stats.  m_stats[access_type][access_outcome]++;
     m_stats.inc_stats(mf->get_access_type(), m_stats.select_stats_status(status, cache_status));
+    m_stats.inc_policy_stats(m_tag_array->set_policy(block_addr), cache_status);
+    return cache_status;
+}
+
+/// Same outcome and side effects as access() for a hit or a reservation fail,
+/// but without a mem_fetch. On MISS nothing is changed.
+enum cache_request_status
+read_only_cache::probe_read( new_addr_type addr,
+                             enum mem_access_type type,
+                             unsigned size,
+                             unsigned time )
+{
+    assert( size <= m_config.get_line_sz());
+    new_addr_type block_addr = m_config.block_addr(addr);
+    unsigned cache_index = (unsigned)-1;
+    enum cache_request_status status = m_tag_array->probe(block_addr,cache_index);
+    enum cache_request_status cache_status;
+    if ( status == HIT ) 
+        cache_status = m_tag_array->access(block_addr,time,cache_index); // update LRU state
+    else if ( status == RESERVATION_FAIL || read_miss_blocked(block_addr,0) ) 
+        cache_status = RESERVATION_FAIL;
+    else 
+        return MISS; // access() repeats the probe and sends the request
+    m_stats.inc_stats(type, m_stats.select_stats_status(status, cache_status));
+    m_stats.inc_policy_stats(m_tag_array->set_policy(block_addr), cache_status);
     return cache_status;
 }
 
@@ -1047,6 +1256,36 @@ data_cache::access( new_addr_type addr,
         = process_tag_probe( wr, probe_status, addr, cache_index, mf, time, events );//-modify cache tag array.
     m_stats.inc_stats(mf->get_access_type(),
         m_stats.select_stats_status(probe_status, access_status));
+    m_stats.inc_policy_stats(m_tag_array->set_policy(block_addr), access_status);
+    return access_status;
+}
+
+/// Read-hit/reservation-fail half of access() for non-atomic reads, see 
+/// rd_hit_base() and rd_miss_base(). On MISS nothing is changed.
+enum cache_request_status
+data_cache::probe_read( new_addr_type addr,
+                        enum mem_access_type type,
+                        unsigned size,
+                        unsigned time )
+{
+    assert( size <= m_config.get_line_sz());
+    assert( m_rd_hit == &data_cache::rd_hit_base && m_rd_miss == &data_cache::rd_miss_base );
+    new_addr_type block_addr = m_config.block_addr(addr);
+    unsigned cache_index = (unsigned)-1;
+    enum cache_request_status probe_status = m_tag_array->probe( block_addr, cache_index );
+    enum cache_request_status access_status;
+    if ( probe_status == HIT ) {
+        m_tag_array->access(block_addr,time,cache_index);
+        access_status = HIT;
+    } else if ( probe_status == RESERVATION_FAIL || read_miss_blocked(block_addr,1) ) {
+        access_status = RESERVATION_FAIL;
+    } else {
+        return MISS;
+    }
+    std::list<cache_event> events;
+    m_bandwidth_management.use_data_port(size, access_status, events); 
+    m_stats.inc_stats(type, m_stats.select_stats_status(probe_status, access_status));
+    m_stats.inc_policy_stats(m_tag_array->set_policy(block_addr), access_status);
     return access_status;
 }
 
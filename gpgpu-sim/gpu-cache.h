@@ -34,6 +34,8 @@
 #include "mem_fetch.h"
 #include "../abstract_hardware_model.h"
 #include "../tr1_hash_map.h"
+#include <set>
+#include <vector>
 
 #include "addrdec.h"
 
@@ -69,6 +71,9 @@ struct cache_block_t {
         m_fill_time=0;
         m_last_access_time=0;
         m_status=INVALID;
+        m_rrpv=0;
+        m_reused=false;
+        m_signature=0;
     }
     void allocate( new_addr_type tag, new_addr_type block_addr, unsigned time )
     {
@@ -92,11 +97,26 @@ struct cache_block_t {
     unsigned         m_last_access_time;
     unsigned         m_fill_time;
     cache_block_state    m_status;
+
+    // replacement state of the RRIP family, managed by tag_array
+    unsigned char    m_rrpv;      // re-reference prediction value
+    bool             m_reused;    // hit since it was inserted (SHiP training)
+    unsigned short   m_signature; // PC signature of the access that inserted it (SHiP)
 };
 
 enum replacement_policy_t {
     LRU,
-    FIFO
+    FIFO,
+    SRRIP,  // static re-reference interval prediction
+    BRRIP,  // bimodal RRIP: insert distant, occasionally long
+    DRRIP,  // SRRIP/BRRIP chosen by set dueling
+    SHIP,   // SRRIP with insertion predicted from the PC signature
+    N_REPLACEMENT_POLICY
+};
+
+enum bypass_policy_t {
+    BYPASS_NONE,
+    BYPASS_PREDICT // misses from PCs whose lines are never reused do not allocate
 };
 
 enum write_policy_t {
@@ -118,6 +138,10 @@ enum write_allocate_policy_t {
 	WRITE_ALLOCATE
 };
 
+// tag arrays are allocated this many times larger than the configured size so
+// that the capacity can be grown at runtime (see cache_config::set_capacity)
+#define MAX_DEFAULT_CACHE_SIZE_MULTIBLIER 4
+
 enum mshr_config_t {
     TEX_FIFO,
     ASSOC // normal cache 
@@ -139,13 +163,13 @@ public:
     {
     	cache_status= status;
         assert( config );
-        char rp, wp, ap, mshr_type, wap;
+        char rp, wp, ap, mshr_type, wap, bp = 'N';
 		printf("%s\n",config);  //32:128:4, L:L:m:N   , A:64:8 ,8
-        int ntok = sscanf(config,"%u:%u:%u,%c:%c:%c:%c,%c:%u:%u,%u:%u,%u",
+        int ntok = sscanf(config,"%u:%u:%u,%c:%c:%c:%c,%c:%u:%u,%u:%u,%u,%c",
                           &m_nset, &m_line_sz, &m_assoc, &rp, &wp, &ap, &wap,
                           &mshr_type, &m_mshr_entries,&m_mshr_max_merge,
                           &m_miss_queue_size,&m_result_fifo_entries,
-                          &m_data_port_width);
+                          &m_data_port_width, &bp);
 		system("echo -e\" \\033[1;36m   cache config    \\033[0m  \"");//cjllean
         if ( ntok < 11 ) {
             if ( !strcmp(config,"none") ) {
@@ -157,6 +181,15 @@ public:
         switch (rp) {
         case 'L': m_replacement_policy = LRU; break;
         case 'F': m_replacement_policy = FIFO; break;
+        case 'S': m_replacement_policy = SRRIP; break;
+        case 'B': m_replacement_policy = BRRIP; break;
+        case 'D': m_replacement_policy = DRRIP; break;
+        case 'P': m_replacement_policy = SHIP; break;
+        default: exit_parse_error();
+        }
+        switch (bp) {
+        case 'N': m_bypass_policy = BYPASS_NONE; break;
+        case 'P': m_bypass_policy = BYPASS_PREDICT; break;
         default: exit_parse_error();
         }
         switch (wp) {
@@ -208,6 +241,7 @@ public:
         assert(m_line_sz % m_data_port_width == 0); 
     }
     bool disabled() const { return m_disabled;}
+    bool rrip_replacement() const { return m_replacement_policy >= SRRIP; }
     unsigned get_line_sz() const
     {
         assert( m_valid );
@@ -219,6 +253,23 @@ public:
         return m_nset * m_assoc;
     }
 
+    // resize the cache to (at most) the given number of bytes by changing its
+    // associativity; the number of sets and line size stay fixed.  At least one
+    // way is kept, and the tag array cannot grow beyond what was allocated for
+    // the configuration string.  Returns the resulting capacity in bytes.
+    unsigned set_capacity( unsigned bytes )
+    {
+        assert( m_valid );
+        unsigned max_assoc = m_assoc * MAX_DEFAULT_CACHE_SIZE_MULTIBLIER;
+        unsigned assoc = bytes / (m_nset * m_line_sz);
+        if (assoc < 1) assoc = 1;
+        if (assoc > max_assoc) assoc = max_assoc;
+        m_assoc = assoc;
+        return m_nset * m_assoc * m_line_sz;
+    }
+    unsigned get_nset() const { return m_nset; }
+    unsigned get_assoc() const { return m_assoc; }
+
     void print( FILE *fp ) const
     {
         fprintf( fp, "Size = %d B (%d Set x %d-way x %d byte line)\n", 
@@ -265,7 +316,8 @@ protected:
     unsigned m_nset_log2;
     unsigned m_assoc;
 
-    enum replacement_policy_t m_replacement_policy; // 'L' = LRU, 'F' = FIFO
+    enum replacement_policy_t m_replacement_policy; // 'L' = LRU, 'F' = FIFO, 'S' = SRRIP, 'B' = BRRIP, 'D' = DRRIP, 'P' = SHiP
+    enum bypass_policy_t m_bypass_policy;           // 'N' = never bypass, 'P' = PC-based bypass predictor
     enum write_policy_t m_write_policy;             // 'T' = write through, 'B' = write back, 'R' = read only
     enum allocation_policy_t m_alloc_policy;        // 'm' = allocate on miss, 'f' = allocate on fill
     enum mshr_config_t m_mshr_type;
@@ -315,12 +367,18 @@ public:
     ~tag_array();
 
     enum cache_request_status probe( new_addr_type addr, unsigned &idx ) const;
-    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx );
-    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted );
+    // mf, when given, supplies the PC signature used by SHiP on a miss
+    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx, const mem_fetch *mf = NULL );
+    enum cache_request_status access( new_addr_type addr, unsigned time, unsigned &idx, bool &wb, cache_block_t &evicted, const mem_fetch *mf = NULL );
 
-    void fill( new_addr_type addr, unsigned time );
+    void fill( new_addr_type addr, unsigned time, const mem_fetch *mf = NULL );
     void fill( unsigned idx, unsigned time );
 
+    // replacement policy governing the set of addr (DRRIP picks SRRIP or BRRIP per set)
+    enum replacement_policy_t set_policy( new_addr_type addr ) const;
+    // true if a miss of mf should not allocate a line
+    bool predict_bypass( const mem_fetch *mf );
+
     unsigned size() const { return m_config.get_num_lines();}
     cache_block_t &get_block(unsigned idx) { return m_lines[idx];}
 
@@ -342,6 +400,12 @@ protected:
                cache_block_t* new_lines );
     void init( int core_id, int type_id );
 
+    enum replacement_policy_t policy_of_set( unsigned set_index ) const;
+    unsigned signature( const mem_fetch *mf ) const;
+    void replacement_hit( unsigned idx );
+    void replacement_miss( unsigned idx );
+    void replacement_insert( unsigned idx, const mem_fetch *mf );
+
 protected:
 
     cache_config &m_config;
@@ -360,6 +424,12 @@ protected:
 
     int m_core_id; // which shader core is using this
     int m_type_id; // what kind of cache is this (normal, texture, constant)
+
+    // RRIP / SHiP / bypass predictor state
+    unsigned m_psel;                    // DRRIP set dueling counter, high = BRRIP wins
+    unsigned m_brrip_count;             // BRRIP inserts long once every BRRIP_LONG_PERIOD fills
+    unsigned m_bypass_count;            // one in BYPASS_SAMPLE_PERIOD predicted bypasses still allocates
+    std::vector<unsigned char> m_shct;  // signature history counter table (SHiP and bypass predictor)
 };
 
 class mshr_table {
@@ -499,6 +569,8 @@ public:
     void get_sub_stats(struct cache_sub_stats &css) const;
 
     void sample_cache_port_utility(bool data_port_busy, bool fill_port_busy); 
+    void inc_policy_stats(enum replacement_policy_t policy, enum cache_request_status status);
+    void inc_bypass() { m_bypass++; }
 private:
     bool check_valid(int type, int status) const;
 
@@ -507,12 +579,21 @@ private:
     unsigned long long m_cache_port_available_cycles; 
     unsigned long long m_cache_data_port_busy_cycles; 
     unsigned long long m_cache_fill_port_busy_cycles; 
+
+    // accesses and hits by the replacement policy governing the set, and misses that bypassed the cache
+    unsigned long long m_policy_access[N_REPLACEMENT_POLICY];
+    unsigned long long m_policy_hit[N_REPLACEMENT_POLICY];
+    unsigned long long m_bypass;
 };
 
 class cache_t {
 public:
     virtual ~cache_t() {}
     virtual enum cache_request_status access( new_addr_type addr, mem_fetch *mf, unsigned time, std::list<cache_event> &events ) =  0;
+    /// Non-allocating front half of access() for plain (non-atomic) reads: a hit, or a 
+    /// reservation fail that does not depend on the request, is serviced without a mem_fetch. 
+    /// MISS means the caller has to allocate a mem_fetch and call access() to send the miss.
+    virtual enum cache_request_status probe_read( new_addr_type addr, enum mem_access_type type, unsigned size, unsigned time ) { return MISS; }
 
     // accessors for cache bandwidth availability 
     virtual bool data_port_free() const = 0; 
@@ -634,6 +715,7 @@ protected:
     typedef std::map<mem_fetch*,extra_mf_fields> extra_mf_fields_lookup;//- map (mf*, extra_mf_field) 
 
     extra_mf_fields_lookup m_extra_mf_fields;
+    std::set<new_addr_type> m_bypass_blocks; // pending misses that will not allocate a line
 
     cache_stats m_stats;
 
@@ -641,6 +723,10 @@ protected:
     bool miss_queue_full(unsigned num_miss){
     	  return ( (m_miss_queue.size()+num_miss) >= m_config.m_miss_queue_size );
     }
+    /// Would send_read_request() fail to accept a read miss to block_addr this cycle?
+    bool read_miss_blocked(new_addr_type block_addr, unsigned num_miss){
+        return miss_queue_full(num_miss) || m_mshrs.full(block_addr);
+    }
     /// Read miss handler without writeback
     void send_read_request(new_addr_type addr, new_addr_type block_addr, unsigned cache_index, mem_fetch *mf,
     		unsigned time, bool &do_miss, std::list<cache_event> &events, bool read_only, bool wa);
@@ -656,6 +742,7 @@ protected:
 
         /// use the data port based on the outcome and events generated by the mem_fetch request 
         void use_data_port(mem_fetch *mf, enum cache_request_status outcome, const std::list<cache_event> &events); 
+        void use_data_port(unsigned data_size, enum cache_request_status outcome, const std::list<cache_event> &events); 
 
         /// use the fill port 
         void use_fill_port(mem_fetch *mf); 
@@ -685,6 +772,7 @@ public:
 
     /// Access cache for read_only_cache: returns RESERVATION_FAIL if request could not be accepted (for any reason)
     virtual enum cache_request_status access( new_addr_type addr, mem_fetch *mf, unsigned time, std::list<cache_event> &events );
+    virtual enum cache_request_status probe_read( new_addr_type addr, enum mem_access_type type, unsigned size, unsigned time );
 
     virtual ~read_only_cache(){}
 
@@ -750,6 +838,7 @@ public:
                                               mem_fetch *mf,
                                               unsigned time,
                                               std::list<cache_event> &events );
+    virtual enum cache_request_status probe_read( new_addr_type addr, enum mem_access_type type, unsigned size, unsigned time );
 protected:
     data_cache( const char *name,
                 cache_config &config,
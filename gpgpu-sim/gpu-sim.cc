@@ -108,6 +108,10 @@ void power_config::reg_options(class OptionParser * opp)
 			  	  	  	  	 &g_power_config_name,"GPUWattch XML file",
 	                   "gpuwattch.xml");
 
+	  option_parser_register(opp, "-gpuwattch_cacti_cache", OPT_CSTR,
+			  	  	  	  	 &g_cacti_cache_name,"File that keeps CACTI array solutions across runs (none = per run only)",
+	                   "none");
+
 	   option_parser_register(opp, "-power_simulation_enabled", OPT_BOOL,
 	                          &g_power_simulation_enabled, "Turn on power simulator (1=On, 0=Off)",
 	                          "0");
@@ -148,7 +152,8 @@ void memory_config::reg_options(class OptionParser * opp)
                            "0");
     option_parser_register(opp, "-gpgpu_cache:dl2", OPT_CSTR, &m_L2_config.m_config_string, 
                    "unified banked L2 data cache config "
-                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>}",
+                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>[:<rf>,<port width>,<bypass>]}"
+                   " <rep> = L(RU), F(IFO), S(RRIP), B(RRIP), D(RRIP), P (SHiP); <bypass> = N(one), P(C-based predictor)",
                    "64:128:8,L:B:m:N,A:16:4,4");
     option_parser_register(opp, "-gpgpu_cache:dl2_texture_only", OPT_BOOL, &m_L2_texure_only, 
                            "L2 cache used for texture only",
@@ -165,6 +170,9 @@ void memory_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_memlatency_stat", OPT_INT32, &gpgpu_memlatency_stat, 
                 "track and display latency statistics 0x2 enables MC, 0x4 enables queue logs",
                 "0");
+    option_parser_register(opp, "-gpgpu_memlatency_breakdown", OPT_BOOL, &gpgpu_memlatency_breakdown, 
+                "break down load latency per stage (L1 miss, icnt, L2, DRAM, return) per PC, printed at kernel exit",
+                "0");
     option_parser_register(opp, "-gpgpu_frfcfs_dram_sched_queue_size", OPT_INT32, &gpgpu_frfcfs_dram_sched_queue_size, 
                 "0 = unlimited (default); # entries per chip",
                 "0");
@@ -189,6 +197,10 @@ void memory_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-dram_latency", OPT_UINT32, &dram_latency,
                      "DRAM latency (default 30)",
                      "30");
+    option_parser_register(opp, "-gpgpu_l2_atomic_unit", OPT_CSTR, &gpgpu_l2_atomic_unit_opt,
+                     "near-memory atomic unit per memory sub partition "
+                     "{<lane ops per cycle>:<latency>:<queue size>:<max merged reductions>} (0 ops per cycle = disabled)",
+                     "0:4:8:4");
 
     m_address_mapping.addrdec_setoption(opp);
 }
@@ -212,9 +224,11 @@ void shader_core_config::reg_options(class OptionParser * opp)
                    "shader L1 instruction cache config "
                    " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>} ",
                    "4:256:4,L:R:f:N,A:2:32,4" );
+    m_iprefetch_config.reg_options(opp);
     option_parser_register(opp, "-gpgpu_cache:dl1", OPT_CSTR, &m_L1D_config.m_config_string,
                    "per-shader L1 data cache config "
-                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq> | none}",
+                   " {<nsets>:<bsize>:<assoc>,<rep>:<wr>:<alloc>:<wr_alloc>,<mshr>:<N>:<merge>,<mq>[:<rf>,<port width>,<bypass>] | none}"
+                   " (see -gpgpu_cache:dl2 for <rep> and <bypass>)",
                    "none" );
     option_parser_register(opp, "-gpgpu_cache:dl1PrefL1", OPT_CSTR, &m_L1D_config.m_config_stringPrefL1,
                    "per-shader L1 data cache config "
@@ -258,6 +272,9 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_n_ldst_response_buffer_size", OPT_UINT32, &ldst_unit_response_queue_size, 
                  "number of response packets in ld/st unit ejection buffer",
                  "2");
+    option_parser_register(opp, "-gpgpu_bulk_copy_queue_size", OPT_UINT32, &gpgpu_bulk_copy_queue_size, 
+                 "number of asynchronous global to shared memory bulk copies (cp.async.bulk) in flight per ldst unit",
+                 "8");
     option_parser_register(opp, "-gpgpu_shmem_size", OPT_UINT32, &gpgpu_shmem_size,
                  "Size of shared memory per shader core (default 16kB)",
                  "16384");
@@ -270,6 +287,15 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_shmem_size_PrefShared", OPT_UINT32, &gpgpu_shmem_sizePrefShared,
                  "Size of shared memory per shader core (default 16kB)",
                  "16384");
+    option_parser_register(opp, "-gpgpu_unified_l1d_size", OPT_UINT32, &gpgpu_unified_l1d_size,
+                 "Size in KB of the on-chip SRAM shared by L1D and shared memory; the L1D gets what the carveout leaves (0 = separate, default)",
+                 "0");
+    option_parser_register(opp, "-gpgpu_shmem_carveouts", OPT_CSTR, &gpgpu_shmem_carveouts_opt,
+                 "Shared memory carveouts in KB selectable per kernel with -gpgpu_unified_l1d_size",
+                 "0,8,16,32,64");
+    option_parser_register(opp, "-gpgpu_kernel_carveout", OPT_CSTR, &gpgpu_kernel_carveout_opt,
+                 "Fixed shared memory carveout per kernel {<kernel name>:<KB>,...} (others are chosen from occupancy)",
+                 "none");
     option_parser_register(opp, "-gpgpu_shmem_num_banks", OPT_UINT32, &num_shmem_bank, 
                  "Number of banks in the shared memory in each shader core (default 16)",
                  "16");
@@ -294,6 +320,15 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_reg_bank_use_warp_id", OPT_BOOL, &gpgpu_reg_bank_use_warp_id,
              "Use warp ID in mapping registers to banks (default = off)",
              "0");
+    option_parser_register(opp, "-gpgpu_rf_cache_entries", OPT_UINT32, &gpgpu_rf_cache_entries,
+             "Number of registers per warp held in the register-file cache in front of the banks (default = 0, disabled)",
+             "0");
+    option_parser_register(opp, "-gpgpu_rf_cache_policy", OPT_CHAR, &gpgpu_rf_cache_policy,
+             "Register-file cache fill policy: L = LRU of all operands and results, R = keep source operands the next instruction reuses (default = R)",
+             "R");
+    option_parser_register(opp, "-gpgpu_dwf_max_warps", OPT_UINT32, &gpgpu_dwf_max_warps,
+             "Dynamic warp formation: max warps of a CTA at the same PC with disjoint active lanes issued in one SP/SFU slot (default = 1, disabled)",
+             "1");
     option_parser_register(opp, "-gpgpu_operand_collector_num_units_sp", OPT_INT32, &gpgpu_operand_collector_num_units_sp,
                 "number of collector units (default = 4)", 
                 "4");
@@ -339,6 +374,12 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_max_insn_issue_per_warp", OPT_INT32, &gpgpu_max_insn_issue_per_warp,
                             "Max number of instructions that can be issued per warp in one cycle by scheduler",
                             "2");
+    option_parser_register(opp, "-gpgpu_sub_core_model", OPT_BOOL, &gpgpu_sub_core_model,
+                            "Sub-core SM: each scheduler owns a slice of the SP/SFU units, collector units and register banks (default = off)",
+                            "0");
+    option_parser_register(opp, "-gpgpu_dual_issue_diff_exec_units", OPT_BOOL, &gpgpu_dual_issue_diff_exec_units,
+                            "Let a scheduler issue two independent instructions per cycle, from one or two warps, to different unit types (default = off)",
+                            "0");
     option_parser_register(opp, "-gpgpu_simt_core_sim_order", OPT_INT32, &simt_core_sim_order,
                             "Select the simulation order of cores in a cluster (0=Fix, 1=Round-Robin)",
                             "1");
@@ -352,6 +393,12 @@ void shader_core_config::reg_options(class OptionParser * opp)
     option_parser_register(opp, "-gpgpu_num_sfu_units", OPT_INT32, &gpgpu_num_sfu_units,
                             "Number of SF units (default=1)",
                             "1");
+    option_parser_register(opp, "-gpgpu_num_tensor_core_units", OPT_INT32, &gpgpu_num_tensor_core_units,
+                            "Number of tensor core units, 0 = mma executes on the SP units (default=0)",
+                            "0");
+    option_parser_register(opp, "-gpgpu_tensor_core_config", OPT_CSTR, &gpgpu_tensor_core_config_opt,
+                            "Tensor core unit {<tile_m>:<tile_n>:<tile_k>:<cycles per tile>:<pipeline latency>}",
+                            "4:4:4:1:8");
     option_parser_register(opp, "-gpgpu_num_mem_units", OPT_INT32, &gpgpu_num_mem_units,
                             "Number if ldst units (default=1) WARNING: not hooked up to anything",
                              "1");
@@ -368,6 +415,10 @@ void gpgpu_sim_config::reg_options(option_parser_t opp)
     gpgpu_functional_sim_config::reg_options(opp);
     m_shader_config.reg_options(opp);
     m_memory_config.reg_options(opp);
+    m_copy_engine_config.reg_options(opp);
+    m_tlb_config.reg_options(opp);
+    m_dvfs_config.reg_options(opp);
+    m_kernel_dispatcher_config.reg_options(opp);
     power_config::reg_options(opp);
    option_parser_register(opp, "-gpgpu_max_cycle", OPT_INT32, &gpu_max_cycle_opt, 
                "terminates gpu simulation early (0 = no limit)",
@@ -470,6 +521,7 @@ void gpgpu_sim::launch( kernel_info_t *kinfo )
        }
    }
    assert(n < m_running_kernels.size());
+   m_kernel_dispatcher->launch(kinfo);
 }
 
 bool gpgpu_sim::can_start_kernel()
@@ -494,23 +546,50 @@ bool gpgpu_sim::get_more_cta_left() const
    return false;
 }
 
-kernel_info_t *gpgpu_sim::select_kernel()
+void gpgpu_sim::record_executed_kernel( kernel_info_t *kernel )
 {
-    for(unsigned n=0; n < m_running_kernels.size(); n++ ) {
-        unsigned idx = (n+m_last_issued_kernel+1)%m_config.max_concurrent_kernel;
-        if( m_running_kernels[idx] && !m_running_kernels[idx]->no_more_ctas_to_run() ) {
-            m_last_issued_kernel=idx;
-            // record this kernel for stat print if it is the first time this kernel is selected for execution  
-            unsigned launch_uid = m_running_kernels[idx]->get_uid(); 
-            if (std::find(m_executed_kernel_uids.begin(), m_executed_kernel_uids.end(), launch_uid) == m_executed_kernel_uids.end()) {
-               m_executed_kernel_uids.push_back(launch_uid); 
-               m_executed_kernel_names.push_back(m_running_kernels[idx]->name()); 
-            }
-
-            return m_running_kernels[idx];
-        }
+    // record this kernel for stat print if it is the first time this kernel is selected for execution  
+    unsigned launch_uid = kernel->get_uid(); 
+    if (std::find(m_executed_kernel_uids.begin(), m_executed_kernel_uids.end(), launch_uid) == m_executed_kernel_uids.end()) {
+       m_executed_kernel_uids.push_back(launch_uid); 
+       m_executed_kernel_names.push_back(kernel->name()); 
     }
-    return NULL;
+}
+
+kernel_info_t *gpgpu_sim::select_kernel( unsigned sid )
+{
+    kernel_info_t *kernel = m_kernel_dispatcher->select_kernel(sid);
+    if( kernel ) 
+        record_executed_kernel(kernel);
+    return kernel;
+}
+
+kernel_info_t *gpgpu_sim::select_shared_kernel( shader_core_ctx *core )
+{
+    kernel_info_t *kernel = m_kernel_dispatcher->select_shared_kernel(core);
+    if( kernel ) 
+        record_executed_kernel(kernel);
+    return kernel;
+}
+
+bool gpgpu_sim::may_issue( unsigned sid, const kernel_info_t *kernel ) const
+{
+    return m_kernel_dispatcher->may_issue(sid, kernel);
+}
+
+bool gpgpu_sim::shares_cores() const
+{
+    return m_kernel_dispatcher->shares_cores();
+}
+
+void gpgpu_sim::cta_issued( const kernel_info_t *kernel, unsigned n_warps )
+{
+    m_kernel_dispatcher->cta_issued(kernel, n_warps);
+}
+
+void gpgpu_sim::cta_done( const kernel_info_t *kernel, unsigned n_warps )
+{
+    m_kernel_dispatcher->cta_done(kernel, n_warps);
 }
 
 unsigned gpgpu_sim::finished_kernel()
@@ -522,10 +601,30 @@ unsigned gpgpu_sim::finished_kernel()
     return result;
 }
 
+void gpgpu_sim::launch_memcpy( struct CUstream_st *stream, enum copy_direction dir, 
+                               size_t dst, size_t src, size_t count, bool dma )
+{
+    assert( m_copy_engine );
+    m_copy_engine->launch(stream, dir, dst, src, count, dma);
+}
+
+struct CUstream_st *gpgpu_sim::finished_memcpy()
+{
+    if( !m_copy_engine ) 
+        return NULL;
+    return m_copy_engine->finished();
+}
+
+bool gpgpu_sim::copy_engine_busy() const
+{
+    return m_copy_engine && m_copy_engine->busy();
+}
+
 void gpgpu_sim::set_kernel_done( kernel_info_t *kernel ) 
 { 
     unsigned uid = kernel->get_uid();
     m_finished_kernel.push_back(uid);
+    m_kernel_dispatcher->kernel_done(kernel);
     std::vector<kernel_info_t*>::iterator k;
     for( k=m_running_kernels.begin(); k!=m_running_kernels.end(); k++ ) {
         if( *k == kernel ) {
@@ -549,7 +648,7 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )
     ptx_file_line_stats_create_exposed_latency_tracker(m_config.num_shader());
 
 #ifdef GPGPUSIM_POWER_MODEL
-        m_gpgpusim_wrapper = new gpgpu_sim_wrapper(config.g_power_simulation_enabled,config.g_power_config_name);
+        m_gpgpusim_wrapper = new gpgpu_sim_wrapper(config.g_power_simulation_enabled,config.g_power_config_name,config.g_cacti_cache_name);
 #endif
 
     m_shader_stats = new shader_core_stats(m_shader_config);//- only one, shared by all cores
@@ -562,14 +661,25 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )
     gpu_tot_sim_insn = 0;
     gpu_tot_issued_cta = 0;
     gpu_deadlock = false;
+    m_l1d_carveout = (unsigned)-1;
 
 
+    m_memory_partition_unit = new memory_partition_unit*[m_memory_config->m_n_mem];
+    m_memory_sub_partition = new memory_sub_partition*[m_memory_config->m_n_mem_sub_partition];
+
+    // created before the cores, which attach their L1 TLBs to it 
+    m_mmu = NULL;
+    if (m_config.m_tlb_config.enabled) 
+        m_mmu = new gpu_mmu(m_config.m_tlb_config, m_memory_config, m_memory_sub_partition);
+
+    m_dvfs = NULL;
+    if (m_config.m_dvfs_config.enabled()) 
+        m_dvfs = new dvfs_controller(m_config.m_dvfs_config, m_shader_config);
+
     m_cluster = new simt_core_cluster*[m_shader_config->n_simt_clusters];
     for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) //-all clusters share a core_stats
         m_cluster[i] = new simt_core_cluster(this,i,m_shader_config,m_memory_config,m_shader_stats,m_memory_stats);
 
-    m_memory_partition_unit = new memory_partition_unit*[m_memory_config->m_n_mem];
-    m_memory_sub_partition = new memory_sub_partition*[m_memory_config->m_n_mem_sub_partition];
     for (unsigned i=0;i<m_memory_config->m_n_mem;i++) {
         m_memory_partition_unit[i] = new memory_partition_unit(i, m_memory_config, m_memory_stats);
         for (unsigned p = 0; p < m_memory_config->m_n_sub_partition_per_memory_channel; p++) {
@@ -581,11 +691,15 @@ gpgpu_sim::gpgpu_sim( const gpgpu_sim_config &config )
     icnt_wrapper_init();
     icnt_create(m_shader_config->n_simt_clusters,m_memory_config->m_n_mem_sub_partition);
 
+    m_copy_engine = NULL;
+    if (m_config.m_copy_engine_config.enabled()) 
+        m_copy_engine = new copy_engine(m_config.m_copy_engine_config, m_memory_config, m_memory_sub_partition);
+
     time_vector_create(NUM_MEM_REQ_STAT);
     fprintf(stdout, "GPGPU-Sim uArch: performance model initialization complete.\n");
 
     m_running_kernels.resize( config.max_concurrent_kernel, NULL );
-    m_last_issued_kernel = 0;
+    m_kernel_dispatcher = new kernel_dispatcher(m_config.m_kernel_dispatcher_config, m_shader_config, m_running_kernels);
     m_last_cluster_issue = 0;
     *average_pipeline_duty_cycle=0;
     *active_sms=0;
@@ -831,6 +945,35 @@ void gpgpu_sim::set_cache_config(std::string kernel_name)
 }
 
 
+// With a unified L1D/shared SRAM the split is chosen per kernel from the
+// carveout list; the L1D keeps its sets and is resized through its associativity.
+void gpgpu_sim::set_cache_config(const kernel_info_t &kernel)
+{
+	if(!m_shader_config->unified_l1d()){
+		set_cache_config(kernel.name());
+		return;
+	}
+	FuncCache pref = has_special_cache_config(kernel.name()) ? get_cache_config(kernel.name()) : FuncCachePreferNone;
+	unsigned carveout = m_shader_config->shmem_carveout(kernel, pref);
+	if(carveout != m_l1d_carveout){
+		if(m_l1d_carveout != (unsigned)-1){
+			printf("FLUSH L1 Cache at shared memory carveout change between kernels\n");
+			for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+				m_cluster[i]->cache_flush();
+			}
+		}
+		m_l1d_carveout = carveout;
+	}
+
+	unsigned l1d_size = 0;
+	m_shader_config->m_L1D_config.init(m_shader_config->m_L1D_config.m_config_string, pref);
+	if(!m_shader_config->m_L1D_config.disabled())
+		l1d_size = m_shader_config->m_L1D_config.set_capacity(m_shader_config->gpgpu_unified_l1d_size*1024 - carveout);
+	m_shader_config->gpgpu_shmem_size = carveout;
+	printf("GPGPU-Sim uArch: kernel '%s' unified L1D/shared carveout: shmem = %uKB, L1D = %uKB\n",
+	       kernel.name().c_str(), carveout/1024, l1d_size/1024);
+}
+
 void gpgpu_sim::change_cache_config(FuncCache cache_config)
 {
 	if(cache_config != m_shader_config->m_L1D_config.get_cache_status()){
@@ -880,10 +1023,6 @@ void gpgpu_sim::clear_executed_kernel_info()
    m_executed_kernel_uids.clear();
 }
 
-extern long  g_prefetch;      //-defined and inited in gpgpusim_entrypoint.cc:201
-extern long  g_prefetch_mem;  //-defined and inited in gpgpusim_entrypoint.cc:201
-extern long  g_fetch;           //-defined and inited in gpgpusim_entrypoint.cc:201
-extern long  g_fetch_stage_cycles;
 void gpgpu_sim::gpu_print_stat() 
 {  
    FILE *statfout = stdout; 
@@ -894,7 +1033,6 @@ void gpgpu_sim::gpu_print_stat()
    fprintf(statfout, "%s", kernel_info_str.c_str()); 
    fprintf(statfout, "\n**********************************************************************\n"); 
 
-   printf("g_fetch              = %8ld   g_prefetch         = %8ld   g_prefetch_mem(miss_in_L1I) = %8ld      g_fetch_stage_cycles  =  %8ld\n", g_fetch, g_prefetch,g_prefetch_mem, g_fetch_stage_cycles );
    printf("gpu_sim_cycle        = %8lld  gpu_tot_sim_cycle  = %8lld\n", gpu_sim_cycle, gpu_tot_sim_cycle+gpu_sim_cycle);
    printf("gpu_sim_insn         = %8lld  gpu_tot_sim_insn   = %8lld\n", gpu_sim_insn,gpu_tot_sim_insn+gpu_sim_insn);
    printf("gpu_ipc              = %8.4f  gpu_tot_ipc        = %8.4f\n", (float)gpu_sim_insn / gpu_sim_cycle,
@@ -939,6 +1077,26 @@ void gpgpu_sim::gpu_print_stat()
    // performance counter that are not local to one shader
    printf("\n--------- memory latency status  ------------------\n");
    //m_memory_stats->memlatstat_print(m_memory_config->m_n_mem,m_memory_config->nbk);
+   m_memory_stats->memlatstat_breakdown_print(stdout);
+   m_memory_stats->memlatstat_imbalance_print(stdout);
+
+   printf("\n--------- concurrent kernel status  ---------------\n");
+   m_kernel_dispatcher->print_stats(stdout);
+
+   if (m_copy_engine) {
+      printf("\n--------- copy engine status  ---------------------\n");
+      m_copy_engine->print_stats(stdout);
+   }
+
+   if (m_mmu) {
+      printf("\n--------- address translation status  -------------\n");
+      m_mmu->print_stats(stdout);
+   }
+
+   if (m_dvfs) {
+      printf("\n--------- dvfs status  ----------------------------\n");
+      m_dvfs->print_stats(stdout);
+   }
 
    printf("\n--------- memory partition unit status  -----------\n");
    //for (unsigned i=0;i<m_memory_config->m_n_mem;i++)
@@ -978,6 +1136,15 @@ void gpgpu_sim::gpu_print_stat()
        }
    }
 
+   // near-memory atomic unit stats
+   if (m_memory_config->m_atomic_unit_throughput) {
+       atomic_unit_stats total_atomic_stats;
+       for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++)
+           total_atomic_stats += m_memory_sub_partition[i]->get_atomic_unit_stats();
+       printf("\n========= L2 atomic unit stats =========\n");
+       total_atomic_stats.print(stdout, "L2_atomic_unit");
+   }
+
    if (m_config.gpgpu_cflog_interval != 0) {
       spill_log_to_file (stdout, 1, gpu_sim_cycle);
       printf("\n--------- insn warp occ print -----------\n");
@@ -1068,10 +1235,12 @@ void shader_core_ctx::mem_instruction_stats(const warp_inst_t &inst)
 void shader_core_ctx::issue_block2core( kernel_info_t &kernel ) 
 {
     set_max_cta(kernel);//set max cta per shader.
+    bool shared = m_gpu->shares_cores();
 
     // find a free CTA context 
     unsigned free_cta_hw_id=(unsigned)-1;
-    for (unsigned i=0;i<kernel_max_cta_per_shader;i++ ) {//-kernel_max_cta_per_shader <= MAX_CTA_PER_SHADER
+    unsigned max_cta_hw_id = shared? gs_min2(m_config->max_cta_per_core, (unsigned)MAX_CTA_PER_SHADER) : kernel_max_cta_per_shader;
+    for (unsigned i=0;i<max_cta_hw_id;i++ ) {//-kernel_max_cta_per_shader <= MAX_CTA_PER_SHADER
       if( m_cta_status[i]==0 ) {
          free_cta_hw_id=i;
          break;//-find first and stop find.
@@ -1088,9 +1257,23 @@ void shader_core_ctx::issue_block2core( kernel_info_t &kernel )
     int  padded_cta_size = cta_size; 
     if (cta_size%m_config->warp_size)
         padded_cta_size = ((cta_size/m_config->warp_size)+1)*(m_config->warp_size);
-    unsigned start_thread = free_cta_hw_id * padded_cta_size;
+    unsigned start_thread = shared? find_free_threads(padded_cta_size) : free_cta_hw_id * padded_cta_size;
+    assert( start_thread != (unsigned)-1 );
     unsigned end_thread   = start_thread +  cta_size;
 
+    // a shared core counts as running a kernel while it holds one of its CTAs
+    // (an exclusive core is counted from set_kernel() on)
+    if( shared && n_resident_ctas(&kernel) == 0 ) 
+        kernel.inc_running();
+    const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(kernel.entry());
+    cta_resource_t &res = m_cta_resource[free_cta_hw_id];
+    res.kernel = &kernel;
+    res.start_thread = start_thread;
+    res.threads = padded_cta_size;
+    res.regs = padded_cta_size * ((kernel_info->regs+3)&~3);
+    res.smem = kernel_info->smem;
+    m_gpu->cta_issued( &kernel, padded_cta_size / m_config->warp_size );
+
     // reset the microarchitecture state of the selected hardware thread and warp contexts
     reinit(start_thread, end_thread,false);
      
@@ -1170,6 +1353,30 @@ void gpgpu_sim::issue_block2core()
     }
 }
 
+/// Snapshot the monotonic cache/icnt/dram counters into pwr_mem_stat.
+/// Only mcpat_cycle() consumes them, and only at sample boundaries, so this
+/// is called there instead of re-accumulating every cycle.
+void gpgpu_sim::update_power_stats()
+{
+   mem_power_stats_pod *pwr_mem = m_power_stats->pwr_mem_stat;
+
+   pwr_mem->core_cache_stats[CURRENT_STAT_IDX].clear();
+   for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+      m_cluster[i]->get_icnt_stats(pwr_mem->n_simt_to_mem[CURRENT_STAT_IDX][i], pwr_mem->n_mem_to_simt[CURRENT_STAT_IDX][i]);
+      m_cluster[i]->get_cache_stats(pwr_mem->core_cache_stats[CURRENT_STAT_IDX]);
+   }
+
+   pwr_mem->l2_cache_stats[CURRENT_STAT_IDX].clear();
+   for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++)
+      m_memory_sub_partition[i]->accumulate_L2cache_stats(pwr_mem->l2_cache_stats[CURRENT_STAT_IDX]);
+
+   for (unsigned i=0;i<m_memory_config->m_n_mem;i++) {
+      m_memory_partition_unit[i]->set_dram_power_stats(pwr_mem->n_cmd[CURRENT_STAT_IDX][i], pwr_mem->n_activity[CURRENT_STAT_IDX][i],
+                     pwr_mem->n_nop[CURRENT_STAT_IDX][i], pwr_mem->n_act[CURRENT_STAT_IDX][i], pwr_mem->n_pre[CURRENT_STAT_IDX][i],
+                     pwr_mem->n_rd[CURRENT_STAT_IDX][i], pwr_mem->n_wr[CURRENT_STAT_IDX][i], pwr_mem->n_req[CURRENT_STAT_IDX][i]);
+   }
+}
+
 unsigned long long g_single_step=0; // set this in gdb to single step the pipeline
 
 void gpgpu_sim::cycle()
@@ -1177,15 +1384,27 @@ void gpgpu_sim::cycle()
    int clock_mask = next_clock_domain();
 
    if (clock_mask & CORE ) {
+      // clusters slowed down by DVFS skip some of the nominal core clock edges
+      if (m_dvfs) 
+         m_dvfs->clock();
        // shader core loading (pop from ICNT into core) follows CORE clock
       for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) 
-         m_cluster[i]->icnt_cycle(); 
+         if (!m_dvfs || m_dvfs->cluster_tick(i)) 
+            m_cluster[i]->icnt_cycle(); 
    }
     if (clock_mask & ICNT) {
         // pop from memory controller to interconnect
         for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) {
             mem_fetch* mf = m_memory_sub_partition[i]->top();
-            if (mf) {
+            if (mf && (mf->get_access_type() == DMA_ACC_R || mf->get_access_type() == DMA_ACC_W)) {
+                // copy engine DMA replies never enter the interconnect
+                m_memory_sub_partition[i]->pop();
+                m_copy_engine->dma_reply(mf);
+            } else if (mf && mf->get_access_type() == PTW_ACC_R) {
+                // so do page table walks
+                m_memory_sub_partition[i]->pop();
+                m_mmu->walk_reply(mf);
+            } else if (mf) {
                 unsigned response_size = mf->get_is_write()?mf->get_ctrl_size():mf->size();
                 if ( ::icnt_has_buffer( m_shader_config->mem2device(i), response_size ) ) {
                     if (!mf->get_is_write()) 
@@ -1205,16 +1424,11 @@ void gpgpu_sim::cycle()
    if (clock_mask & DRAM) {
       for (unsigned i=0;i<m_memory_config->m_n_mem;i++){
          m_memory_partition_unit[i]->dram_cycle(); // Issue the dram command (scheduler + delay model)
-         // Update performance counters for DRAM
-         m_memory_partition_unit[i]->set_dram_power_stats(m_power_stats->pwr_mem_stat->n_cmd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_activity[CURRENT_STAT_IDX][i],
-                        m_power_stats->pwr_mem_stat->n_nop[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_act[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_pre[CURRENT_STAT_IDX][i],
-                        m_power_stats->pwr_mem_stat->n_rd[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_wr[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_req[CURRENT_STAT_IDX][i]);
       }
    }
 
    // L2 operations follow L2 clock domain
    if (clock_mask & L2) {
-       m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX].clear();
       for (unsigned i=0;i<m_memory_config->m_n_mem_sub_partition;i++) {
           //move memory request from interconnect into memory partition (if not backed up)
           //Note:This needs to be called in DRAM clock domain if there is no L2 cache in the system
@@ -1225,7 +1439,6 @@ void gpgpu_sim::cycle()
               m_memory_sub_partition[i]->push( mf, gpu_sim_cycle + gpu_tot_sim_cycle );
           }
           m_memory_sub_partition[i]->cache_cycle(gpu_sim_cycle+gpu_tot_sim_cycle);
-          m_memory_sub_partition[i]->accumulate_L2cache_stats(m_power_stats->pwr_mem_stat->l2_cache_stats[CURRENT_STAT_IDX]);
        }
    }
 
@@ -1235,23 +1448,24 @@ void gpgpu_sim::cycle()
 
    if (clock_mask & CORE) {
       // L1 cache + shader core pipeline stages
-      m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX].clear();
       for (unsigned i=0;i<m_shader_config->n_simt_clusters;i++) {
+         if (m_dvfs && !m_dvfs->cluster_tick(i)) 
+            continue;
          if (m_cluster[i]->get_not_completed() || get_more_cta_left() ) {//-only the cores that has CTAS run cycle();
                m_cluster[i]->core_cycle();
                *active_sms+=m_cluster[i]->get_n_active_sms();
          }
-         // Update core icnt/cache stats for GPUWattch
-         m_cluster[i]->get_icnt_stats(m_power_stats->pwr_mem_stat->n_simt_to_mem[CURRENT_STAT_IDX][i], m_power_stats->pwr_mem_stat->n_mem_to_simt[CURRENT_STAT_IDX][i]);
-         m_cluster[i]->get_cache_stats(m_power_stats->pwr_mem_stat->core_cache_stats[CURRENT_STAT_IDX]);
       }
-      float temp=0;
-      for (unsigned i=0;i<m_shader_config->num_shader();i++){
-        temp+=m_shader_stats->m_pipeline_duty_cycle[i];
+      if (m_config.g_power_simulation_enabled) {
+         // duty cycle is integrated every cycle, the other power counters are sampled in update_power_stats()
+         float temp=0;
+         for (unsigned i=0;i<m_shader_config->num_shader();i++){
+           temp+=m_shader_stats->m_pipeline_duty_cycle[i];
+         }
+         temp=temp/m_shader_config->num_shader();
+         *average_pipeline_duty_cycle=((*average_pipeline_duty_cycle)+temp);
+           //cout<<"Average pipeline duty cycle: "<<*average_pipeline_duty_cycle<<endl;
       }
-      temp=temp/m_shader_config->num_shader();
-      *average_pipeline_duty_cycle=((*average_pipeline_duty_cycle)+temp);
-        //cout<<"Average pipeline duty cycle: "<<*average_pipeline_duty_cycle<<endl;
 
 
       if( g_single_step && ((gpu_sim_cycle+gpu_tot_sim_cycle) >= g_single_step) ) {
@@ -1264,11 +1478,29 @@ void gpgpu_sim::cycle()
       // McPAT main cycle (interface with McPAT)
     #ifdef GPGPUSIM_POWER_MODEL
       if(m_config.g_power_simulation_enabled){
+          bool sample = ((gpu_tot_sim_cycle+gpu_sim_cycle) % m_config.gpu_stat_sample_freq) == 0;
+          if (sample) {
+              update_power_stats();
+              for (unsigned i=0;i<m_shader_config->num_shader();i++) 
+                  m_gpgpusim_wrapper->set_core_power_scale(i, m_dvfs? m_dvfs->power_scale(m_shader_config->sid_to_cluster(i)) : 1.0);
+          }
           mcpat_cycle(m_config, getShaderCoreConfig(), m_gpgpusim_wrapper, m_power_stats, m_config.gpu_stat_sample_freq, gpu_tot_sim_cycle, gpu_sim_cycle, gpu_tot_sim_insn, gpu_sim_insn);
+          if (sample && m_dvfs) {
+              m_dvfs->set_power_sample(m_gpgpusim_wrapper->get_sample_power());
+              m_dvfs->reset_power_scale();
+          }
       }
     #endif
 
       issue_block2core();
+      m_kernel_dispatcher->cycle();
+
+      if (m_copy_engine) 
+         m_copy_engine->cycle();
+      if (m_mmu) 
+         m_mmu->cycle();
+      if (m_dvfs) 
+         m_dvfs->cycle(m_shader_stats, gpu_sim_cycle+gpu_tot_sim_cycle);
       
       // Depending on configuration, flush the caches once all of threads are completed.
       int all_threads_complete = 1;
@@ -1346,7 +1578,8 @@ void gpgpu_sim::cycle()
 
       if (!(gpu_sim_cycle % 20000)) {
          // deadlock detection 
-         if (m_config.gpu_deadlock_detect && gpu_sim_insn == last_gpu_sim_insn) {
+         // a GPU that only moves memcpy data does not commit instructions
+         if (m_config.gpu_deadlock_detect && gpu_sim_insn == last_gpu_sim_insn && !copy_engine_busy()) {
             gpu_deadlock = true;
          } else {
             last_gpu_sim_insn = gpu_sim_insn;
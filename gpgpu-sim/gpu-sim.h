@@ -33,6 +33,10 @@
 #include "../trace.h"
 #include "addrdec.h"
 #include "shader.h"
+#include "copy_engine.h"
+#include "tlb.h"
+#include "dvfs.h"
+#include "kernel_dispatcher.h"
 #include <iostream>
 #include <fstream>
 #include <list>
@@ -117,6 +121,7 @@ struct power_config {
 	void reg_options(class OptionParser * opp);
 
 	char *g_power_config_name;
+	char *g_cacti_cache_name;
 
 	bool m_valid;
     bool g_power_simulation_enabled;
@@ -212,6 +217,18 @@ struct memory_config {
       m_address_mapping.init(m_n_mem, m_n_sub_partition_per_memory_channel);
       m_L2_config.init(&m_address_mapping);
 
+      m_atomic_unit_throughput = 0;
+      m_atomic_unit_latency = 0;
+      m_atomic_unit_queue_size = 0;
+      m_atomic_unit_max_merge = 1;
+      sscanf(gpgpu_l2_atomic_unit_opt,"%u:%u:%u:%u", &m_atomic_unit_throughput, &m_atomic_unit_latency,
+             &m_atomic_unit_queue_size, &m_atomic_unit_max_merge);
+      if( m_atomic_unit_throughput ) {
+         assert( m_atomic_unit_queue_size > 0 && "L2 atomic unit needs a non-empty input queue" );
+         if( m_atomic_unit_max_merge == 0 )
+            m_atomic_unit_max_merge = 1;
+      }
+
       m_valid = true;
       icnt_flit_size = 32; // Default 32
    }
@@ -228,6 +245,7 @@ struct memory_config {
    unsigned gpgpu_dram_return_queue_size;
    enum dram_ctrl_t scheduler_type;
    bool gpgpu_memlatency_stat;
+   bool gpgpu_memlatency_breakdown;
    unsigned m_n_mem;
    unsigned m_n_sub_partition_per_memory_channel;
    unsigned m_n_mem_sub_partition;
@@ -236,6 +254,13 @@ struct memory_config {
    unsigned rop_latency;
    unsigned dram_latency;
 
+   // near-memory atomic/reduction unit in each memory sub partition
+   char *gpgpu_l2_atomic_unit_opt;
+   unsigned m_atomic_unit_throughput; // lane operations per cycle, 0 = disabled
+   unsigned m_atomic_unit_latency;    // read-modify-write pipeline depth
+   unsigned m_atomic_unit_queue_size;
+   unsigned m_atomic_unit_max_merge;  // reduction requests combined into one ALU operation
+
    // DRAM parameters
 
    unsigned tCCDL;  //column to column delay when bank groups are enabled
@@ -286,10 +311,15 @@ public:
         gpu_stat_sample_freq = 10000;
         gpu_runtime_stat_flag = 0;
         sscanf(gpgpu_runtime_stat, "%d:%x", &gpu_stat_sample_freq, &gpu_runtime_stat_flag);
+        gpgpu_functional_sim_config::init();
         m_shader_config.init();
         ptx_set_tex_cache_linesize(m_shader_config.m_L1T_config.get_line_sz());
         m_memory_config.init();
         init_clock_domains(); 
+        m_copy_engine_config.init(core_freq);
+        m_tlb_config.init();
+        m_dvfs_config.init();
+        m_kernel_dispatcher_config.init();
         power_config::init();
         Trace::init();
 
@@ -324,6 +354,10 @@ private:
     bool m_valid;
     shader_core_config m_shader_config;
     memory_config m_memory_config;
+    copy_engine_config m_copy_engine_config;
+    tlb_config m_tlb_config;
+    dvfs_config m_dvfs_config;
+    kernel_dispatcher_config m_kernel_dispatcher_config;
     // clock domains - frequency
     double core_freq;
     double icnt_freq;
@@ -377,6 +411,14 @@ public:
    unsigned finished_kernel();
    void set_kernel_done( kernel_info_t *kernel );
 
+   bool timed_memcpy() const { return m_config.m_copy_engine_config.enabled(); }
+   void launch_memcpy( struct CUstream_st *stream, enum copy_direction dir, 
+                       size_t dst, size_t src, size_t count, bool dma );
+   struct CUstream_st *finished_memcpy();
+   bool copy_engine_busy() const;
+
+   class gpu_mmu *get_mmu() const { return m_mmu; }
+
    void init();
    void cycle();
    bool active(); 
@@ -395,7 +437,12 @@ public:
 
    unsigned threads_per_core() const;
    bool get_more_cta_left() const;
-   kernel_info_t *select_kernel();
+   kernel_info_t *select_kernel( unsigned sid );
+   kernel_info_t *select_shared_kernel( class shader_core_ctx *core );
+   bool may_issue( unsigned sid, const kernel_info_t *kernel ) const;
+   bool shares_cores() const;
+   void cta_issued( const kernel_info_t *kernel, unsigned n_warps );
+   void cta_done( const kernel_info_t *kernel, unsigned n_warps );
 
    const gpgpu_sim_config &get_config() const { return m_config; }
    void gpu_print_stat();
@@ -430,6 +477,7 @@ private:
    void reinit_clock_domains(void);
    int  next_clock_domain(void);
    void issue_block2core();
+   void update_power_stats();
    void print_dram_stats(FILE *fout) const;
    void shader_print_runtime_stat( FILE *fout );
    void shader_print_l1_miss_stat( FILE *fout ) const;
@@ -445,9 +493,12 @@ private:
    class simt_core_cluster **m_cluster; // array of cluster* pointer
    class memory_partition_unit **m_memory_partition_unit;
    class memory_sub_partition **m_memory_sub_partition;
+   class copy_engine *m_copy_engine; // NULL unless -gpgpu_copy_engines > 0
+   class gpu_mmu *m_mmu; // shared L2 TLB and page table walkers, NULL unless -gpgpu_tlb
+   class dvfs_controller *m_dvfs; // per-cluster clock scaling, NULL unless -dvfs_governor
 
    std::vector<kernel_info_t*> m_running_kernels;
-   unsigned m_last_issued_kernel;
+   class kernel_dispatcher *m_kernel_dispatcher;
 
    std::list<unsigned> m_finished_kernel;
    unsigned m_last_cluster_issue;
@@ -479,11 +530,13 @@ private:
    unsigned long long  last_liveness_message_time; 
 
    std::map<std::string, FuncCache> m_special_cache_config;
+   unsigned m_l1d_carveout; // shared memory carveout of the unified L1D/shared SRAM in bytes
 
    std::vector<std::string> m_executed_kernel_names; //< names of kernel for stat printout 
    std::vector<unsigned> m_executed_kernel_uids; //< uids of kernel launches for stat printout
    std::string executed_kernel_info_string(); //< format the kernel information into a string for stat printout
    void clear_executed_kernel_info(); //< clear the kernel information after stat printout
+   void record_executed_kernel( kernel_info_t *kernel ); //< remember a kernel for stat printout
 public:
    //cjllean : add a func .2015.06.06 
    bool has_max_limit(){
@@ -504,6 +557,7 @@ public:
    bool has_special_cache_config(std::string kernel_name);
    void change_cache_config(FuncCache cache_config);
    void set_cache_config(std::string kernel_name);
+   void set_cache_config(const kernel_info_t &kernel);
 
 };
 
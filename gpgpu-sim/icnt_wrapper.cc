@@ -29,6 +29,7 @@
 #include <assert.h>
 #include "../intersim2/globals.hpp"
 #include "../intersim2/interconnect_interface.hpp"
+#include "local_interconnect.h"
 
 icnt_create_p                icnt_create;
 icnt_init_p                  icnt_init;
@@ -45,6 +46,9 @@ icnt_get_flit_size_p         icnt_get_flit_size;
 int   g_network_mode;
 char* g_network_config_filename;
 
+local_icnt_config g_local_icnt_config;
+static local_interconnect* g_local_icnt_interface;
+
 #include "../option_parser.h"
 
 // Wrapper to intersim2 to accompany old icnt_wrapper
@@ -105,10 +109,68 @@ static unsigned intersim2_get_flit_size()
    return g_icnt_interface->GetFlitSize();
 }
 
+// Wrapper to the built-in crossbar/ring (local_interconnect.h)
+
+static void local_icnt_create(unsigned int n_shader, unsigned int n_mem)
+{
+   g_local_icnt_interface->create(n_shader, n_mem);
+}
+
+static void local_icnt_init()
+{
+   g_local_icnt_interface->init();
+}
+
+static bool local_icnt_has_buffer(unsigned input, unsigned int size)
+{
+   return g_local_icnt_interface->has_buffer(input, size);
+}
+
+static void local_icnt_push(unsigned input, unsigned output, void* data, unsigned int size)
+{
+   g_local_icnt_interface->push(input, output, data, size);
+}
+
+static void* local_icnt_pop(unsigned output)
+{
+   return g_local_icnt_interface->pop(output);
+}
+
+static void local_icnt_transfer()
+{
+   g_local_icnt_interface->transfer();
+}
+
+static bool local_icnt_busy()
+{
+   return g_local_icnt_interface->busy();
+}
+
+static void local_icnt_display_stats()
+{
+   g_local_icnt_interface->display_stats();
+}
+
+static void local_icnt_display_overall_stats()
+{
+   g_local_icnt_interface->display_overall_stats();
+}
+
+static void local_icnt_display_state(FILE *fp)
+{
+   g_local_icnt_interface->display_state(fp);
+}
+
+static unsigned local_icnt_get_flit_size()
+{
+   return g_local_icnt_interface->get_flit_size();
+}
+
 void icnt_reg_options( class OptionParser * opp )
 {
-   option_parser_register(opp, "-network_mode", OPT_INT32, &g_network_mode, "Interconnection network mode", "1");
+   option_parser_register(opp, "-network_mode", OPT_INT32, &g_network_mode, "Interconnection network mode (1=intersim2, 2=built-in crossbar/ring)", "1");
    option_parser_register(opp, "-inter_config_file", OPT_CSTR, &g_network_config_filename, "Interconnection network config file", "mesh");
+   g_local_icnt_config.reg_options(opp);
 }
 
 void icnt_wrapper_init()
@@ -129,6 +191,20 @@ void icnt_wrapper_init()
          icnt_display_state = intersim2_display_state;
          icnt_get_flit_size = intersim2_get_flit_size;
          break;
+      case LOCAL_XBAR:
+         g_local_icnt_interface = new local_interconnect(g_local_icnt_config);
+         icnt_create     = local_icnt_create;
+         icnt_init       = local_icnt_init;
+         icnt_has_buffer = local_icnt_has_buffer;
+         icnt_push       = local_icnt_push;
+         icnt_pop        = local_icnt_pop;
+         icnt_transfer   = local_icnt_transfer;
+         icnt_busy       = local_icnt_busy;
+         icnt_display_stats = local_icnt_display_stats;
+         icnt_display_overall_stats = local_icnt_display_overall_stats;
+         icnt_display_state = local_icnt_display_state;
+         icnt_get_flit_size = local_icnt_get_flit_size;
+         break;
       default:
          assert(0);
          break;
@@ -0,0 +1,271 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "ifetch_prefetcher.h"
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "mem_fetch.h"
+#include "../option_parser.h"
+#include "../cuda-sim/ptx_ir.h"
+
+void ifetch_prefetcher_config::reg_options( class OptionParser *opp )
+{
+    option_parser_register(opp, "-gpgpu_iprefetch_policy", OPT_CSTR, &m_policy_string, 
+                   "L1 instruction cache prefetcher < none | next_line | branch_target | cta_stream >",
+                   "none");
+    option_parser_register(opp, "-gpgpu_iprefetch_degree", OPT_UINT32, &m_degree, 
+                   "number of lines the instruction prefetcher requests per trigger",
+                   "1");
+    option_parser_register(opp, "-gpgpu_iprefetch_distance", OPT_UINT32, &m_distance, 
+                   "number of lines the instruction prefetcher skips ahead of the demand line",
+                   "0");
+    option_parser_register(opp, "-gpgpu_iprefetch_filter_entries", OPT_UINT32, &m_filter_entries, 
+                   "entries in the per-core table of recently prefetched instruction lines (power of 2)",
+                   "64");
+}
+
+void ifetch_prefetcher_config::init()
+{
+    if( !strcmp(m_policy_string,"none") ) 
+        m_policy = IPREFETCH_NONE;
+    else if( !strcmp(m_policy_string,"next_line") ) 
+        m_policy = IPREFETCH_NEXT_LINE;
+    else if( !strcmp(m_policy_string,"branch_target") ) 
+        m_policy = IPREFETCH_BRANCH_TARGET;
+    else if( !strcmp(m_policy_string,"cta_stream") ) 
+        m_policy = IPREFETCH_CTA_STREAM;
+    else {
+        printf("GPGPU-Sim uArch: Error ** unknown instruction prefetch policy \"%s\"\n", m_policy_string);
+        abort();
+    }
+    if( m_policy != IPREFETCH_NONE && m_degree == 0 ) {
+        printf("GPGPU-Sim uArch: Error ** -gpgpu_iprefetch_degree must be at least 1\n");
+        abort();
+    }
+    if( m_filter_entries & (m_filter_entries-1) ) {
+        printf("GPGPU-Sim uArch: Error ** -gpgpu_iprefetch_filter_entries must be a power of 2\n");
+        abort();
+    }
+    m_valid = true;
+}
+
+void ifetch_prefetcher_stats::clear()
+{
+    m_demand = 0;
+    m_triggers = 0;
+    m_candidates = 0;
+    m_filtered = 0;
+    m_present = 0;
+    m_res_fail = 0;
+    m_issued = 0;
+    m_useful = 0;
+    m_late = 0;
+    m_polluted = 0;
+    m_useless = 0;
+}
+
+ifetch_prefetcher_stats &ifetch_prefetcher_stats::operator+=( const ifetch_prefetcher_stats &s )
+{
+    m_demand += s.m_demand;
+    m_triggers += s.m_triggers;
+    m_candidates += s.m_candidates;
+    m_filtered += s.m_filtered;
+    m_present += s.m_present;
+    m_res_fail += s.m_res_fail;
+    m_issued += s.m_issued;
+    m_useful += s.m_useful;
+    m_late += s.m_late;
+    m_polluted += s.m_polluted;
+    m_useless += s.m_useless;
+    return *this;
+}
+
+void ifetch_prefetcher_stats::print( FILE *fp, const char *name ) const
+{
+    fprintf(fp, "\t%s: demand = %llu, triggers = %llu, candidates = %llu, filtered = %llu, present = %llu, res_fail = %llu, issued = %llu\n",
+            name, m_demand, m_triggers, m_candidates, m_filtered, m_present, m_res_fail, m_issued);
+    fprintf(fp, "\t%s: useful = %llu, late = %llu, polluted = %llu, useless = %llu, accuracy = %.4lf, lateness = %.4lf\n",
+            name, m_useful, m_late, m_polluted, m_useless, 
+            m_issued? (double)m_useful/(double)m_issued : 0.0, 
+            m_useful? (double)m_late/(double)m_useful : 0.0);
+}
+
+ifetch_prefetcher::ifetch_prefetcher( const ifetch_prefetcher_config &config, unsigned line_sz, unsigned n_warps, unsigned n_ctas )
+    : m_config(config), m_line_sz(line_sz)
+{
+    assert( !(line_sz & (line_sz-1)) );
+    m_table.resize(config.m_filter_entries);
+    m_warp_line.resize(n_warps, (new_addr_type)-1);
+    m_cta_stream.resize(n_ctas, (new_addr_type)-1);
+}
+
+unsigned ifetch_prefetcher::hash( new_addr_type line_addr ) const
+{
+    new_addr_type line = line_addr / m_line_sz;
+    return (unsigned)(line ^ (line >> 7) ^ (line >> 13)) & (m_table.size()-1);
+}
+
+ifetch_prefetcher::entry_t *ifetch_prefetcher::lookup( new_addr_type line_addr )
+{
+    if( m_table.empty() ) 
+        return NULL;
+    entry_t &e = m_table[hash(line_addr)];
+    if( e.m_state != ENTRY_INVALID && e.m_line == line_addr ) 
+        return &e;
+    return NULL;
+}
+
+void ifetch_prefetcher::install( new_addr_type line_addr, enum entry_state state, bool unused, const mem_fetch *mf )
+{
+    if( m_table.empty() ) 
+        return;
+    entry_t &e = m_table[hash(line_addr)];
+    if( e.m_state == ENTRY_FILLED && e.m_unused ) 
+        m_stats.m_useless++;
+    e.m_line = line_addr;
+    e.m_state = state;
+    e.m_unused = unused;
+    e.m_mf = mf;
+}
+
+void ifetch_prefetcher::demand_access( unsigned warp_id, unsigned cta_id, address_type pc, new_addr_type line_addr, 
+                                       enum cache_request_status status, std::vector<new_addr_type> &candidates )
+{
+    m_stats.m_demand++;
+    entry_t *e = lookup(line_addr);
+    if( e && e->m_unused ) {
+        if( e->m_state == ENTRY_IN_FLIGHT ) {
+            // merged into the prefetch MSHR entry
+            m_stats.m_useful++;
+            m_stats.m_late++;
+            e->m_unused = false;
+        } else if( status == HIT ) {
+            m_stats.m_useful++;
+            e->m_unused = false;
+        } else if( status == MISS ) {
+            m_stats.m_polluted++;
+            e->m_state = ENTRY_INVALID;
+        }
+    }
+
+    candidates.clear();
+    if( !m_config.enabled() || status == RESERVATION_FAIL || m_warp_line[warp_id] == line_addr ) 
+        return;
+    m_warp_line[warp_id] = line_addr;
+    m_stats.m_triggers++;
+
+    switch( m_config.m_policy ) {
+    case IPREFETCH_NEXT_LINE:     next_lines(line_addr, m_config.m_distance+1, m_config.m_degree, candidates); break;
+    case IPREFETCH_BRANCH_TARGET: branch_targets(pc, line_addr, candidates); break;
+    case IPREFETCH_CTA_STREAM:    cta_stream(cta_id, line_addr, candidates); break;
+    default: abort();
+    }
+    m_stats.m_candidates += candidates.size();
+}
+
+bool ifetch_prefetcher::filter( new_addr_type line_addr )
+{
+    if( m_table.empty() ) 
+        return false;
+    const entry_t &e = m_table[hash(line_addr)];
+    // in-flight entries are never replaced so that fill() can recognize them
+    if( (e.m_state != ENTRY_INVALID && e.m_line == line_addr) || e.m_state == ENTRY_IN_FLIGHT ) {
+        m_stats.m_filtered++;
+        return true;
+    }
+    return false;
+}
+
+void ifetch_prefetcher::issued( new_addr_type line_addr, const mem_fetch *mf, enum cache_request_status status )
+{
+    switch( status ) {
+    case MISS: 
+        m_stats.m_issued++; 
+        install(line_addr, ENTRY_IN_FLIGHT, true, mf);
+        break;
+    case HIT: 
+        // remember the line so it is not probed again while it is hot
+        m_stats.m_present++; 
+        install(line_addr, ENTRY_FILLED, false, NULL);
+        break;
+    default: 
+        m_stats.m_res_fail++; 
+        break;
+    }
+}
+
+bool ifetch_prefetcher::fill( const mem_fetch *mf )
+{
+    entry_t *e = lookup(mf->get_addr());
+    if( !e || e->m_state != ENTRY_IN_FLIGHT || e->m_mf != mf ) 
+        return false;
+    e->m_state = ENTRY_FILLED;
+    e->m_mf = NULL;
+    return true;
+}
+
+void ifetch_prefetcher::next_lines( new_addr_type line_addr, unsigned first, unsigned n, std::vector<new_addr_type> &candidates ) const
+{
+    for( unsigned r=0; r < n; r++ ) 
+        candidates.push_back(line_addr + (first+r)*m_line_sz);
+}
+
+// next line plus the lines holding the targets of the branches in this line,
+// up to <degree> lines in total
+void ifetch_prefetcher::branch_targets( address_type pc, new_addr_type line_addr, std::vector<new_addr_type> &candidates ) const
+{
+    next_lines(line_addr, m_config.m_distance+1, 1, candidates);
+    address_type line_pc = line_addr - PROGRAM_MEM_START;
+    for( address_type p = line_pc; p < line_pc + m_line_sz && candidates.size() < m_config.m_degree; p++ ) {
+        const ptx_instruction *pI = function_info::pc_to_instruction(p);
+        if( !pI || pI->get_opcode() != BRA_OP || !pI->dst().is_label() ) 
+            continue;
+        new_addr_type target = (pI->dst().get_symbol()->get_address() + PROGRAM_MEM_START) & ~(new_addr_type)(m_line_sz-1);
+        if( target == line_addr ) 
+            continue;
+        if( std::find(candidates.begin(), candidates.end(), target) == candidates.end() ) 
+            candidates.push_back(target);
+    }
+}
+
+// all warps of a CTA run the same code, so they share one stream: lagging
+// warps only extend it, and a warp that jumps outside of it restarts it
+void ifetch_prefetcher::cta_stream( unsigned cta_id, new_addr_type line_addr, std::vector<new_addr_type> &candidates )
+{
+    new_addr_type &head = m_cta_stream[cta_id % m_cta_stream.size()];
+    new_addr_type window = (m_config.m_distance + m_config.m_degree) * m_line_sz;
+    if( head == (new_addr_type)-1 || line_addr > head || line_addr + window < head ) 
+        head = line_addr + m_config.m_distance*m_line_sz;
+    new_addr_type last = line_addr + window;
+    for( new_addr_type l = head + m_line_sz; l <= last; l += m_line_sz ) 
+        candidates.push_back(l);
+    if( last > head ) 
+        head = last;
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef IFETCH_PREFETCHER_H
+#define IFETCH_PREFETCHER_H
+
+#include <stdio.h>
+#include <vector>
+#include "../abstract_hardware_model.h"
+#include "gpu-cache.h"
+
+#define PROGRAM_MEM_START 0xF0000000 /* should be distinct from other memory spaces... 
+                                        check ptx_ir.h to verify this does not overlap 
+                                        other memory spaces */
+
+// Per-core L1 instruction cache prefetcher. 
+//
+// fetch() reports every demand access of a warp; when a warp moves to a new
+// cache line the selected policy proposes candidate lines, which are looked
+// up in a small hashed table of recently prefetched lines before they are
+// sent to the L1I. The same table tracks the prefetches that are in flight
+// or filled but not yet used, giving accuracy, lateness and pollution stats.
+
+enum ifetch_prefetch_policy {
+   IPREFETCH_NONE = 0,
+   IPREFETCH_NEXT_LINE,     // next <degree> lines after <distance> lines
+   IPREFETCH_BRANCH_TARGET, // next line plus the targets of the branches in the line (PTX CFG)
+   IPREFETCH_CTA_STREAM     // next-N-line stream shared by all warps of a CTA
+};
+
+struct ifetch_prefetcher_config {
+   ifetch_prefetcher_config() { m_valid = false; }
+   void reg_options( class OptionParser *opp );
+   void init();
+   bool enabled() const { assert(m_valid); return m_policy != IPREFETCH_NONE; }
+
+   char *m_policy_string;
+   enum ifetch_prefetch_policy m_policy;
+   unsigned m_degree;         // lines requested per trigger
+   unsigned m_distance;       // lines skipped before the first prefetched line
+   unsigned m_filter_entries; // entries in the recently-prefetched table (power of 2)
+   bool m_valid;
+};
+
+struct ifetch_prefetcher_stats {
+   ifetch_prefetcher_stats() { clear(); }
+   void clear();
+   ifetch_prefetcher_stats &operator+=( const ifetch_prefetcher_stats &s );
+   void print( FILE *fp, const char *name ) const;
+
+   unsigned long long m_demand;     // demand fetches seen
+   unsigned long long m_triggers;   // demand fetches that moved a warp to a new line
+   unsigned long long m_candidates; // lines proposed by the policy
+   unsigned long long m_filtered;   // dropped by the recently-prefetched table
+   unsigned long long m_present;    // line was already in the L1I
+   unsigned long long m_res_fail;   // L1I could not accept the prefetch
+   unsigned long long m_issued;     // prefetches sent to the memory system
+   unsigned long long m_useful;     // prefetched lines hit by a demand fetch (includes late)
+   unsigned long long m_late;       // demand fetch arrived while the prefetch was in flight
+   unsigned long long m_polluted;   // prefetched line evicted before a demand fetch used it
+   unsigned long long m_useless;    // prefetched line dropped from the table without being used
+};
+
+class ifetch_prefetcher {
+public:
+   ifetch_prefetcher( const ifetch_prefetcher_config &config, unsigned line_sz, unsigned n_warps, unsigned n_ctas );
+
+   // account a demand fetch and, if it moved the warp to a new line, return the lines to prefetch
+   void demand_access( unsigned warp_id, unsigned cta_id, address_type pc, new_addr_type line_addr, 
+                       enum cache_request_status status, std::vector<new_addr_type> &candidates );
+   // true if the line was prefetched recently (or is in flight) and should not be sent again
+   bool filter( new_addr_type line_addr );
+   // outcome of the L1I access of a prefetch candidate
+   void issued( new_addr_type line_addr, const class mem_fetch *mf, enum cache_request_status status );
+   // a fill returned to the L1I; true if it belongs to a prefetch issued by this prefetcher
+   bool fill( const class mem_fetch *mf );
+
+   const ifetch_prefetcher_stats &get_stats() const { return m_stats; }
+
+private:
+   enum entry_state { ENTRY_INVALID = 0, ENTRY_IN_FLIGHT, ENTRY_FILLED };
+   struct entry_t {
+      entry_t() : m_line(0), m_state(ENTRY_INVALID), m_unused(false), m_mf(NULL) {}
+      new_addr_type m_line;
+      enum entry_state m_state;
+      bool m_unused;            // prefetched by us and not touched by a demand fetch yet
+      const class mem_fetch *m_mf;
+   };
+
+   unsigned hash( new_addr_type line_addr ) const;
+   entry_t *lookup( new_addr_type line_addr );
+   void install( new_addr_type line_addr, enum entry_state state, bool unused, const class mem_fetch *mf );
+
+   void next_lines( new_addr_type line_addr, unsigned first, unsigned n, std::vector<new_addr_type> &candidates ) const;
+   void branch_targets( address_type pc, new_addr_type line_addr, std::vector<new_addr_type> &candidates ) const;
+   void cta_stream( unsigned cta_id, new_addr_type line_addr, std::vector<new_addr_type> &candidates );
+
+   const ifetch_prefetcher_config &m_config;
+   unsigned m_line_sz;
+   std::vector<entry_t> m_table;
+   std::vector<new_addr_type> m_warp_line;   // last line fetched by each warp
+   std::vector<new_addr_type> m_cta_stream;  // furthest line requested for each CTA
+
+   ifetch_prefetcher_stats m_stats;
+};
+
+#endif
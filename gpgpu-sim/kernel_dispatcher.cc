@@ -0,0 +1,321 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+
+#include "kernel_dispatcher.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../option_parser.h"
+#include "../abstract_hardware_model.h"
+#include "gpu-sim.h"
+#include "shader.h"
+
+void kernel_dispatcher_config::reg_options( class OptionParser * opp )
+{
+   option_parser_register(opp, "-gpgpu_concurrent_kernel_sched", OPT_CSTR, &m_policy_string,
+                          "CTA dispatch policy for concurrent kernels <rr|leftover|spatial|priority|intra_sm>", "rr");
+   option_parser_register(opp, "-gpgpu_stream_priority", OPT_CSTR, &m_stream_priority_string,
+                          "Priority of kernels launched from a stream, lower value = higher priority "
+                          "{<stream uid>:<priority>,...} (unlisted streams have priority 0)", "");
+}
+
+void kernel_dispatcher_config::init()
+{
+   if( !strcmp(m_policy_string,"rr") ) 
+      m_policy = CKE_ROUND_ROBIN;
+   else if( !strcmp(m_policy_string,"leftover") ) 
+      m_policy = CKE_LEFTOVER;
+   else if( !strcmp(m_policy_string,"spatial") ) 
+      m_policy = CKE_SPATIAL;
+   else if( !strcmp(m_policy_string,"priority") ) 
+      m_policy = CKE_PRIORITY;
+   else if( !strcmp(m_policy_string,"intra_sm") ) 
+      m_policy = CKE_INTRA_SM;
+   else {
+      printf("GPGPU-Sim uArch: Error ** unknown concurrent kernel scheduling policy \"%s\"\n", m_policy_string);
+      abort();
+   }
+
+   m_stream_priority.clear();
+   const char *s = m_stream_priority_string;
+   while( s && *s ) {
+      unsigned uid;
+      int prio;
+      if( sscanf(s, "%u:%d", &uid, &prio) != 2 ) {
+         printf("GPGPU-Sim uArch: Error ** malformed -gpgpu_stream_priority \"%s\"\n", m_stream_priority_string);
+         abort();
+      }
+      m_stream_priority[uid] = prio;
+      s = strchr(s, ',');
+      if( s ) s++;
+   }
+}
+
+int kernel_dispatcher_config::stream_priority( unsigned stream_uid ) const
+{
+   std::map<unsigned,int>::const_iterator i = m_stream_priority.find(stream_uid);
+   return (i == m_stream_priority.end())? 0 : i->second;
+}
+
+kernel_dispatcher::kernel_dispatcher( const kernel_dispatcher_config &config, 
+                                      const shader_core_config *shader_config,
+                                      std::vector<kernel_info_t*> &running_kernels )
+   : m_config(config), m_running_kernels(running_kernels)
+{
+   m_shader_config = shader_config;
+   m_last_issued_kernel = 0;
+}
+
+bool kernel_dispatcher::has_ctas( unsigned slot ) const
+{
+   return m_running_kernels[slot] && !m_running_kernels[slot]->no_more_ctas_to_run();
+}
+
+int kernel_dispatcher::priority( unsigned slot ) const
+{
+   return m_config.stream_priority(m_running_kernels[slot]->get_stream_uid());
+}
+
+unsigned kernel_dispatcher::n_issuing() const
+{
+   unsigned n = 0;
+   for( unsigned k=0; k < m_running_kernels.size(); k++ ) 
+      if( has_ctas(k) ) 
+         n++;
+   return n;
+}
+
+kernel_info_t *kernel_dispatcher::pick( unsigned slot )
+{
+   m_last_issued_kernel = slot;
+   return m_running_kernels[slot];
+}
+
+bool kernel_dispatcher::in_partition( unsigned sid, const kernel_info_t *kernel ) const
+{
+   // kernels with CTAs left, in launch order, each own a contiguous range of cores
+   unsigned n = n_issuing();
+   if( n == 0 ) 
+      return false;
+   unsigned rank = 0;
+   bool found = false;
+   for( unsigned k=0; k < m_running_kernels.size(); k++ ) {
+      if( !has_ctas(k) ) 
+         continue;
+      if( m_running_kernels[k] == kernel ) 
+         found = true;
+      else if( m_running_kernels[k]->get_uid() < kernel->get_uid() ) 
+         rank++;
+   }
+   if( !found ) 
+      return false;
+   return (unsigned long long)sid * n / m_shader_config->num_shader() == rank;
+}
+
+bool kernel_dispatcher::may_issue( unsigned sid, const kernel_info_t *kernel ) const
+{
+   switch( m_config.m_policy ) {
+   case CKE_SPATIAL:
+      return in_partition(sid, kernel);
+   case CKE_PRIORITY: {
+      int prio = m_config.stream_priority(kernel->get_stream_uid());
+      for( unsigned k=0; k < m_running_kernels.size(); k++ ) 
+         if( has_ctas(k) && priority(k) < prio ) 
+            return false;
+      return true;
+   }
+   default:
+      return true;
+   }
+}
+
+kernel_info_t *kernel_dispatcher::select_kernel( unsigned sid )
+{
+   unsigned n_slots = m_running_kernels.size();
+   switch( m_config.m_policy ) {
+   case CKE_LEFTOVER: {
+      int oldest = -1;
+      for( unsigned k=0; k < n_slots; k++ ) 
+         if( has_ctas(k) && (oldest < 0 || m_running_kernels[k]->get_uid() < m_running_kernels[oldest]->get_uid()) ) 
+            oldest = k;
+      return (oldest < 0)? NULL : pick(oldest);
+   }
+   case CKE_PRIORITY: {
+      int best = -1;
+      for( unsigned n=0; n < n_slots; n++ ) {
+         unsigned k = (n + m_last_issued_kernel + 1) % n_slots;
+         if( has_ctas(k) && (best < 0 || priority(k) < priority(best)) ) 
+            best = k;
+      }
+      return (best < 0)? NULL : pick(best);
+   }
+   case CKE_SPATIAL:
+      for( unsigned k=0; k < n_slots; k++ ) 
+         if( has_ctas(k) && in_partition(sid, m_running_kernels[k]) ) 
+            return pick(k);
+      return NULL;
+   default:
+      for( unsigned n=0; n < n_slots; n++ ) {
+         unsigned k = (n + m_last_issued_kernel + 1) % n_slots;
+         if( has_ctas(k) ) 
+            return pick(k);
+      }
+      return NULL;
+   }
+}
+
+kernel_info_t *kernel_dispatcher::select_shared_kernel( shader_core_ctx *core )
+{
+   unsigned n_slots = m_running_kernels.size();
+   unsigned n_sharing = n_issuing();
+   for( unsigned n=0; n < n_slots; n++ ) {
+      unsigned k = (n + m_last_issued_kernel + 1) % n_slots;
+      if( has_ctas(k) && core->can_issue_shared_cta(*m_running_kernels[k], n_sharing) ) 
+         return pick(k);
+   }
+   return NULL;
+}
+
+void kernel_dispatcher::launch( kernel_info_t *kernel )
+{
+   kernel_stats &ks = m_kernel_stats[kernel->get_uid()];
+   ks.name = kernel->name();
+   ks.stream_uid = kernel->get_stream_uid();
+   ks.priority = m_config.stream_priority(ks.stream_uid);
+   ks.launch_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+   ks.end_cycle = 0;
+   ks.finished = false;
+   ks.n_ctas = 0;
+   ks.resident_warps = 0;
+   ks.warp_cycles = 0;
+   ks.last_change = ks.launch_cycle;
+   ks.last_insn = 0;
+   ks.alone_cycles = 0;
+   ks.alone_insn = 0;
+   ks.shared_cycles = 0;
+   ks.shared_insn = 0;
+}
+
+void kernel_dispatcher::update_occupancy( kernel_stats &ks )
+{
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+   ks.warp_cycles += (unsigned long long)ks.resident_warps * (now - ks.last_change);
+   ks.last_change = now;
+}
+
+void kernel_dispatcher::kernel_done( kernel_info_t *kernel )
+{
+   std::map<unsigned,kernel_stats>::iterator i = m_kernel_stats.find(kernel->get_uid());
+   assert( i != m_kernel_stats.end() );
+   kernel_stats &ks = i->second;
+   update_occupancy(ks);
+   ks.end_cycle = gpu_sim_cycle + gpu_tot_sim_cycle;
+   ks.finished = true;
+}
+
+void kernel_dispatcher::cta_issued( const kernel_info_t *kernel, unsigned n_warps )
+{
+   std::map<unsigned,kernel_stats>::iterator i = m_kernel_stats.find(kernel->get_uid());
+   assert( i != m_kernel_stats.end() );
+   kernel_stats &ks = i->second;
+   update_occupancy(ks);
+   ks.resident_warps += n_warps;
+   ks.n_ctas++;
+}
+
+void kernel_dispatcher::cta_done( const kernel_info_t *kernel, unsigned n_warps )
+{
+   std::map<unsigned,kernel_stats>::iterator i = m_kernel_stats.find(kernel->get_uid());
+   assert( i != m_kernel_stats.end() );
+   kernel_stats &ks = i->second;
+   update_occupancy(ks);
+   assert( ks.resident_warps >= n_warps );
+   ks.resident_warps -= n_warps;
+}
+
+void kernel_dispatcher::cycle()
+{
+   // split every running kernel's cycles and instructions into the phases 
+   // where it had the GPU to itself and where it shared it with others
+   unsigned n_running = 0;
+   for( unsigned k=0; k < m_running_kernels.size(); k++ ) 
+      if( m_running_kernels[k] ) 
+         n_running++;
+   for( unsigned k=0; k < m_running_kernels.size(); k++ ) {
+      kernel_info_t *kernel = m_running_kernels[k];
+      if( !kernel ) 
+         continue;
+      std::map<unsigned,kernel_stats>::iterator i = m_kernel_stats.find(kernel->get_uid());
+      if( i == m_kernel_stats.end() ) 
+         continue;
+      kernel_stats &ks = i->second;
+      unsigned long long insn = kernel->get_sim_insn();
+      if( n_running == 1 ) {
+         ks.alone_cycles++;
+         ks.alone_insn += insn - ks.last_insn;
+      } else {
+         ks.shared_cycles++;
+         ks.shared_insn += insn - ks.last_insn;
+      }
+      ks.last_insn = insn;
+   }
+}
+
+void kernel_dispatcher::print_stats( FILE *fout )
+{
+   // statistics of kernels that finished are printed once and then dropped
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+   unsigned max_warps = m_shader_config->max_warps_per_shader * m_shader_config->num_shader();
+   fprintf(fout, "concurrent_kernel_sched = %s\n", m_config.m_policy_string);
+   std::map<unsigned,kernel_stats>::iterator i;
+   for( i=m_kernel_stats.begin(); i != m_kernel_stats.end(); ) {
+      kernel_stats &ks = i->second;
+      if( !ks.finished ) 
+         update_occupancy(ks);
+      unsigned long long end = ks.finished? ks.end_cycle : now;
+      unsigned long long cycles = end - ks.launch_cycle;
+      unsigned long long insn = ks.alone_insn + ks.shared_insn;
+      double alone_ipc = ks.alone_cycles? (double)ks.alone_insn / ks.alone_cycles : 0.0;
+      double shared_ipc = ks.shared_cycles? (double)ks.shared_insn / ks.shared_cycles : 0.0;
+      fprintf(fout, "kernel_stats[%u] \'%s\': stream = %u, priority = %d, %s, ctas = %u, cycles = %llu, insn = %llu, ipc = %.4f, occupancy = %.4f",
+              i->first, ks.name.c_str(), ks.stream_uid, ks.priority, ks.finished? "done" : "running",
+              ks.n_ctas, cycles, insn, cycles? (double)insn / cycles : 0.0,
+              (cycles && max_warps)? (double)ks.warp_cycles / ((double)cycles * max_warps) : 0.0);
+      fprintf(fout, ", alone_cycles = %llu, shared_cycles = %llu", ks.alone_cycles, ks.shared_cycles);
+      // slowdown is estimated from the IPC the kernel reached while it ran alone
+      if( alone_ipc > 0 && shared_ipc > 0 ) 
+         fprintf(fout, ", slowdown = %.3f\n", alone_ipc / shared_ipc);
+      else 
+         fprintf(fout, ", slowdown = n/a\n");
+      if( ks.finished ) 
+         m_kernel_stats.erase(i++);
+      else 
+         i++;
+   }
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef KERNEL_DISPATCHER_H
+#define KERNEL_DISPATCHER_H
+
+#include <stdio.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class kernel_info_t;
+class shader_core_ctx;
+struct shader_core_config;
+
+// Concurrent kernel CTA dispatcher (-gpgpu_concurrent_kernel_sched).
+//
+// Decides which of the kernels in gpgpu_sim::m_running_kernels a shader 
+// core takes its next CTA from:
+//   rr       - a free core binds to the next kernel round-robin (default)
+//   leftover - a free core binds to the oldest kernel with CTAs left, later 
+//              kernels only get the cores the earlier ones do not need
+//   spatial  - the cores are split into contiguous partitions, one per kernel 
+//              with CTAs left; a core drains before it switches partition
+//   priority - kernels from higher priority streams (lower value, see 
+//              -gpgpu_stream_priority) take every core that becomes free
+//   intra_sm - cores are shared: CTAs of different kernels are co-resident 
+//              and each kernel gets an equal quota of the threads, registers, 
+//              shared memory and CTA slots of every core
+// It also keeps per-kernel occupancy, IPC and slowdown statistics.
+
+enum concurrent_kernel_policy {
+   CKE_ROUND_ROBIN = 0,
+   CKE_LEFTOVER,
+   CKE_SPATIAL,
+   CKE_PRIORITY,
+   CKE_INTRA_SM
+};
+
+struct kernel_dispatcher_config {
+   void reg_options( class OptionParser * opp );
+   void init();
+   int stream_priority( unsigned stream_uid ) const;
+
+   char *m_policy_string;
+   enum concurrent_kernel_policy m_policy;
+   char *m_stream_priority_string;
+   std::map<unsigned,int> m_stream_priority; // stream uid -> priority
+};
+
+class kernel_dispatcher {
+public:
+   kernel_dispatcher( const kernel_dispatcher_config &config, 
+                      const shader_core_config *shader_config,
+                      std::vector<kernel_info_t*> &running_kernels );
+
+   bool shares_cores() const { return m_config.m_policy == CKE_INTRA_SM; }
+
+   // exclusive policies: kernel a free core binds to, and whether a bound 
+   // core may keep issuing CTAs of its kernel
+   kernel_info_t *select_kernel( unsigned sid );
+   bool may_issue( unsigned sid, const kernel_info_t *kernel ) const;
+   // intra_sm: kernel the core can host one more CTA of (within its quota)
+   kernel_info_t *select_shared_kernel( shader_core_ctx *core );
+
+   void launch( kernel_info_t *kernel );
+   void kernel_done( kernel_info_t *kernel );
+   void cta_issued( const kernel_info_t *kernel, unsigned n_warps );
+   void cta_done( const kernel_info_t *kernel, unsigned n_warps );
+   void cycle();
+   void print_stats( FILE *fout );
+
+private:
+   struct kernel_stats {
+      std::string name;
+      unsigned stream_uid;
+      int priority;
+      unsigned long long launch_cycle;
+      unsigned long long end_cycle;
+      bool finished;
+      unsigned n_ctas;
+      unsigned resident_warps;
+      unsigned long long warp_cycles;   // integral of resident warps over time
+      unsigned long long last_change;
+      unsigned long long last_insn;
+      unsigned long long alone_cycles;  // cycles as the only running kernel
+      unsigned long long alone_insn;
+      unsigned long long shared_cycles; // cycles co-running with other kernels
+      unsigned long long shared_insn;
+   };
+
+   bool has_ctas( unsigned slot ) const;
+   int priority( unsigned slot ) const;
+   unsigned n_issuing() const;
+   bool in_partition( unsigned sid, const kernel_info_t *kernel ) const;
+   kernel_info_t *pick( unsigned slot );
+   void update_occupancy( kernel_stats &ks );
+
+   const kernel_dispatcher_config &m_config;
+   const shader_core_config *m_shader_config;
+   std::vector<kernel_info_t*> &m_running_kernels;
+   unsigned m_last_issued_kernel;
+
+   std::map<unsigned,kernel_stats> m_kernel_stats; // indexed by kernel uid
+};
+
+#endif
@@ -31,6 +31,8 @@
 
 #include <list>
 #include <set>
+#include <map>
+#include <algorithm>
 
 #include "../option_parser.h"
 #include "mem_fetch.h"
@@ -320,6 +322,7 @@ memory_sub_partition::memory_sub_partition( unsigned sub_partition_id,
     m_dram_L2_queue = new fifo_pipeline<mem_fetch>("dram-to-L2",0,dram_L2);
     m_L2_icnt_queue = new fifo_pipeline<mem_fetch>("L2-to-icnt",0,L2_icnt);
     wb_addr=-1;
+    m_atomic_issue_cycle=0;
 }
 
 memory_sub_partition::~memory_sub_partition()
@@ -332,16 +335,146 @@ memory_sub_partition::~memory_sub_partition()
     delete m_L2interface;
 }
 
+bool memory_sub_partition::atomic_unit_enabled() const
+{
+    return m_config->m_atomic_unit_throughput > 0;
+}
+
+bool memory_sub_partition::reply_queue_full( const mem_fetch *mf ) const
+{
+    // mf == NULL: the next reply is not known yet, so both paths must have room
+    bool atomic_full = atomic_unit_enabled() && m_atomic_queue.size() >= m_config->m_atomic_unit_queue_size;
+    if( mf && atomic_unit_enabled() && mf->isatomic() )
+        return atomic_full;
+    if( mf )
+        return m_L2_icnt_queue->full();
+    return m_L2_icnt_queue->full() || atomic_full;
+}
+
+void memory_sub_partition::push_reply( mem_fetch *mf )
+{
+    if( atomic_unit_enabled() && mf->isatomic() ) {
+        mf->set_status(IN_PARTITION_ATOMIC_UNIT,gpu_sim_cycle+gpu_tot_sim_cycle);
+        m_atomic_queue.push_back(mf);
+    } else {
+        mf->set_status(IN_PARTITION_L2_TO_ICNT_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle);
+        m_L2_icnt_queue->push(mf);
+    }
+}
+
+void memory_sub_partition::atomic_unit_cycle( unsigned long long cycle )
+{
+    // completed read-modify-writes -> L2-icnt Q
+    while( !m_atomic_pipe.empty() && m_atomic_pipe.front().ready_cycle <= cycle && !m_L2_icnt_queue->full() ) {
+        atomic_op_t &op = m_atomic_pipe.front();
+        mem_fetch *mf = op.reqs.front();
+        op.reqs.pop_front();
+        mf->set_status(IN_PARTITION_L2_TO_ICNT_QUEUE,cycle);
+        m_L2_icnt_queue->push(mf);
+        if( op.reqs.empty() )
+            m_atomic_pipe.pop_front();
+    }
+    if( m_atomic_pipe.empty() )
+        m_atomic_word_busy.clear(); // every tracked update has completed
+
+    if( m_atomic_queue.empty() || cycle < m_atomic_issue_cycle )
+        return;
+
+    // reductions from the same instruction to the same line that arrive back
+    // to back (typically released together by one L2 MSHR fill) are combined
+    // into a single ALU operation
+    mem_fetch *mf = m_atomic_queue.front();
+    const bool reduction = mf->get_inst().is_reduction;
+    atomic_op_t op;
+    op.reqs.push_back(mf);
+    if( reduction ) {
+        std::list<mem_fetch*>::iterator i = m_atomic_queue.begin();
+        for( ++i; i != m_atomic_queue.end() && op.reqs.size() < m_config->m_atomic_unit_max_merge; ++i ) {
+            mem_fetch *next = *i;
+            if( !next->get_inst().is_reduction || next->get_pc() != mf->get_pc() || next->get_addr() != mf->get_addr() )
+                break;
+            op.reqs.push_back(next);
+        }
+    }
+
+    // per-word lane counts
+    std::map<new_addr_type,unsigned> lanes_per_word;
+    unsigned lanes = 0;
+    for( std::list<mem_fetch*>::iterator r = op.reqs.begin(); r != op.reqs.end(); ++r ) {
+        const warp_inst_t &inst = (*r)->get_inst();
+        const active_mask_t &mask = (*r)->get_access_warp_mask();
+        for( unsigned t = 0; t < mask.size(); t++ ) {
+            if( mask.test(t) ) {
+                lanes_per_word[inst.get_addr(t)]++;
+                lanes++;
+            }
+        }
+    }
+
+    // an earlier update to one of the words still in the pipeline: wait for it
+    for( std::map<new_addr_type,unsigned>::iterator w = lanes_per_word.begin(); w != lanes_per_word.end(); ++w ) {
+        std::map<new_addr_type,unsigned long long>::iterator b = m_atomic_word_busy.find(w->first);
+        if( b != m_atomic_word_busy.end() && b->second > cycle ) {
+            m_atomic_stats.addr_stall_cycles++;
+            return;
+        }
+    }
+
+    // atomics return the old value, so lanes hitting the same word serialize;
+    // reductions to the same word are combined before the read-modify-write
+    const unsigned tput = m_config->m_atomic_unit_throughput;
+    unsigned slots = reduction ? lanes_per_word.size() : lanes;
+    unsigned cost = (slots + tput - 1) / tput;
+    if( !reduction ) {
+        unsigned max_same = 0;
+        for( std::map<new_addr_type,unsigned>::iterator w = lanes_per_word.begin(); w != lanes_per_word.end(); ++w )
+            max_same = std::max(max_same, w->second);
+        if( max_same > cost ) {
+            m_atomic_stats.serialized_cycles += max_same - cost;
+            cost = max_same;
+        }
+    }
+    cost = std::max(cost, 1U);
+
+    op.ready_cycle = cycle + cost + m_config->m_atomic_unit_latency;
+    m_atomic_issue_cycle = cycle + cost;
+    for( std::map<new_addr_type,unsigned>::iterator w = lanes_per_word.begin(); w != lanes_per_word.end(); ++w )
+        m_atomic_word_busy[w->first] = op.ready_cycle;
+
+    m_atomic_stats.requests += op.reqs.size();
+    m_atomic_stats.merged_reductions += op.reqs.size() - 1;
+    m_atomic_stats.lane_ops += lanes;
+    m_atomic_stats.alu_ops += slots;
+    m_atomic_stats.busy_cycles += cost;
+    for( unsigned n = 0; n < op.reqs.size(); n++ )
+        m_atomic_queue.pop_front();
+    m_atomic_pipe.push_back(op);
+}
+
+void atomic_unit_stats::print( FILE *fp, const char *name ) const
+{
+    fprintf(fp, "%s_requests = %llu\n", name, requests);
+    fprintf(fp, "%s_lane_ops = %llu\n", name, lane_ops);
+    fprintf(fp, "%s_alu_ops = %llu\n", name, alu_ops);
+    fprintf(fp, "%s_merged_reductions = %llu\n", name, merged_reductions);
+    fprintf(fp, "%s_busy_cycles = %llu\n", name, busy_cycles);
+    fprintf(fp, "%s_serialized_cycles = %llu\n", name, serialized_cycles);
+    fprintf(fp, "%s_addr_stall_cycles = %llu\n", name, addr_stall_cycles);
+}
+
 void memory_sub_partition::cache_cycle( unsigned cycle )
 {
+    // atomic unit -> responses Queue
+    if( atomic_unit_enabled() )
+       atomic_unit_cycle(cycle);
+
     // L2 -> responses Queue
     if( !m_config->m_L2_config.disabled()) {
-       if ( m_L2cache->access_ready() && !m_L2_icnt_queue->full() ) {//-L2 has back mf && queqe not all full.
+       if ( m_L2cache->access_ready() && !reply_queue_full(NULL) ) {//-L2 has back mf && queqe not all full.
            mem_fetch *mf = m_L2cache->next_access();
            if(mf->get_access_type() != L2_WR_ALLOC_R){ // Don't pass write allocate read request back to upper level cache
 				mf->set_reply();
-				mf->set_status(IN_PARTITION_L2_TO_ICNT_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle);
-				m_L2_icnt_queue->push(mf);//-move to L2-icnt Q
+				push_reply(mf);//-move to L2-icnt Q (atomics via the atomic unit)
            }else{
 				m_request_tracker.erase(mf);
 				delete mf;
@@ -358,9 +491,8 @@ void memory_sub_partition::cache_cycle( unsigned cycle )
                 m_L2cache->fill(mf,gpu_sim_cycle+gpu_tot_sim_cycle);//-move to L2
                 m_dram_L2_queue->pop();
             }
-        } else if ( !m_L2_icnt_queue->full() ) {
-            mf->set_status(IN_PARTITION_L2_TO_ICNT_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle);
-            m_L2_icnt_queue->push(mf);//-move to L2-icnt Q, if possible. 
+        } else if ( !reply_queue_full(mf) ) {
+            push_reply(mf);//-move to L2-icnt Q, if possible. 
             m_dram_L2_queue->pop();
         }
     }
@@ -376,7 +508,7 @@ void memory_sub_partition::cache_cycle( unsigned cycle )
               ( (m_config->m_L2_texure_only && mf->istexture()) || (!m_config->m_L2_texure_only) )
            ) {
             // L2 is enabled and access is for L2   ,// access L2,return Miss/Hit/Reservation
-            bool output_full = m_L2_icnt_queue->full(); 
+            bool output_full = reply_queue_full(mf); 
             bool port_free = m_L2cache->data_port_free(); 
             if ( !output_full && port_free ) {
                 std::list<cache_event> events;
@@ -393,8 +525,7 @@ void memory_sub_partition::cache_cycle( unsigned cycle )
                             delete mf;//-write back accept signal , get and delete it.
                         } else {
                             mf->set_reply();
-                            mf->set_status(IN_PARTITION_L2_TO_ICNT_QUEUE,gpu_sim_cycle+gpu_tot_sim_cycle);
-                            m_L2_icnt_queue->push(mf);//- L2 hit,move back to icnt
+                            push_reply(mf);//- L2 hit,move back to icnt
                         }
                         m_icnt_L2_queue->pop();
                     } else {
@@ -33,6 +33,7 @@
 
 #include <list>
 #include <queue>
+#include <map>
 
 class mem_fetch;
 
@@ -141,6 +142,40 @@ private:
    std::list<dram_delay_t> m_dram_latency_queue;
 };
 
+struct atomic_unit_stats {
+   atomic_unit_stats() { clear(); }
+   void clear()
+   {
+      requests = 0;
+      lane_ops = 0;
+      alu_ops = 0;
+      merged_reductions = 0;
+      busy_cycles = 0;
+      serialized_cycles = 0;
+      addr_stall_cycles = 0;
+   }
+   atomic_unit_stats &operator+=( const atomic_unit_stats &s )
+   {
+      requests += s.requests;
+      lane_ops += s.lane_ops;
+      alu_ops += s.alu_ops;
+      merged_reductions += s.merged_reductions;
+      busy_cycles += s.busy_cycles;
+      serialized_cycles += s.serialized_cycles;
+      addr_stall_cycles += s.addr_stall_cycles;
+      return *this;
+   }
+   void print( FILE *fp, const char *name ) const;
+
+   unsigned long long requests;          // atomic/reduction mem_fetches serviced
+   unsigned long long lane_ops;          // per-thread read-modify-writes
+   unsigned long long alu_ops;           // issue slots after merging/combining
+   unsigned long long merged_reductions; // reduction requests folded into an earlier one
+   unsigned long long busy_cycles;
+   unsigned long long serialized_cycles; // extra issue cycles from same-address lanes
+   unsigned long long addr_stall_cycles; // waiting on a still in-flight update to the same word
+};
+
 class memory_sub_partition
 {
 public:
@@ -176,8 +211,14 @@ public:
 
    void accumulate_L2cache_stats(class cache_stats &l2_stats) const;
    void get_L2cache_sub_stats(struct cache_sub_stats &css) const;
+   const atomic_unit_stats &get_atomic_unit_stats() const { return m_atomic_stats; }
 
 private:
+   bool atomic_unit_enabled() const;
+   bool reply_queue_full( const class mem_fetch *mf ) const;
+   void push_reply( class mem_fetch *mf );
+   void atomic_unit_cycle( unsigned long long cycle );
+
 // data
    unsigned m_id;  //< the global sub partition ID
    const struct memory_config *m_config;
@@ -193,6 +234,19 @@ private:
    };
    std::queue<rop_delay_t> m_rop;
 
+   // near-memory atomic/reduction unit: atomics leaving the L2 (hit or fill)
+   // perform their read-modify-write here before the reply is returned
+   struct atomic_op_t
+   {
+      unsigned long long ready_cycle;
+      std::list<class mem_fetch*> reqs; // more than one if reductions were merged
+   };
+   std::list<class mem_fetch*> m_atomic_queue;
+   std::list<atomic_op_t> m_atomic_pipe;
+   unsigned long long m_atomic_issue_cycle; // ALU free from this cycle on
+   std::map<new_addr_type,unsigned long long> m_atomic_word_busy; // word -> cycle its update completes
+   atomic_unit_stats m_atomic_stats;
+
    // these are various FIFOs between units within a memory partition
    fifo_pipeline<mem_fetch> *m_icnt_L2_queue;
    fifo_pipeline<mem_fetch> *m_L2_dram_queue;
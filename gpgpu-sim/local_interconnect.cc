@@ -0,0 +1,260 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "local_interconnect.h"
+#include <assert.h>
+#include <stdlib.h>
+#include "../option_parser.h"
+
+void local_icnt_config::reg_options( class OptionParser * opp )
+{
+   option_parser_register(opp, "-local_icnt_topology", OPT_INT32, &topology,
+                          "Topology of the built-in interconnect (0=crossbar, 1=ring)", "0");
+   option_parser_register(opp, "-local_icnt_flit_size", OPT_UINT32, &flit_size,
+                          "Flit size in bytes of the built-in interconnect", "32");
+   option_parser_register(opp, "-local_icnt_port_bandwidth", OPT_UINT32, &port_bandwidth,
+                          "Flits per cycle accepted/delivered by each port of the built-in interconnect", "1");
+   option_parser_register(opp, "-local_icnt_latency", OPT_UINT32, &latency,
+                          "Fixed pipeline latency of the built-in interconnect (cycles)", "8");
+   option_parser_register(opp, "-local_icnt_hop_latency", OPT_UINT32, &hop_latency,
+                          "Additional latency per hop of the built-in ring", "1");
+   option_parser_register(opp, "-local_icnt_in_buffer_limit", OPT_UINT32, &in_buffer_limit,
+                          "Input buffer size per node of the built-in interconnect (flits)", "64");
+   option_parser_register(opp, "-local_icnt_out_buffer_limit", OPT_UINT32, &out_buffer_limit,
+                          "Output buffer size per node of the built-in interconnect (flits)", "64");
+   option_parser_register(opp, "-local_icnt_subnets", OPT_UINT32, &subnets,
+                          "Number of subnets of the built-in interconnect (1=shared, 2=request/reply)", "2");
+}
+
+local_interconnect::local_interconnect( const local_icnt_config &config )
+   : m_config(config)
+{
+   m_n_shader = 0;
+   m_n_mem = 0;
+   m_n_nodes = 0;
+   m_time = 0;
+}
+
+local_interconnect::~local_interconnect()
+{
+}
+
+void local_interconnect::create( unsigned n_shader, unsigned n_mem )
+{
+   assert( m_config.subnets == 1 || m_config.subnets == 2 );
+   assert( m_config.flit_size > 0 && m_config.port_bandwidth > 0 );
+   assert( m_config.in_buffer_limit > 0 && m_config.out_buffer_limit > 0 );
+
+   m_n_shader = n_shader;
+   m_n_mem = n_mem;
+   m_n_nodes = n_shader + n_mem;
+   m_subnets.resize(m_config.subnets);
+   for (unsigned s=0; s < m_subnets.size(); s++) {
+      subnet &net = m_subnets[s];
+      net.in_queue.resize(m_n_nodes);
+      net.out_queue.resize(m_n_nodes);
+      for (unsigned n=0; n < m_n_nodes; n++) {
+         net.in_queue[n].resize(m_config.in_buffer_limit);
+         net.out_queue[n].resize(m_config.out_buffer_limit);
+      }
+      net.in_flits.assign(m_n_nodes, 0);
+      net.out_flits.assign(m_n_nodes, 0);
+      net.in_busy.assign(m_n_nodes, 0);
+      net.out_busy.assign(m_n_nodes, 0);
+      net.rr_start = 0;
+      net.in_flight = 0;
+      clear_stats(net);
+   }
+   printf("GPGPU-Sim uArch: built-in %s interconnect: %u nodes, %u subnet(s), latency = %u, port bandwidth = %u flit(s)/cycle\n",
+          (m_config.topology == LOCAL_ICNT_RING)? "ring" : "crossbar", m_n_nodes, m_config.subnets,
+          m_config.latency, m_config.port_bandwidth);
+}
+
+void local_interconnect::init()
+{
+   for (unsigned s=0; s < m_subnets.size(); s++) 
+      clear_stats(m_subnets[s]);
+}
+
+void local_interconnect::clear_stats( subnet &net )
+{
+   net.n_packets = 0;
+   net.n_flits = 0;
+   net.tot_latency = 0;
+   net.max_latency = 0;
+   net.n_out_credit_stalls = 0;
+}
+
+unsigned local_interconnect::subnet_of_push( unsigned input ) const
+{
+   if (m_subnets.size() == 1) 
+      return 0;
+   return (input < m_n_shader)? 0 : 1;
+}
+
+unsigned local_interconnect::subnet_of_pop( unsigned output ) const
+{
+   if (m_subnets.size() == 1) 
+      return 0;
+   return (output < m_n_shader)? 1 : 0;
+}
+
+unsigned local_interconnect::n_flits( unsigned int size ) const
+{
+   return (size + m_config.flit_size - 1) / m_config.flit_size;
+}
+
+unsigned local_interconnect::route_latency( unsigned src, unsigned dst ) const
+{
+   if (m_config.topology != LOCAL_ICNT_RING) 
+      return m_config.latency;
+   unsigned dist = (src > dst)? src - dst : dst - src;
+   unsigned hops = (dist < m_n_nodes - dist)? dist : m_n_nodes - dist;
+   return m_config.latency + hops * m_config.hop_latency;
+}
+
+bool local_interconnect::has_buffer( unsigned input, unsigned int size ) const
+{
+   const subnet &net = m_subnets[subnet_of_push(input)];
+   return !net.in_queue[input].full() && (net.in_flits[input] + n_flits(size) <= m_config.in_buffer_limit);
+}
+
+void local_interconnect::push( unsigned input, unsigned output, void *data, unsigned int size )
+{
+   assert( has_buffer(input, size) );
+   assert( output < m_n_nodes );
+   subnet &net = m_subnets[subnet_of_push(input)];
+   packet p;
+   p.data = data;
+   p.src = input;
+   p.dst = output;
+   p.flits = n_flits(size);
+   p.inject_time = m_time;
+   p.ready_time = m_time;
+   net.in_queue[input].push(p);
+   net.in_flits[input] += p.flits;
+   net.in_flight++;
+}
+
+void *local_interconnect::pop( unsigned output )
+{
+   subnet &net = m_subnets[subnet_of_pop(output)];
+   packet_ring &q = net.out_queue[output];
+   if (q.empty() || q.front().ready_time > m_time) 
+      return NULL;
+   packet p = q.front();
+   q.pop();
+   net.out_flits[output] -= p.flits; // return the output credits
+   net.in_flight--;
+
+   unsigned long long latency = m_time - p.inject_time;
+   net.n_packets++;
+   net.n_flits += p.flits;
+   net.tot_latency += latency;
+   if (latency > net.max_latency) 
+      net.max_latency = latency;
+   return p.data;
+}
+
+// One interconnect cycle: every input port offers the packet at the head of
+// its queue, every output port accepts at most one packet per cycle, and a
+// packet of N flits keeps both ports busy for N/port_bandwidth cycles. The
+// packet reserves its space (credits) in the output buffer before leaving the
+// input buffer, so a full destination backs up into the sources.
+void local_interconnect::transfer()
+{
+   m_time++;
+   for (unsigned s=0; s < m_subnets.size(); s++) {
+      subnet &net = m_subnets[s];
+      if (net.in_flight == 0) 
+         continue;
+      for (unsigned i=0; i < m_n_nodes; i++) {
+         unsigned in = (net.rr_start + i) % m_n_nodes;
+         packet_ring &q = net.in_queue[in];
+         if (q.empty() || net.in_busy[in] > m_time) 
+            continue;
+         packet &p = q.front();
+         unsigned out = p.dst;
+         if (net.out_busy[out] > m_time) 
+            continue;
+         if (net.out_queue[out].full() || net.out_flits[out] + p.flits > m_config.out_buffer_limit) {
+            net.n_out_credit_stalls++;
+            continue;
+         }
+         unsigned serialization = (p.flits + m_config.port_bandwidth - 1) / m_config.port_bandwidth;
+         net.in_busy[in] = m_time + serialization;
+         net.out_busy[out] = m_time + serialization;
+         p.ready_time = m_time + serialization - 1 + route_latency(in, out);
+         net.out_flits[out] += p.flits;
+         net.in_flits[in] -= p.flits;
+         net.out_queue[out].push(p);
+         q.pop();
+      }
+      net.rr_start = (net.rr_start + 1) % m_n_nodes;
+   }
+}
+
+bool local_interconnect::busy() const
+{
+   for (unsigned s=0; s < m_subnets.size(); s++) 
+      if (m_subnets[s].in_flight) 
+         return true;
+   return false;
+}
+
+void local_interconnect::print_subnet_stats( const subnet &net, unsigned id ) const
+{
+   printf("local_icnt subnet %u: packets = %llu, flits = %llu, avg_latency = %.2f, max_latency = %llu, out_credit_stalls = %llu\n",
+          id, net.n_packets, net.n_flits, 
+          net.n_packets? (double)net.tot_latency / net.n_packets : 0.0,
+          net.max_latency, net.n_out_credit_stalls);
+}
+
+void local_interconnect::display_stats() const
+{
+   for (unsigned s=0; s < m_subnets.size(); s++) 
+      print_subnet_stats(m_subnets[s], s);
+}
+
+void local_interconnect::display_overall_stats() const
+{
+   display_stats();
+}
+
+void local_interconnect::display_state( FILE *fp ) const
+{
+   for (unsigned s=0; s < m_subnets.size(); s++) {
+      const subnet &net = m_subnets[s];
+      fprintf(fp, "GPGPU-Sim uArch: local_icnt subnet %u: %u packets in flight\n", s, net.in_flight);
+      for (unsigned n=0; n < m_n_nodes; n++) {
+         if (!net.in_queue[n].empty() || !net.out_queue[n].empty())
+            fprintf(fp, "   node %u: in_queue = %u (%u flits), out_queue = %u (%u flits)\n", n,
+                    net.in_queue[n].size(), net.in_flits[n], net.out_queue[n].size(), net.out_flits[n]);
+      }
+   }
+}
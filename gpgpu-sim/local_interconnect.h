@@ -0,0 +1,139 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef LOCAL_INTERCONNECT_H
+#define LOCAL_INTERCONNECT_H
+
+#include <stdio.h>
+#include <vector>
+
+// Lightweight built-in interconnect (-network_mode 2). 
+// 
+// Instead of simulating routers and flits like intersim2, every subnet is 
+// modeled as a single crossbar (or ring) with per-port bandwidth, a fixed 
+// pipeline latency and credit-based backpressure on bounded input/output 
+// buffers. Everything lives in a few fixed-size arrays per subnet, so it is 
+// meant for design-space sweeps that are not about the NoC.
+
+enum local_icnt_topology {
+   LOCAL_ICNT_XBAR = 0,
+   LOCAL_ICNT_RING = 1
+};
+
+struct local_icnt_config {
+   void reg_options( class OptionParser * opp );
+
+   int      topology;          // local_icnt_topology
+   unsigned flit_size;         // bytes per flit
+   unsigned port_bandwidth;    // flits per cycle accepted/delivered by a port
+   unsigned latency;           // fixed pipeline latency (cycles)
+   unsigned hop_latency;       // extra latency per ring hop
+   unsigned in_buffer_limit;   // input buffer size per node (flits)
+   unsigned out_buffer_limit;  // output buffer size per node (flits)
+   unsigned subnets;           // 1 = shared request/reply network, 2 = separate
+};
+
+class local_interconnect {
+public:
+   local_interconnect( const local_icnt_config &config );
+   ~local_interconnect();
+
+   void create( unsigned n_shader, unsigned n_mem );
+   void init();
+   bool has_buffer( unsigned input, unsigned int size ) const;
+   void push( unsigned input, unsigned output, void *data, unsigned int size );
+   void *pop( unsigned output );
+   void transfer();
+   bool busy() const;
+   void display_stats() const;
+   void display_overall_stats() const;
+   void display_state( FILE *fp ) const;
+   unsigned get_flit_size() const { return m_config.flit_size; }
+
+private:
+   struct packet {
+      void *data;
+      unsigned src;
+      unsigned dst;
+      unsigned flits;
+      unsigned long long inject_time;
+      unsigned long long ready_time; // time the packet can leave the current buffer
+   };
+
+   // fixed capacity circular queue of packets, the capacity is bounded by
+   // the buffer size in flits since every packet has at least one flit
+   class packet_ring {
+   public:
+      void resize( unsigned capacity ) { m_slots.resize(capacity); m_head = m_count = 0; }
+      bool empty() const { return m_count == 0; }
+      bool full() const { return m_count == m_slots.size(); }
+      unsigned size() const { return m_count; }
+      packet &front() { return m_slots[m_head]; }
+      const packet &front() const { return m_slots[m_head]; }
+      void push( const packet &p ) { m_slots[(m_head + m_count) % m_slots.size()] = p; m_count++; }
+      void pop() { m_head = (m_head + 1) % m_slots.size(); m_count--; }
+   private:
+      std::vector<packet> m_slots;
+      unsigned m_head;
+      unsigned m_count;
+   };
+
+   struct subnet {
+      std::vector<packet_ring> in_queue;       // [node]
+      std::vector<packet_ring> out_queue;      // [node]
+      std::vector<unsigned> in_flits;          // [node] flits held in in_queue (credits in use)
+      std::vector<unsigned> out_flits;         // [node] flits held/reserved in out_queue
+      std::vector<unsigned long long> in_busy; // [node] input port busy until
+      std::vector<unsigned long long> out_busy;// [node] output port busy until
+      unsigned rr_start;                       // first input considered next cycle
+      unsigned in_flight;
+
+      // stats
+      unsigned long long n_packets;
+      unsigned long long n_flits;
+      unsigned long long tot_latency;
+      unsigned long long max_latency;
+      unsigned long long n_out_credit_stalls;
+   };
+
+   unsigned subnet_of_push( unsigned input ) const;
+   unsigned subnet_of_pop( unsigned output ) const;
+   unsigned n_flits( unsigned int size ) const;
+   unsigned route_latency( unsigned src, unsigned dst ) const;
+   void clear_stats( subnet &net );
+   void print_subnet_stats( const subnet &net, unsigned id ) const;
+
+   const local_icnt_config &m_config;
+   unsigned m_n_shader;
+   unsigned m_n_mem;
+   unsigned m_n_nodes;
+   unsigned long long m_time;
+   std::vector<subnet> m_subnets;
+};
+
+#endif
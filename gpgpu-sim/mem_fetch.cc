@@ -57,6 +57,7 @@ mem_fetch::mem_fetch( const mem_access_t &access,
    m_type = m_access.is_write()?WRITE_REQUEST:READ_REQUEST;
    m_timestamp = gpu_sim_cycle + gpu_tot_sim_cycle;
    m_timestamp2 = 0;
+   m_stage_reached = 0;
    m_status = MEM_FETCH_INITIALIZED;
    m_status_change = gpu_sim_cycle + gpu_tot_sim_cycle;
    m_mem_config = config;
@@ -96,6 +97,18 @@ void mem_fetch::set_status( enum mem_fetch_status status, unsigned long long cyc
 {
     m_status = status;
     m_status_change = cycle;
+    switch( status ) {
+    case IN_L1I_MISS_QUEUE:
+    case IN_L1D_MISS_QUEUE:
+    case IN_L1T_MISS_QUEUE:
+    case IN_L1C_MISS_QUEUE:              set_stage_time(MF_LAT_L1_MISS,cycle); break;
+    case IN_ICNT_TO_MEM:                 set_stage_time(MF_LAT_ICNT_INJECT,cycle); break;
+    case IN_PARTITION_ICNT_TO_L2_QUEUE:  set_stage_time(MF_LAT_L2_QUEUE,cycle); break;
+    case IN_PARTITION_L2_TO_DRAM_QUEUE:  set_stage_time(MF_LAT_DRAM_QUEUE,cycle); break;
+    case IN_PARTITION_DRAM:              set_stage_time(MF_LAT_DRAM_ISSUE,cycle); break;
+    case IN_ICNT_TO_SHADER:              set_stage_time(MF_LAT_RETURN_ICNT,cycle); break;
+    default: break;
+    }
 }
 
 bool mem_fetch::isatomic() const
@@ -47,6 +47,19 @@ enum mf_type {
 #undef MF_TUP
 #undef MF_TUP_END
 
+// points along the path of a request at which mem_fetch keeps a timestamp,
+// used for the per-PC/per-kernel latency breakdown (-gpgpu_memlatency_breakdown)
+enum mf_latency_stage {
+   MF_LAT_L1_MISS = 0,   // entered an L1 miss queue
+   MF_LAT_ICNT_INJECT,   // pushed into the interconnect towards memory
+   MF_LAT_L2_QUEUE,      // entered the icnt->L2 queue
+   MF_LAT_DRAM_QUEUE,    // L2 miss sent to the L2->DRAM queue
+   MF_LAT_DRAM_ISSUE,    // scheduled to a DRAM bank
+   MF_LAT_RETURN_ICNT,   // pushed into the interconnect towards the shader
+   MF_LAT_FILL,          // reply handed to the load/store unit
+   N_MF_LAT_STAGES
+};
+
 class mem_fetch {
 public:
     mem_fetch( const mem_access_t &access, 
@@ -99,6 +112,16 @@ public:
    unsigned get_timestamp() const { return m_timestamp; }
    unsigned get_return_timestamp() const { return m_timestamp2; }
    unsigned get_icnt_receive_time() const { return m_icnt_receive_time; }
+   // the first time the request reached a stage is kept, later visits (e.g. L2 fill) are ignored
+   void set_stage_time( enum mf_latency_stage s, unsigned t ) 
+   { 
+       if( !stage_reached(s) ) {
+           m_stage_time[s] = t;
+           m_stage_reached |= (1<<s);
+       }
+   }
+   bool stage_reached( enum mf_latency_stage s ) const { return m_stage_reached & (1<<s); }
+   unsigned get_stage_time( enum mf_latency_stage s ) const { return m_stage_time[s]; }
 
    enum mem_access_type get_access_type() const { return m_access.get_type(); }
    const active_mask_t& get_access_warp_mask() const { return m_access.get_warp_mask(); }
@@ -134,6 +157,8 @@ private:
    unsigned m_timestamp;  // set to gpu_sim_cycle+gpu_tot_sim_cycle at struct creation
    unsigned m_timestamp2; // set to gpu_sim_cycle+gpu_tot_sim_cycle when pushed onto icnt to shader; only used for reads
    unsigned m_icnt_receive_time; // set to gpu_sim_cycle + interconnect_latency when fixed icnt latency mode is enabled
+   unsigned m_stage_time[N_MF_LAT_STAGES]; // gpu_sim_cycle+gpu_tot_sim_cycle when each stage was first reached
+   unsigned char m_stage_reached;          // bitmask of stages with a valid m_stage_time
 
    // requesting instruction (put last so mem_fetch prints nicer in gdb)
    warp_inst_t m_inst; // the inst.
@@ -35,11 +35,13 @@
 #include "mem_fetch.h"
 #include "stat-tool.h"
 #include "../cuda-sim/ptx-stats.h"
+#include "../cuda-sim/ptx_ir.h"
 #include "visualizer.h"
 #include "dram.h"
 
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include <stdio.h>
 
 memory_stats_t::memory_stats_t( unsigned n_shader, const struct shader_core_config *shader_config, const struct memory_config *mem_config )
@@ -92,6 +94,7 @@ memory_stats_t::memory_stats_t( unsigned n_shader, const struct shader_core_conf
    totalbankaccesses = (unsigned int**) calloc(mem_config->m_n_mem, sizeof(unsigned int*));
    mf_total_lat_table = (unsigned long long int **) calloc(mem_config->m_n_mem, sizeof(unsigned long long *));
    mf_max_lat_table = (unsigned **) calloc(mem_config->m_n_mem, sizeof(unsigned *));
+   addr_chip_bank_access = (unsigned long long **) calloc(mem_config->m_n_mem, sizeof(unsigned long long *));
    bankreads = (unsigned int***) calloc(n_shader, sizeof(unsigned int**));
    bankwrites = (unsigned int***) calloc(n_shader, sizeof(unsigned int**));
    num_MCBs_accessed = (unsigned int*) calloc(mem_config->m_n_mem*mem_config->nbk, sizeof(unsigned int));
@@ -114,6 +117,7 @@ memory_stats_t::memory_stats_t( unsigned n_shader, const struct shader_core_conf
       totalbankaccesses[i] = (unsigned int*) calloc(mem_config->nbk, sizeof(unsigned int));
       mf_total_lat_table[i] = (unsigned long long int*) calloc(mem_config->nbk, sizeof(unsigned long long int));
       mf_max_lat_table[i] = (unsigned *) calloc(mem_config->nbk, sizeof(unsigned));
+      addr_chip_bank_access[i] = (unsigned long long *) calloc(mem_config->nbk, sizeof(unsigned long long));
    }
 
    mem_access_type_stats = (unsigned ***) malloc(NUM_MEM_ACCESS_TYPE * sizeof(unsigned **));
@@ -131,6 +135,8 @@ memory_stats_t::memory_stats_t( unsigned n_shader, const struct shader_core_conf
    L2_dramtoL2length = (unsigned int*) calloc(mem_config->m_n_mem, sizeof(unsigned int));
    L2_dramtoL2writelength = (unsigned int*) calloc(mem_config->m_n_mem, sizeof(unsigned int));
    L2_L2todramlength = (unsigned int*) calloc(mem_config->m_n_mem, sizeof(unsigned int));
+
+   memset(m_kernel_stage_hist, 0, sizeof(m_kernel_stage_hist));
 }
 
 // record the total latency
@@ -150,8 +156,131 @@ unsigned memory_stats_t::memlatstat_done(mem_fetch *mf )
    return mf_latency;
 }
 
+// attribute the latency of a completed load to the stages it went through: the
+// time between two consecutive stages the request reached is charged to the later one
+void memory_stats_t::memlatstat_breakdown(mem_fetch *mf)
+{
+   unsigned now = gpu_sim_cycle+gpu_tot_sim_cycle;
+   mf->set_stage_time(MF_LAT_FILL, now);
+   unsigned latency = now - mf->get_timestamp();
+   unsigned idx = LOGB2(latency);
+   assert(idx<32);
+
+   mem_lat_breakdown *stats[2];
+   unsigned n_stats = 0;
+   stats[n_stats++] = &m_kernel_lat_breakdown;
+   if (mf->get_pc() != (address_type)-1) 
+      stats[n_stats++] = &m_pc_lat_breakdown[mf->get_pc()];
+
+   for (unsigned i=0; i<n_stats; i++) {
+      stats[i]->n_req++;
+      stats[i]->tot_lat += latency;
+      stats[i]->lat_hist[idx]++;
+      if (latency > stats[i]->max_lat) 
+         stats[i]->max_lat = latency;
+   }
+   unsigned last = mf->get_timestamp();
+   for (unsigned s=0; s<N_MF_LAT_STAGES; s++) {
+      enum mf_latency_stage stage = (enum mf_latency_stage)s;
+      if (!mf->stage_reached(stage)) 
+         continue;
+      unsigned stage_latency = mf->get_stage_time(stage) - last;
+      last = mf->get_stage_time(stage);
+      m_kernel_stage_hist[s][LOGB2(stage_latency)]++;
+      for (unsigned i=0; i<n_stats; i++) 
+         stats[i]->stage_lat[s] += stage_latency;
+   }
+}
+
+static const char *mf_lat_stage_str[N_MF_LAT_STAGES] = {
+   "l1_miss", "icnt_inject", "l2_queue", "dram_queue", "dram_issue", "return_icnt", "fill"
+};
+
+void memory_stats_t::memlatstat_breakdown_print(FILE *fp)
+{
+   if (!m_memory_config->gpgpu_memlatency_breakdown) 
+      return;
+
+   const mem_lat_breakdown &k = m_kernel_lat_breakdown;
+   fprintf(fp, "mem_lat_breakdown: loads = %u, avg_latency = %.2f, max_latency = %u\n", 
+           k.n_req, k.n_req? (float)k.tot_lat/k.n_req : 0.0f, k.max_lat);
+   fprintf(fp, "mem_lat_breakdown_total_hist = ");
+   for (unsigned i=0; i<32; i++) 
+      fprintf(fp, "%u ", k.lat_hist[i]);
+   fprintf(fp, "\n");
+   for (unsigned s=0; s<N_MF_LAT_STAGES; s++) {
+      fprintf(fp, "mem_lat_breakdown[%-11s]: avg = %8.2f, hist = ", mf_lat_stage_str[s], 
+              k.n_req? (float)k.stage_lat[s]/k.n_req : 0.0f);
+      for (unsigned i=0; i<32; i++) 
+         fprintf(fp, "%u ", m_kernel_stage_hist[s][i]);
+      fprintf(fp, "\n");
+   }
+
+   // per-PC averages, stage columns in the order of mf_lat_stage_str
+   fprintf(fp, "mem_lat_breakdown_pc: pc, loads, avg, max");
+   for (unsigned s=0; s<N_MF_LAT_STAGES; s++) 
+      fprintf(fp, ", %s", mf_lat_stage_str[s]);
+   fprintf(fp, ", source\n");
+   std::map<address_type, mem_lat_breakdown>::const_iterator p;
+   for (p = m_pc_lat_breakdown.begin(); p != m_pc_lat_breakdown.end(); ++p) {
+      const mem_lat_breakdown &b = p->second;
+      fprintf(fp, "mem_lat_breakdown_pc: 0x%04x, %u, %.2f, %u", p->first, b.n_req, (float)b.tot_lat/b.n_req, b.max_lat);
+      for (unsigned s=0; s<N_MF_LAT_STAGES; s++) 
+         fprintf(fp, ", %.2f", (float)b.stage_lat[s]/b.n_req);
+      const ptx_instruction *pInsn = function_info::pc_to_instruction(p->first);
+      if (pInsn) 
+         fprintf(fp, ", %s:%u", pInsn->source_file(), pInsn->source_line());
+      fprintf(fp, "\n");
+   }
+
+   m_kernel_lat_breakdown.clear();
+   memset(m_kernel_stage_hist, 0, sizeof(m_kernel_stage_hist));
+   m_pc_lat_breakdown.clear();
+}
+
+// summarizes how evenly the address mapping spreads requests: max/mean and 
+// coefficient of variation over the channels, and over the banks of each channel
+static void print_imbalance( FILE *fp, const char *name, const unsigned long long *count, unsigned n )
+{
+   unsigned long long total = 0, max = 0; 
+   for (unsigned i=0; i<n; i++) {
+      total += count[i]; 
+      if (count[i] > max) max = count[i]; 
+   }
+   double mean = (double)total / n; 
+   double var = 0.0; 
+   for (unsigned i=0; i<n; i++) 
+      var += (count[i] - mean) * (count[i] - mean); 
+   var /= n; 
+   fprintf(fp, "%s: accesses = %llu, max/mean = %.3f, cov = %.3f\n", name, total, 
+           (mean > 0)? max / mean : 0.0, (mean > 0)? sqrt(var) / mean : 0.0); 
+}
+
+void memory_stats_t::memlatstat_imbalance_print(FILE *fp) const
+{
+   unsigned n_mem = m_memory_config->m_n_mem; 
+   unsigned nbk = m_memory_config->nbk; 
+   unsigned long long *chip_count = (unsigned long long *) calloc(n_mem, sizeof(unsigned long long)); 
+   fprintf(fp, "addr_chip_access = "); 
+   for (unsigned i=0; i<n_mem; i++) {
+      for (unsigned j=0; j<nbk; j++) 
+         chip_count[i] += addr_chip_bank_access[i][j]; 
+      fprintf(fp, "%llu ", chip_count[i]); 
+   }
+   fprintf(fp, "\n"); 
+   print_imbalance(fp, "addr_chip_imbalance", chip_count, n_mem); 
+   for (unsigned i=0; i<n_mem; i++) {
+      char name[64]; 
+      snprintf(name, sizeof(name), "addr_bank_imbalance[%u]", i); 
+      print_imbalance(fp, name, addr_chip_bank_access[i], nbk); 
+   }
+   free(chip_count); 
+}
+
 void memory_stats_t::memlatstat_read_done(mem_fetch *mf)
 {
+   if (m_memory_config->gpgpu_memlatency_breakdown && !mf->get_is_write()) 
+      memlatstat_breakdown(mf);
    if (m_memory_config->gpgpu_memlatency_stat) {
       unsigned mf_latency = memlatstat_done(mf);
       if (mf_latency > mf_max_lat_table[mf->get_tlx_addr().chip][mf->get_tlx_addr().bk]) 
@@ -176,8 +305,10 @@ void memory_stats_t::memlatstat_dram_access(mem_fetch *mf)
          }
          totalbankwrites[dram_id][bank]++;
       } else {
-         bankreads[mf->get_sid()][dram_id][bank]++;
-         shader_mem_acc_log( mf->get_sid(), dram_id, bank, 'r');
+         if ( mf->get_sid() < m_n_shader  ) {   //do not count copy engine DMA reads here 
+            bankreads[mf->get_sid()][dram_id][bank]++;
+            shader_mem_acc_log( mf->get_sid(), dram_id, bank, 'r');
+         }
          totalbankreads[dram_id][bank]++;
       }
       mem_access_type_stats[mf->get_access_type()][dram_id][bank]++;
@@ -188,6 +319,9 @@ void memory_stats_t::memlatstat_dram_access(mem_fetch *mf)
 
 void memory_stats_t::memlatstat_icnt2mem_pop(mem_fetch *mf)
 {
+   const addrdec_t &tlx = mf->get_tlx_addr(); 
+   if (tlx.chip < m_memory_config->m_n_mem && tlx.bk < m_memory_config->nbk) 
+      addr_chip_bank_access[tlx.chip][tlx.bk]++; 
    if (m_memory_config->gpgpu_memlatency_stat) {
       unsigned icnt2mem_latency;
       icnt2mem_latency = (gpu_tot_sim_cycle+gpu_sim_cycle) - mf->get_timestamp();
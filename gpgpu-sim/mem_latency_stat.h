@@ -31,6 +31,8 @@
 #include <stdio.h>
 #include <zlib.h>
 #include <map>
+#include <string.h>
+#include "mem_fetch.h"
 
 class memory_stats_t {
 public:
@@ -40,10 +42,13 @@ public:
 
    unsigned memlatstat_done( class mem_fetch *mf );
    void memlatstat_read_done( class mem_fetch *mf );
+   void memlatstat_breakdown( class mem_fetch *mf );
    void memlatstat_dram_access( class mem_fetch *mf );
    void memlatstat_icnt2mem_pop( class mem_fetch *mf);
    void memlatstat_lat_pw();
    void memlatstat_print(unsigned n_mem, unsigned gpu_mem_n_bk);
+   void memlatstat_breakdown_print(FILE *fp);
+   void memlatstat_imbalance_print(FILE *fp) const;
 
    void visualizer_print( gzFile visualizer_file );
 
@@ -75,6 +80,7 @@ public:
    unsigned int **totalbankwrites; //bankwrites[dram chip id][bank id]
    unsigned int **totalbankreads; //bankreads[dram chip id][bank id]
    unsigned int **totalbankaccesses; //bankaccesses[dram chip id][bank id]
+   unsigned long long **addr_chip_bank_access; //requests arriving at each [dram chip id][bank id], for the address mapping imbalance report
    unsigned int *num_MCBs_accessed; //tracks how many memory controllers are accessed whenever any thread in a warp misses in cache
    unsigned int *position_of_mrq_chosen; //position of mrq in m_queue chosen 
    
@@ -96,6 +102,20 @@ public:
    unsigned int **max_conc_access2samerow; //max_conc_access2samerow[dram chip id][bank id]
    unsigned int **max_servicetime2samerow; //max_servicetime2samerow[dram chip id][bank id]
 
+   // load latency broken down by mem_fetch stage, reset at every kernel exit
+   struct mem_lat_breakdown {
+      mem_lat_breakdown() { clear(); }
+      void clear() { memset(this, 0, sizeof(*this)); }
+      unsigned n_req;
+      unsigned max_lat;
+      unsigned long long tot_lat;
+      unsigned long long stage_lat[N_MF_LAT_STAGES]; // cycles spent before reaching each stage
+      unsigned lat_hist[32];                        // log2 histogram of total latency
+   };
+   mem_lat_breakdown m_kernel_lat_breakdown;
+   unsigned m_kernel_stage_hist[N_MF_LAT_STAGES][32]; // log2 histogram of each stage
+   std::map<address_type, mem_lat_breakdown> m_pc_lat_breakdown;
+
    // Power stats
    unsigned total_n_access;
    unsigned total_n_reads;
@@ -103,6 +103,38 @@ void mcpat_cycle(const gpgpu_sim_config &config, const struct shader_core_config
 		double n_icnt_mem_to_simt = (double)power_stats->get_icnt_mem_to_simt(); // # flits from memory partitions to SIMT clusters
 		wrapper->set_NoC_power(n_icnt_mem_to_simt, n_icnt_simt_to_mem); // Number of flits traversing the interconnect
 
+		// Per-SM and per-channel activity for the per-instance power breakdown
+		power_core_stat_t *core = power_stats->pwr_core_stat;
+		power_mem_stat_t *mem = power_stats->pwr_mem_stat;
+		std::vector<double> counters(NUM_PERFORMANCE_COUNTERS, 0);
+		for(unsigned i=0; i<shdr_config->num_shader(); i++){
+			counters[TOT_INST] = power_stats->get_instance_count(core->m_num_decoded_insn, i);
+			counters[FP_INT] = power_stats->get_instance_count(core->m_num_INTdecoded_insn, i)
+					+ power_stats->get_instance_count(core->m_num_FPdecoded_insn, i);
+			counters[REG_RD] = power_stats->get_instance_count(core->m_read_regfile_acesses, i);
+			counters[REG_WR] = power_stats->get_instance_count(core->m_write_regfile_acesses, i);
+			counters[NON_REG_OPs] = power_stats->get_instance_count(core->m_non_rf_operands, i);
+			counters[SHRD_ACC] = power_stats->get_instance_count(mem->shmem_read_access, i);
+			counters[SP_ACC] = power_stats->get_instance_count(core->m_num_ialu_acesses, i);
+			counters[SFU_ACC] = power_stats->get_instance_count(core->m_num_idiv_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_imul32_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_trans_acesses, i);
+			counters[FPU_ACC] = power_stats->get_instance_count(core->m_num_fp_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_fpdiv_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_fpmul_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_imul24_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_imul_acesses, i)
+					+ power_stats->get_instance_count(core->m_num_loadqueued_insn, i)
+					+ power_stats->get_instance_count(core->m_num_storequeued_insn, i)
+					+ power_stats->get_instance_count(core->m_num_tex_inst, i)
+					+ power_stats->get_instance_count(core->m_num_tensor_acesses, i); // no tensor core in the power model
+			wrapper->set_core_activity(i, counters);
+		}
+		for(unsigned i=0; i<power_stats->m_mem_config->m_n_mem; i++){
+			wrapper->set_mem_activity(i, power_stats->get_instance_count(mem->n_rd, i),
+					power_stats->get_instance_count(mem->n_wr, i), power_stats->get_instance_count(mem->n_pre, i));
+		}
+
 		wrapper->compute();
 
 
@@ -59,10 +59,12 @@ struct shader_core_power_stats_pod {
     unsigned *m_num_fpdiv_acesses[NUM_STAT_IDX];
     unsigned *m_num_sp_acesses[NUM_STAT_IDX];
     unsigned *m_num_sfu_acesses[NUM_STAT_IDX];
+    unsigned *m_num_tensor_acesses[NUM_STAT_IDX];
     unsigned *m_num_trans_acesses[NUM_STAT_IDX];
     unsigned *m_num_mem_acesses[NUM_STAT_IDX];
     unsigned *m_num_sp_committed[NUM_STAT_IDX];
     unsigned *m_num_sfu_committed[NUM_STAT_IDX];
+    unsigned *m_num_tensor_committed[NUM_STAT_IDX];
     unsigned *m_num_mem_committed[NUM_STAT_IDX];
     unsigned *m_active_sp_lanes[NUM_STAT_IDX];
     unsigned *m_active_sfu_lanes[NUM_STAT_IDX];
@@ -199,6 +201,7 @@ public:
         for(unsigned i=0; i<m_config->num_shader();i++){
             total_inst+=(pwr_core_stat->m_num_mem_committed[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_mem_committed[PREV_STAT_IDX][i])
                     +(pwr_core_stat->m_num_sfu_committed[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_sfu_committed[PREV_STAT_IDX][i])
+                    +(pwr_core_stat->m_num_tensor_committed[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_tensor_committed[PREV_STAT_IDX][i])
                     +(pwr_core_stat->m_num_sp_committed[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_sp_committed[PREV_STAT_IDX][i]);
         }
         return total_inst;
@@ -339,7 +342,8 @@ public:
                     (pwr_core_stat->m_num_fpdiv_acesses[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_fpdiv_acesses[PREV_STAT_IDX][i])+
                     (pwr_core_stat->m_num_fpmul_acesses[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_fpmul_acesses[PREV_STAT_IDX][i])+
                     (pwr_core_stat->m_num_imul24_acesses[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_imul24_acesses[PREV_STAT_IDX][i])+
-                    (pwr_core_stat->m_num_imul_acesses[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_imul_acesses[PREV_STAT_IDX][i]);
+                    (pwr_core_stat->m_num_imul_acesses[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_imul_acesses[PREV_STAT_IDX][i])+
+                    (pwr_core_stat->m_num_tensor_acesses[CURRENT_STAT_IDX][i]) - (pwr_core_stat->m_num_tensor_acesses[PREV_STAT_IDX][i]);
         }
         total_inst += get_total_load_inst()+get_total_store_inst()+get_tex_inst();
         return total_inst;
@@ -616,6 +620,12 @@ public:
         return total;
     }
 
+    // Change of one SM's (pwr_core_stat) or one DRAM channel's (pwr_mem_stat) 
+    // counter over the current sample, for the per-instance power breakdown.
+    unsigned get_instance_count( unsigned * const stat[NUM_STAT_IDX], unsigned i ) const {
+        return stat[CURRENT_STAT_IDX][i] - stat[PREV_STAT_IDX][i];
+    }
+
    power_core_stat_t * pwr_core_stat;
    power_mem_stat_t * pwr_mem_stat;
    float * m_average_pipeline_duty_cycle;
@@ -65,6 +65,19 @@ std::list<unsigned> shader_core_ctx::get_regs_written( const inst_t &fvt ) const
    return result;
 }
 
+// pipeline registers a scheduler owns privately in the sub-core model
+static bool sub_core_stage( enum pipeline_stage_name_t stage )
+{
+    return stage == ID_OC_SP || stage == ID_OC_SFU || stage == OC_EX_SP || stage == OC_EX_SFU;
+}
+
+register_set *shader_core_ctx::pipeline_reg( enum pipeline_stage_name_t stage, unsigned sub_core )
+{
+    if ( m_sub_core_reg.empty() || !sub_core_stage(stage) )
+        return &m_pipeline_reg[stage];
+    return &m_sub_core_reg[sub_core*N_PIPELINE_STAGES + stage];
+}
+
 shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu, 
                                   class simt_core_cluster *cluster,
                                   unsigned shader_id,
@@ -90,14 +103,27 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
     for (int j = 0; j<N_PIPELINE_STAGES; j++) {
         m_pipeline_reg.push_back(register_set(m_config->pipe_widths[j],pipeline_stage_name_decode[j]));
     }
+    if ( m_config->gpgpu_sub_core_model ) {
+        // every scheduler gets private SP/SFU pipeline registers with its share of the width
+        unsigned n = m_config->num_sub_cores();
+        m_sub_core_reg.reserve(n*N_PIPELINE_STAGES);
+        for (unsigned sc = 0; sc < n; sc++) {
+            for (int j = 0; j<N_PIPELINE_STAGES; j++) {
+                unsigned width = sub_core_stage((pipeline_stage_name_t)j) ? m_config->pipe_widths[j]/n : 0;
+                m_sub_core_reg.push_back(register_set(width,pipeline_stage_name_decode[j]));
+            }
+        }
+    }
     
     m_threadState = (thread_ctx_t*) calloc(sizeof(thread_ctx_t), config->n_thread_per_shader);// 1536 for GTX480,read from config file, a thread_ctx array.
     
     m_not_completed = 0;
     m_active_threads.reset();
     m_n_active_cta = 0;
-    for ( unsigned i = 0; i<MAX_CTA_PER_SHADER; i++ )//32, fix in code 
+    for ( unsigned i = 0; i<MAX_CTA_PER_SHADER; i++ ) {//32, fix in code 
         m_cta_status[i]=0;//- init to 0,mean no CTA.
+        m_cta_resource[i].kernel=NULL;
+    }
     for (unsigned i = 0; i < config->n_thread_per_shader; i++) {//-1536 for GTX480,
         m_thread[i]= NULL;
         m_threadState[i].m_cta_id = -1;
@@ -119,6 +145,8 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
     char name[STRSIZE];
     snprintf(name, STRSIZE, "L1I_%03d", m_sid);
     m_L1I = new read_only_cache( name,m_config->m_L1I_config,m_sid,get_shader_instruction_cache_id(),m_icnt,IN_L1I_MISS_QUEUE);
+    m_iprefetcher = new ifetch_prefetcher( m_config->m_iprefetch_config, m_config->m_L1I_config.get_line_sz(), 
+                                           m_config->max_warps_per_shader, m_config->max_cta_per_core );
    //-vect<warp>, be care , in rfu_t class, the m_warp is a inst *.
     m_warp.resize(m_config->max_warps_per_shader, shd_warp_t(this, warp_size));//1536/32=48 (fermi config file). the second param is a structor for new added warp. resize(48,warp() ) new 48 (zero value)warps in the list. 
     m_scoreboard = new Scoreboard(m_sid, m_config->max_warps_per_shader);// 48
@@ -147,9 +175,9 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
                                        m_scoreboard,
                                        m_simt_stack,
                                        &m_warp,
-                                       &m_pipeline_reg[ID_OC_SP], // 0
-                                       &m_pipeline_reg[ID_OC_SFU],// 1
-                                       &m_pipeline_reg[ID_OC_MEM],// 2
+                                       pipeline_reg(ID_OC_SP,i), // 0
+                                       pipeline_reg(ID_OC_SFU,i),// 1
+                                       pipeline_reg(ID_OC_MEM,i),// 2
                                        i
                                      )
                 );
@@ -161,9 +189,9 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
                                                     m_scoreboard,
                                                     m_simt_stack,
                                                     &m_warp,
-                                                    &m_pipeline_reg[ID_OC_SP],
-                                                    &m_pipeline_reg[ID_OC_SFU],
-                                                    &m_pipeline_reg[ID_OC_MEM],
+                                                    pipeline_reg(ID_OC_SP,i),
+                                                    pipeline_reg(ID_OC_SFU,i),
+                                                    pipeline_reg(ID_OC_MEM,i),
                                                     i,
                                                     config->gpgpu_scheduler_string
                                                   )
@@ -176,9 +204,9 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
                                        m_scoreboard,
                                        m_simt_stack,
                                        &m_warp,
-                                       &m_pipeline_reg[ID_OC_SP],
-                                       &m_pipeline_reg[ID_OC_SFU],
-                                       &m_pipeline_reg[ID_OC_MEM],
+                                       pipeline_reg(ID_OC_SP,i),
+                                       pipeline_reg(ID_OC_SFU,i),
+                                       pipeline_reg(ID_OC_MEM,i),
                                        i
                                      )
                 );
@@ -190,9 +218,9 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
                                        m_scoreboard,
                                        m_simt_stack,
                                        &m_warp,
-                                       &m_pipeline_reg[ID_OC_SP],
-                                       &m_pipeline_reg[ID_OC_SFU],
-                                       &m_pipeline_reg[ID_OC_MEM],
+                                       pipeline_reg(ID_OC_SP,i),
+                                       pipeline_reg(ID_OC_SFU,i),
+                                       pipeline_reg(ID_OC_MEM,i),
                                        i,
                                        config->gpgpu_scheduler_string
                                      )
@@ -212,82 +240,109 @@ shader_core_ctx::shader_core_ctx( class gpgpu_sim *gpu,
     }
     
     //op collector configuration
-    enum { SP_CUS, SFU_CUS, MEM_CUS, GEN_CUS };
-    m_operand_collector.add_cu_set(SP_CUS, m_config->gpgpu_operand_collector_num_units_sp, m_config->gpgpu_operand_collector_num_out_ports_sp);
-    m_operand_collector.add_cu_set(SFU_CUS, m_config->gpgpu_operand_collector_num_units_sfu, m_config->gpgpu_operand_collector_num_out_ports_sfu);
-    m_operand_collector.add_cu_set(MEM_CUS, m_config->gpgpu_operand_collector_num_units_mem, m_config->gpgpu_operand_collector_num_out_ports_mem);
-    m_operand_collector.add_cu_set(GEN_CUS, m_config->gpgpu_operand_collector_num_units_gen, m_config->gpgpu_operand_collector_num_out_ports_gen);
+    // in the sub-core model the SP, SFU and generic collector units form one set
+    // per scheduler that only serves that scheduler's pipeline registers; the
+    // memory collector units stay shared like the LD/ST unit.
+    enum { SP_CUS, SFU_CUS, MEM_CUS, GEN_CUS, N_CU_SETS };
+    unsigned n_sub_cores = m_config->num_sub_cores();
+    for (unsigned sc = 0; sc < n_sub_cores; sc++) {
+        unsigned base = sc * N_CU_SETS;
+        m_operand_collector.add_cu_set(base+SP_CUS, m_config->gpgpu_operand_collector_num_units_sp/n_sub_cores, m_config->gpgpu_operand_collector_num_out_ports_sp/n_sub_cores);
+        m_operand_collector.add_cu_set(base+SFU_CUS, m_config->gpgpu_operand_collector_num_units_sfu/n_sub_cores, m_config->gpgpu_operand_collector_num_out_ports_sfu/n_sub_cores);
+        if (sc == 0)
+            m_operand_collector.add_cu_set(MEM_CUS, m_config->gpgpu_operand_collector_num_units_mem, m_config->gpgpu_operand_collector_num_out_ports_mem);
+        m_operand_collector.add_cu_set(base+GEN_CUS, m_config->gpgpu_operand_collector_num_units_gen/n_sub_cores, m_config->gpgpu_operand_collector_num_out_ports_gen/n_sub_cores);
+    }
     
     opndcoll_rfu_t::port_vector_t in_ports; // typedef std::vector<register_set*> port_vector_t; //is a vector<reg_set *>
     opndcoll_rfu_t::port_vector_t out_ports; 
     opndcoll_rfu_t::uint_vector_t cu_sets;// typedef std::vector<unsigned int> uint_vector_t;
-    for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_sp; i++) {// SP
-        in_ports.push_back(&m_pipeline_reg[ID_OC_SP]);
-        out_ports.push_back(&m_pipeline_reg[OC_EX_SP]);
-        cu_sets.push_back((unsigned)SP_CUS);
-        cu_sets.push_back((unsigned)GEN_CUS);
-        m_operand_collector.add_port(in_ports,out_ports,cu_sets);
-        in_ports.clear(),out_ports.clear(),cu_sets.clear();
-    }
-    
-    for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_sfu; i++) {// SFU
-        in_ports.push_back(&m_pipeline_reg[ID_OC_SFU]);
-        out_ports.push_back(&m_pipeline_reg[OC_EX_SFU]);
-        cu_sets.push_back((unsigned)SFU_CUS);
-        cu_sets.push_back((unsigned)GEN_CUS);
-        m_operand_collector.add_port(in_ports,out_ports,cu_sets);
-        in_ports.clear(),out_ports.clear(),cu_sets.clear();
+    for (unsigned sc = 0; sc < n_sub_cores; sc++) {
+        unsigned base = sc * N_CU_SETS;
+        for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_sp/n_sub_cores; i++) {// SP
+            in_ports.push_back(pipeline_reg(ID_OC_SP,sc));
+            out_ports.push_back(pipeline_reg(OC_EX_SP,sc));
+            cu_sets.push_back(base+SP_CUS);
+            cu_sets.push_back(base+GEN_CUS);
+            m_operand_collector.add_port(in_ports,out_ports,cu_sets);
+            in_ports.clear(),out_ports.clear(),cu_sets.clear();
+        }
+        
+        for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_sfu/n_sub_cores; i++) {// SFU
+            in_ports.push_back(pipeline_reg(ID_OC_SFU,sc));
+            out_ports.push_back(pipeline_reg(OC_EX_SFU,sc));
+            cu_sets.push_back(base+SFU_CUS);
+            cu_sets.push_back(base+GEN_CUS);
+            m_operand_collector.add_port(in_ports,out_ports,cu_sets);
+            in_ports.clear(),out_ports.clear(),cu_sets.clear();
+        }
     }
     
     for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_mem; i++) {// MEM
         in_ports.push_back(&m_pipeline_reg[ID_OC_MEM]);
         out_ports.push_back(&m_pipeline_reg[OC_EX_MEM]);
         cu_sets.push_back((unsigned)MEM_CUS);
-        cu_sets.push_back((unsigned)GEN_CUS);                       
+        for (unsigned sc = 0; sc < n_sub_cores; sc++)
+            cu_sets.push_back(sc*N_CU_SETS+GEN_CUS);
         m_operand_collector.add_port(in_ports,out_ports,cu_sets);
         in_ports.clear(),out_ports.clear(),cu_sets.clear();
     }   
     
     
-    for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_gen; i++) {// gen ?
-        in_ports.push_back(&m_pipeline_reg[ID_OC_SP]);
-        in_ports.push_back(&m_pipeline_reg[ID_OC_SFU]);
-        in_ports.push_back(&m_pipeline_reg[ID_OC_MEM]);
-        out_ports.push_back(&m_pipeline_reg[OC_EX_SP]);
-        out_ports.push_back(&m_pipeline_reg[OC_EX_SFU]);
-        out_ports.push_back(&m_pipeline_reg[OC_EX_MEM]);
-        cu_sets.push_back((unsigned)GEN_CUS);   
-        m_operand_collector.add_port(in_ports,out_ports,cu_sets);
-        in_ports.clear(),out_ports.clear(),cu_sets.clear();
+    for (unsigned sc = 0; sc < n_sub_cores; sc++) {
+        for (unsigned i = 0; i < m_config->gpgpu_operand_collector_num_in_ports_gen/n_sub_cores; i++) {// gen ?
+            in_ports.push_back(pipeline_reg(ID_OC_SP,sc));
+            in_ports.push_back(pipeline_reg(ID_OC_SFU,sc));
+            in_ports.push_back(&m_pipeline_reg[ID_OC_MEM]);
+            out_ports.push_back(pipeline_reg(OC_EX_SP,sc));
+            out_ports.push_back(pipeline_reg(OC_EX_SFU,sc));
+            out_ports.push_back(&m_pipeline_reg[OC_EX_MEM]);
+            cu_sets.push_back(sc*N_CU_SETS+GEN_CUS);   
+            m_operand_collector.add_port(in_ports,out_ports,cu_sets);
+            in_ports.clear(),out_ports.clear(),cu_sets.clear();
+        }
     }
     
     m_operand_collector.init( m_config->gpgpu_num_reg_banks, this );
     
     // execute
-    m_num_function_units = m_config->gpgpu_num_sp_units + m_config->gpgpu_num_sfu_units + 1; // sp_unit, sfu, ldst_unit
+    m_num_function_units = m_config->gpgpu_num_sp_units + m_config->gpgpu_num_sfu_units + m_config->gpgpu_num_tensor_core_units + 1; // sp_unit, sfu, tensor_core, ldst_unit
     //m_dispatch_port = new enum pipeline_stage_name_t[ m_num_function_units ];
     //m_issue_port = new enum pipeline_stage_name_t[ m_num_function_units ];
     
     //m_fu = new simd_function_unit*[m_num_function_units];
     
+    // in the sub-core model SP/SFU unit k belongs to scheduler k % n_sub_cores
     for (int k = 0; k < m_config->gpgpu_num_sp_units; k++) {
         m_fu.push_back(new sp_unit( &m_pipeline_reg[EX_WB], m_config, this ));// sp
         m_dispatch_port.push_back(ID_OC_SP);
         m_issue_port.push_back(OC_EX_SP);
+        m_fu_sub_core.push_back(k % n_sub_cores);
     }
     
     for (int k = 0; k < m_config->gpgpu_num_sfu_units; k++) {
         m_fu.push_back(new sfu( &m_pipeline_reg[EX_WB], m_config, this ));// sfu
         m_dispatch_port.push_back(ID_OC_SFU);
         m_issue_port.push_back(OC_EX_SFU);
+        m_fu_sub_core.push_back(k % n_sub_cores);
+    }
+    
+    // tensor core units take mma from the SP dispatch port
+    for (int k = 0; k < m_config->gpgpu_num_tensor_core_units; k++) {
+        m_fu.push_back(new tensor_core( &m_pipeline_reg[EX_WB], m_config, this ));
+        m_dispatch_port.push_back(ID_OC_SP);
+        m_issue_port.push_back(OC_EX_SP);
+        m_fu_sub_core.push_back(k % n_sub_cores);
     }
     // ldst unit
     m_ldst_unit = new ldst_unit( m_icnt, m_mem_fetch_allocator, this, &m_operand_collector, m_scoreboard, config, mem_config, stats, shader_id, tpc_id );
     m_fu.push_back(m_ldst_unit);
     m_dispatch_port.push_back(ID_OC_MEM);
     m_issue_port.push_back(OC_EX_MEM);
+    m_fu_sub_core.push_back(0);
     
     assert(m_num_function_units == m_fu.size() and m_fu.size() == m_dispatch_port.size() and m_fu.size() == m_issue_port.size());
+    assert(m_fu.size() == m_fu_sub_core.size());
     
     //there are as many result buses as the width of the EX_WB stage
     num_result_bus = config->pipe_widths[EX_WB];// 1 in fermi.
@@ -334,6 +389,7 @@ void shader_core_ctx::init_warps( unsigned cta_id, unsigned start_thread, unsign
                 }
             }
             m_simt_stack[i]->launch(start_pc,active_threads);
+            m_operand_collector.rf_cache_flush(i);
             m_warp[i].init(start_pc,cta_id,i,active_threads, m_dynamic_warp_id);//-give values to m_warp[];
             ++m_dynamic_warp_id;
             m_not_completed += n_active;
@@ -423,6 +479,12 @@ void shader_core_stats::print( FILE* fout ) const
            gpu_stall_shd_mem_breakdown[L_MEM_LD][DATA_PORT_STALL] + 
            gpu_stall_shd_mem_breakdown[L_MEM_ST][DATA_PORT_STALL]    
            ); // data port stall at data cache 
+   fprintf(fout, "gpgpu_stall_shd_mem[gl_mem][tlb_stall]      = %d\n", 
+           gpu_stall_shd_mem_breakdown[G_MEM_LD][TLB_STALL] + 
+           gpu_stall_shd_mem_breakdown[G_MEM_ST][TLB_STALL] + 
+           gpu_stall_shd_mem_breakdown[L_MEM_LD][TLB_STALL] + 
+           gpu_stall_shd_mem_breakdown[L_MEM_ST][TLB_STALL]    
+           ); // waiting for address translation 
    fprintf(fout, "gpgpu_stall_shd_mem[g_mem_ld][mshr_rc]      = %d\n", gpu_stall_shd_mem_breakdown[G_MEM_LD][MSHR_RC_FAIL]);
    fprintf(fout, "gpgpu_stall_shd_mem[g_mem_ld][icnt_rc]      = %d\n", gpu_stall_shd_mem_breakdown[G_MEM_LD][ICNT_RC_FAIL]);
    fprintf(fout, "gpgpu_stall_shd_mem[g_mem_ld][wb_icnt_rc]   = %d\n", gpu_stall_shd_mem_breakdown[G_MEM_LD][WB_ICNT_RC_FAIL]);
@@ -441,6 +503,41 @@ void shader_core_stats::print( FILE* fout ) const
    fprintf(fout, "gpgpu_stall_shd_mem[l_mem_ld][wb_rsrv_fail] = %d\n", gpu_stall_shd_mem_breakdown[L_MEM_ST][WB_CACHE_RSRV_FAIL]);
 
    fprintf(fout, "gpu_reg_bank_conflict_stalls                = %d\n", gpu_reg_bank_conflict_stalls);
+   if (m_config->gpgpu_rf_cache_entries) {
+      fprintf(fout, "gpgpu_n_rf_cache_access                     = %u\n", gpgpu_n_rf_cache_access);
+      fprintf(fout, "gpgpu_n_rf_cache_hit                        = %u\n", gpgpu_n_rf_cache_hit);
+      fprintf(fout, "gpgpu_rf_cache_hit_rate                     = %.4f\n", 
+              gpgpu_n_rf_cache_access ? (float)gpgpu_n_rf_cache_hit / gpgpu_n_rf_cache_access : 0.0f);
+   }
+
+   if (m_config->gpgpu_dwf_max_warps > 1) {
+      unsigned slots = gpgpu_n_dwf_warp_insn - gpgpu_n_dwf_merged_warp_insn;
+      fprintf(fout, "gpgpu_n_dwf_fused_issue                     = %u\n", gpgpu_n_dwf_fused_issue);
+      fprintf(fout, "gpgpu_n_dwf_merged_warp_insn                = %u\n", gpgpu_n_dwf_merged_warp_insn);
+      fprintf(fout, "gpgpu_dwf_simd_efficiency_uncompacted       = %.4f\n",
+              gpgpu_n_dwf_warp_insn ? (float)gpgpu_n_dwf_thread_insn / ((float)gpgpu_n_dwf_warp_insn * m_config->warp_size) : 0.0f);
+      fprintf(fout, "gpgpu_dwf_simd_efficiency                   = %.4f\n",
+              slots ? (float)gpgpu_n_dwf_thread_insn / ((float)slots * m_config->warp_size) : 0.0f);
+   }
+
+   if (m_config->gpgpu_dual_issue_diff_exec_units) 
+      fprintf(fout, "gpgpu_n_dual_issue                          = %u\n", gpgpu_n_dual_issue);
+
+   if (gpgpu_n_bulk_copy) {
+      fprintf(fout, "gpgpu_n_bulk_copy                           = %u\n", gpgpu_n_bulk_copy);
+      fprintf(fout, "gpgpu_n_bulk_copy_bytes                     = %llu\n", gpgpu_n_bulk_copy_bytes);
+      fprintf(fout, "gpgpu_n_bulk_copy_req                       = %u\n", gpgpu_n_bulk_copy_req);
+   }
+
+   if (m_config->gpgpu_num_tensor_core_units) {
+      unsigned long long tensor_insn = 0, tensor_macs = 0;
+      for (unsigned i = 0; i < m_config->num_shader(); i++) {
+         tensor_insn += m_num_tensor_committed[i];
+         tensor_macs += m_num_tensor_acesses[i];
+      }
+      fprintf(fout, "gpgpu_n_tensor_insn                         = %llu\n", tensor_insn);
+      fprintf(fout, "gpgpu_n_tensor_mac                          = %llu\n", tensor_macs);
+   }
 
    fprintf(fout, "---------- Warp Occupancy Distribution: ---------\n");
    fprintf(fout, "(pipeline)Stall:%d     ", shader_cycle_distro[2]);
@@ -567,9 +664,6 @@ void shader_core_stats::visualizer_print( gzFile visualizer_file )
    gzprintf(visualizer_file, "\n");
 }
 
-#define PROGRAM_MEM_START 0xF0000000 /* should be distinct from other memory spaces... 
-                                        check ptx_ir.h to verify this does not overlap 
-                                        other memory spaces */
 void shader_core_ctx::decode() //-to get instruction from fetch_buffer(indeed in cuda-sim vector) decode it and send to the i_buffer of corresponding warp. [one warp]
 {
     if( m_inst_fetch_buffer.m_valid ) { // m_valid, mean instruction is return from L1I
@@ -601,17 +695,8 @@ void shader_core_ctx::decode() //-to get instruction from fetch_buffer(indeed in
     }
 }// decode()
  
-extern int g_prefetch_rec_max_size; //-declared here,used in :669,define and init in file"gpgpusim_entrypoint.cc:198 "
-extern int g_prefetch_interval ;       //-declared here,define and init in file"gpgpusim_entrypoint.cc:200 "
-extern int g_prefetch_length ;      //-declared here,define and init in file"gpgpusim_entrypoint.cc:201 "
-extern long g_prefetch_mem ;
-extern long g_prefetch ;
-extern long g_fetch ;               //-count the ori architecter access L1I;
-extern long g_fetch_stage_cycles;   //-count all cores cycles in fetch_stage;
-
 void shader_core_ctx::fetch()//-if Core buffer empty, get 16B from L1I. then drive L1I. L1I get data from dram.[one warp]
 {
-    g_fetch_stage_cycles++;
     if( !m_inst_fetch_buffer.m_valid ) {//- core i-buffer empty
         // find AN active warp with empty instruction buffer &&  is not waiting on a i-cache miss,
         //  get next 1-2 instructions from i-cache...
@@ -648,81 +733,38 @@ void shader_core_ctx::fetch()//-if Core buffer empty, get 16B from L1I. then dri
                 if( (offset_in_block + nbytes) > m_config->m_L1I_config.get_line_sz() )   //-if nbytes span 2 line,
                     nbytes = (m_config->m_L1I_config.get_line_sz() - offset_in_block);    // get data in first line .
                     
-                mem_access_t acc(INST_ACC_R,ppc,nbytes,false);//-new a access object( nbytes=16/8 ) .in heap
-                mem_fetch *mf = new mem_fetch(acc,
-                                              NULL/*we don't have an instruction yet*/,
-                                              READ_PACKET_SIZE,
-                                              warp_id,
-                                              m_sid,
-                                              m_tpc,
-                                              m_memory_config );//-new a mf. in heap
-                std::list<cache_event> events;  //-local vars.
-                enum cache_request_status status = m_L1I->access( (new_addr_type)ppc, mf, gpu_sim_cycle+gpu_tot_sim_cycle,events); //-visit L1I. in this func, mf->m_data_size modified from 16 to line_sz
-                g_fetch++; //-count system fetch ins .
-                //-printf(" <%3d> w[%d]  pc    =%u  status=%d ",mf->get_request_uid(), warp_id, pc, status);
+                // probe the tags first, a request is only needed to send a miss
+                enum cache_request_status status = m_L1I->probe_read( (new_addr_type)ppc, INST_ACC_R, nbytes, gpu_sim_cycle+gpu_tot_sim_cycle );
+                if( status == MISS ) {
+                    mem_access_t acc(INST_ACC_R,ppc,nbytes,false);
+                    mem_fetch *mf = new mem_fetch(acc,
+                                                  NULL/*we don't have an instruction yet*/,
+                                                  READ_PACKET_SIZE,
+                                                  warp_id,
+                                                  m_sid,
+                                                  m_tpc,
+                                                  m_memory_config );//-new a mf. in heap, deleted when it returns to L1I
+                    std::list<cache_event> events;  //-local vars.
+                    status = m_L1I->access( (new_addr_type)ppc, mf, gpu_sim_cycle+gpu_tot_sim_cycle,events); //-in this func, mf->m_data_size modified from 16 to line_sz
+                    assert( status == MISS );
+                }
+                m_iprefetcher->demand_access( warp_id, m_warp[warp_id].get_cta_id(), pc, m_config->m_L1I_config.block_addr(ppc), 
+                                              status, m_iprefetch_candidates );
                 
                 if( status == MISS ) {//-when return MISS,the mf has send to low level memory.
                     m_last_warp_fetched=warp_id;
                     m_warp[warp_id].set_imiss_pending();          //-this warp instrution miss,then run other warp,
                     m_warp[warp_id].set_last_fetch(gpu_sim_cycle);// and wait for it's instrution to back to L1I.
-                    //================-@@@ instruction pre-fetch next line. ===============================
-                    //================-@@@ instruction pre-fetch next line. ===============================
                 } else if( status == HIT ) {//-HIT
                     m_last_warp_fetched=warp_id;        //-nbytes=16 byte in default, NEVER USED?
                     m_inst_fetch_buffer = ifetch_buffer_t(pc,nbytes,warp_id);//-init a local structure(4 member vars),simulate get instructon data from L1I.
                     m_warp[warp_id].set_last_fetch(gpu_sim_cycle);
-                    delete mf;//-when instrution back to cache,  fill it to buffer. del the mf.
-                    //=====================================================================================
-                    //================-@@@ instruction pre-fetch next line. ===============================
-                    if(  offset_in_block >=0 && offset_in_block <16 ){ 
-                        new_addr_type cur_block_addr = ppc & ~(128-1); //- get cache_line head address.
-                        for(int r=1; r <= g_prefetch_length; r++){
-                            address_type prefetch_address = cur_block_addr + g_prefetch_interval*128 + r*128;//-p=addr
-                            bool is_prefetched;
-                            if(g_prefetch_rec_max_size > 0){//-check if this line is prefetched by previous or other warp
-                                is_prefetched = find( m_i_prefetch_pc.begin(), m_i_prefetch_pc.end(), prefetch_address ) 
-                                                    != m_i_prefetch_pc.end();
-                            }
-                            else is_prefetched =false;
-
-                            if( !is_prefetched ){ //- if this line not prefetched yet.
-                                 g_prefetch ++; //-record all prefetch.
-                                 mem_access_t   pre_acc(INST_ACC_R , prefetch_address ,16 ,false);//- +128,for next line.
-                                 mem_fetch      *pre_mf = new mem_fetch(pre_acc,
-                                                              NULL,
-                                                              READ_PACKET_SIZE,
-                                                              warp_id,
-                                                              m_sid,
-                                                              m_tpc,
-                                                              m_memory_config );//-new a mf. in heap
-                                 enum cache_request_status pre_status =        
-                                     m_L1I->access( (new_addr_type)(prefetch_address),pre_mf, gpu_sim_cycle+gpu_tot_sim_cycle,events);
-                                 //  printf("==>{%d} ppc[%x] w[%d] r[%d]nextpc=%u status=%d ",pre_mf->get_request_uid(),
-                                 //        warp_id, r, prefetch_address ,pre_status);
-                                 if( pre_status == HIT || pre_status ==  RESERVATION_FAIL) 
-                                     delete pre_mf; //-if MISS,mf will move to L2/dram,be delete automaticly when back.
-                                 else{ //- only count and record  prefetch requests that put to memory 
-                                     g_prefetch_mem ++; 
-                                     if(g_prefetch_rec_max_size > 0 ){
-                                         m_i_prefetch_pc.push_back( prefetch_address );//-record prefetched line in vector.
-                                         if(m_i_prefetch_pc.size() >= g_prefetch_rec_max_size)
-                                              m_i_prefetch_pc.pop_front(); //- only recored the recent n lines.
-                                     }
-                                 }
-                            }//- if (not fetched) 
-                        } //- for prefetch r times.
-                    } //- if (0<= address< 8 )    
-                   
-                    //=====================================================================================
-                    //================-@@@ instruction pre-fetch next line. ===============================
-
                 } else {//-RESERVATION FAIL
                     m_last_warp_fetched=warp_id;
                     assert( status == RESERVATION_FAIL );//-all mshr resource reserved,
-                    delete mf;                           // simply del the mf, and wait for next cycle and try.
+                                                         // wait for next cycle and try.
                 }// m_L1I->access() MISS/HIT/RESERVATION
-                
-                //printf("\n");                
+                issue_iprefetch(warp_id);
                 break;
             }//- if can access L1I
         }//-for
@@ -732,11 +774,38 @@ void shader_core_ctx::fetch()//-if Core buffer empty, get 16B from L1I. then dri
 
     if( m_L1I->access_ready() ) { //-if the MISS mf back from L2/Memory.
         mem_fetch *mf = m_L1I->next_access();//-the MISS mf return form L2 to L1I.
-        m_warp[mf->get_wid()].clear_imiss_pending();//-get I data, not pending now. In next cycle, fetch incs will HIT.
+        if( !m_iprefetcher->fill(mf) ) 
+            m_warp[mf->get_wid()].clear_imiss_pending();//-get I data, not pending now. In next cycle, fetch incs will HIT.
         delete mf; //-the MISS mf deleted here. all new--delete correspongding.
     }
 }
 
+// send the lines proposed by the L1I prefetcher for the last demand fetch of warp_id 
+void shader_core_ctx::issue_iprefetch( unsigned warp_id )
+{
+    for( unsigned r=0; r < m_iprefetch_candidates.size(); r++ ) {
+        new_addr_type line_addr = m_iprefetch_candidates[r];
+        if( m_iprefetcher->filter(line_addr) ) 
+            continue;
+        mem_fetch *mf = NULL;
+        enum cache_request_status status = m_L1I->probe_read( line_addr, INST_ACC_R, 16, gpu_sim_cycle+gpu_tot_sim_cycle );
+        if( status == MISS ) {
+            mem_access_t acc(INST_ACC_R,line_addr,16,false);
+            mf = new mem_fetch(acc,
+                               NULL,
+                               READ_PACKET_SIZE,
+                               warp_id,
+                               m_sid,
+                               m_tpc,
+                               m_memory_config ); //-moves to L2/dram, deleted when it returns to L1I
+            std::list<cache_event> events;
+            status = m_L1I->access( line_addr, mf, gpu_sim_cycle+gpu_tot_sim_cycle, events );
+            assert( status == MISS );
+        }
+        m_iprefetcher->issued( line_addr, mf, status );
+    }
+}
+
 void shader_core_ctx::func_exec_inst( warp_inst_t &inst )
 {
     execute_warp_inst_t(inst);//- call set_span();
@@ -744,7 +813,13 @@ void shader_core_ctx::func_exec_inst( warp_inst_t &inst )
         inst.generate_mem_accesses();
 }
 //SimtStack/scoreboard has been checked OK,
-void shader_core_ctx::issue_warp( register_set& pipe_reg_set, const warp_inst_t* next_inst, const active_mask_t &active_mask, unsigned warp_id )
+// instructions dynamic warp formation may issue together (SP/SFU pipelines only)
+static bool dwf_compactable( op_type op )
+{
+    return op == ALU_OP || op == SFU_OP || op == ALU_SFU_OP || op == BRANCH_OP;
+}
+
+warp_inst_t *shader_core_ctx::issue_warp( register_set& pipe_reg_set, const warp_inst_t* next_inst, const active_mask_t &active_mask, unsigned warp_id )
 {
     warp_inst_t** pipe_reg = pipe_reg_set.get_free();//return a pointer to a vector position(in this position is a pointer)
     assert(pipe_reg);
@@ -753,20 +828,65 @@ void shader_core_ctx::issue_warp( register_set& pipe_reg_set, const warp_inst_t*
     assert(next_inst->valid());
     **pipe_reg = *next_inst; //-fill a inst to the dest inst. static instruction information 
     (*pipe_reg)->issue( active_mask, warp_id, gpu_tot_sim_cycle + gpu_sim_cycle, m_warp[warp_id].get_dynamic_warp_id() ); // dynamic instruction information. // -inst.issue();
+    if( next_inst->op == TENSOR_CORE_OP && m_config->gpgpu_num_tensor_core_units > 0 ) 
+        m_config->tensor_core_timing( **pipe_reg );
     m_stats->shader_cycle_distro[2+(*pipe_reg)->active_count()]++;//- Wn means in this cycle, n threads is issued to pipeline. distro[0.1.2] has been occupied.
+    if( dwf_compactable(next_inst->op) ) {
+        m_stats->gpgpu_n_dwf_warp_insn++;
+        m_stats->gpgpu_n_dwf_thread_insn += (*pipe_reg)->active_count();
+    }
     func_exec_inst( **pipe_reg );
     if( next_inst->op == BARRIER_OP ) 
         m_barriers.warp_reaches_barrier(m_warp[warp_id].get_cta_id(),warp_id);
     else if( next_inst->op == MEMORY_BARRIER_OP ) 
         m_warp[warp_id].set_membar();
+    else if( next_inst->op == BULK_COPY_OP ) { // one copy per active thread, the warp does not exit before they arrive
+        m_barriers.bulk_copy_issued(m_warp[warp_id].get_cta_id(),next_inst->bulk_copy_barrier,(*pipe_reg)->active_count());
+        m_warp[warp_id].inc_bulk_copies((*pipe_reg)->active_count());
+    }
+    else if( next_inst->op == BULK_COPY_WAIT_OP ) 
+        m_barriers.warp_waits_bulk_copy(m_warp[warp_id].get_cta_id(),warp_id,next_inst->bulk_copy_barrier);
 
     updateSIMTStack(warp_id,*pipe_reg);// update simt stack.
     m_scoreboard->reserveRegisters(*pipe_reg);// add  inst->out[4] to score_board
     m_warp[warp_id].set_next_pc(next_inst->pc + next_inst->isize);
     //printf("[@@@@] sid=%d ,warp_id=%d , pc=%d,isize=%d\n",m_sid, warp_id,next_inst->pc, next_inst->isize);// cjllean
-
+    return *pipe_reg;
 }// issue_warp()
 
+// issue a warp inside the pipeline slot of 'leader' (dynamic warp formation):
+// it executes and reserves its registers now and retires when the leader does
+void shader_core_ctx::issue_compacted_warp( const warp_inst_t &leader, const warp_inst_t *next_inst, const active_mask_t &active_mask, unsigned warp_id )
+{
+    warp_inst_t *inst = new warp_inst_t(*next_inst);
+    m_warp[warp_id].ibuffer_free();
+    inst->issue( active_mask, warp_id, gpu_tot_sim_cycle + gpu_sim_cycle, m_warp[warp_id].get_dynamic_warp_id() );
+    m_stats->shader_cycle_distro[2+inst->active_count()]++;
+    m_stats->gpgpu_n_dwf_warp_insn++;
+    m_stats->gpgpu_n_dwf_thread_insn += inst->active_count();
+    m_stats->gpgpu_n_dwf_merged_warp_insn++;
+    func_exec_inst( *inst );
+    updateSIMTStack(warp_id,inst);
+    m_scoreboard->reserveRegisters(inst);
+    m_warp[warp_id].set_next_pc(next_inst->pc + next_inst->isize);
+    m_compacted_warps[leader.get_uid()].push_back(inst);
+}
+
+void shader_core_ctx::retire_compacted_warps( const warp_inst_t &leader )
+{
+    std::map<unsigned,std::vector<warp_inst_t*> >::iterator c = m_compacted_warps.find(leader.get_uid());
+    if( c == m_compacted_warps.end() )
+        return;
+    for( unsigned i = 0; i < c->second.size(); i++ ) {
+        warp_inst_t *inst = c->second[i];
+        m_scoreboard->releaseRegisters( inst );
+        m_warp[inst->warp_id()].dec_inst_in_pipeline();
+        warp_inst_complete(*inst);
+        delete inst;
+    }
+    m_compacted_warps.erase(c);
+}
+
 void shader_core_ctx::issue(){
     //really is issue;
     for (unsigned i = 0; i < schedulers.size(); i++) {// -2 schedulers in fermi.
@@ -778,6 +898,48 @@ shd_warp_t& scheduler_unit::warp(int i){
     return (*m_warp)[i];
 }
 
+// Dynamic warp formation: warps of the leader's CTA that wait at the same PC
+// with active lanes disjoint from the lanes issued so far ride in the same
+// SP/SFU slot.  Threads keep their home lane, so the register file needs no
+// crossbar; a warp that would collide on a lane stays behind.
+void scheduler_unit::compact_warps( const warp_inst_t *leader, const warp_inst_t *pI )
+{
+    unsigned max_warps = m_shader->get_config()->gpgpu_dwf_max_warps;
+    if( max_warps <= 1 || !dwf_compactable(pI->op) )
+        return;
+    active_mask_t lanes = leader->get_active_mask();
+    unsigned cta_id = warp(leader->warp_id()).get_cta_id();
+    unsigned fused = 1;
+    for( std::vector<shd_warp_t*>::const_iterator w = m_supervised_warps.begin();
+         w != m_supervised_warps.end() && fused < max_warps && !lanes.all(); ++w ) {
+        shd_warp_t *cand = *w;
+        if( cand == NULL || cand->done_exit() )
+            continue;
+        unsigned wid = cand->get_warp_id();
+        if( wid == leader->warp_id() || cand->get_cta_id() != cta_id )
+            continue;
+        if( cand->waiting() || cand->ibuffer_empty() || !cand->ibuffer_next_valid() )
+            continue;
+        const warp_inst_t *cI = cand->ibuffer_next_inst();
+        if( cI == NULL || cI->pc != pI->pc )
+            continue;
+        unsigned pc,rpc;
+        m_simt_stack[wid]->get_pdom_stack_top_info(&pc,&rpc);
+        if( pc != pI->pc || m_scoreboard->checkCollision(wid, cI) )
+            continue;
+        const active_mask_t &mask = m_simt_stack[wid]->get_active_mask();
+        if( (mask & lanes).any() )
+            continue;
+        lanes |= mask;
+        m_shader->issue_compacted_warp( *leader, cI, mask, wid );
+        m_stats->event_warp_issued( m_shader->get_sid(), wid, 1, cand->get_dynamic_warp_id() );
+        cand->ibuffer_step(); // as do_on_warp_issued() does for the leader
+        fused++;
+    }
+    if( fused > 1 )
+        m_stats->gpgpu_n_dwf_fused_issue++;
+}
+
 
 /**
  * A general function to order things in a Loose Round Robin way. The simplist use of this
@@ -874,24 +1036,37 @@ void scheduler_unit::cycle()    //-Core not issue a insn in every cycle.So the w
     bool ready_inst  = false;  // of the valid instructions, there was one not waiting for pending register writes
     bool issued_inst = false; // of these we issued one
 
+    // with dual issue the scheduler may issue a second instruction, from the same
+    // or another warp, as long as it goes to a different unit type than the first
+    enum { ISSUED_SP = 1, ISSUED_SFU = 2, ISSUED_MEM = 4 };
+    const bool dual_issue = m_shader->m_config->gpgpu_dual_issue_diff_exec_units;
+    const unsigned max_sched_issue = dual_issue ? 2 : m_shader->m_config->gpgpu_max_insn_issue_per_warp;
+    unsigned issued_units = 0; // unit types taken this cycle, only tracked with dual issue
+    unsigned sched_issued = 0; // instructions issued by earlier warps this cycle
+
     order_warps();//-put the ordered <T> in m_next_cycle_prioritized_warp
 
-    for ( std::vector< shd_warp_t* >::const_iterator iter = m_next_cycle_prioritized_warps.begin();
-          iter != m_next_cycle_prioritized_warps.end();
-          iter++ ) {//-check all warps or break at line 954
+    warp_set_t tested; // warps looked at this cycle
+    for ( int n = 0; n < (int)m_next_cycle_prioritized_warps.size(); n++ ) {//-check all warps or break at line 954
+        std::vector< shd_warp_t* >::const_iterator iter = m_next_cycle_prioritized_warps.begin() + n;
         // Don't consider warps that are not yet valid
         if ( (*iter) == NULL || (*iter)->done_exit() ) { //-skip warps without init().[NULL is not exict]
             continue;
         }
+        shd_warp_t *const cur_warp = *iter;
+        unsigned  warp_id   = (*iter)->get_warp_id(); //-get the warp id to issued.
+        if( tested.test(warp_id) ) 
+            continue;
+        tested.set(warp_id);
         SCHED_DPRINTF( "Testing (warp_id %u, dynamic_warp_id %u)\n",
                        (*iter)->get_warp_id(), (*iter)->get_dynamic_warp_id() );
-        unsigned  warp_id   = (*iter)->get_warp_id(); //-get the warp id to issued.
         unsigned  checked   = 0;// number of inst checked = times to step into while{} below
         unsigned  issued    = 0;// number of inst issued(checked and result is valid) <= checked.
         unsigned  max_issue = m_shader->m_config->gpgpu_max_insn_issue_per_warp;// 1 in fermi 
         //-check if this warp can be issue.  waiting() func skip warp stuked in WB stage,or in a bar
         while( !warp(warp_id).waiting() && !warp(warp_id).ibuffer_empty() && 
-               (checked < max_issue) && (issued < max_issue) && (checked <= issued) ) {//-check once for a warp in Fermi.
+               (checked < max_issue) && (issued < max_issue) && (checked <= issued) &&
+               (sched_issued + issued < max_sched_issue) ) {//-check once for a warp in Fermi.
             const warp_inst_t  *pI = warp(warp_id).ibuffer_next_inst();//get next inst.
             bool                valid = warp(warp_id).ibuffer_next_valid();
             bool                warp_inst_issued = false;
@@ -916,28 +1091,34 @@ void scheduler_unit::cycle()    //-Core not issue a insn in every cycle.So the w
                         ready_inst = true;//-[2] ,  not reg collision.
                         const active_mask_t &active_mask = m_simt_stack[warp_id]->get_active_mask();
                         assert( warp(warp_id).inst_in_pipeline() );
-                        if ( (pI->op == LOAD_OP) || (pI->op == STORE_OP) || (pI->op == MEMORY_BARRIER_OP) ) {
-                            if( m_mem_out->has_free() ) {// reg_set * m_mem_out 
+                        if ( (pI->op == LOAD_OP) || (pI->op == STORE_OP) || (pI->op == MEMORY_BARRIER_OP) || (pI->op == BULK_COPY_OP) ) {
+                            if( m_mem_out->has_free() && !(issued_units & ISSUED_MEM) ) {// reg_set * m_mem_out 
                                 m_shader->issue_warp(*m_mem_out,pI,active_mask,warp_id);//-issue a inst to ls/st unit ---
                                 issued++;                                       //-issue_warp() call update simt stack---
                                 issued_inst=true;//-[3]
                                 warp_inst_issued = true;
+                                if( dual_issue ) 
+                                    issued_units |= ISSUED_MEM;
                             }
                         } else {
-                            bool sp_pipe_avail = m_sp_out->has_free();
-                            bool sfu_pipe_avail = m_sfu_out->has_free();
+                            bool sp_pipe_avail = m_sp_out->has_free() && !(issued_units & ISSUED_SP);
+                            bool sfu_pipe_avail = m_sfu_out->has_free() && !(issued_units & ISSUED_SFU);
                             if( sp_pipe_avail && (pI->op != SFU_OP) ) {
                                 // always prefer SP pipe for operations that can use both SP and SFU pipelines
-                                m_shader->issue_warp(*m_sp_out,pI,active_mask,warp_id);//-issue to sp unit --------------
+                                compact_warps( m_shader->issue_warp(*m_sp_out,pI,active_mask,warp_id), pI );//-issue to sp unit --------------
                                 issued++;
                                 issued_inst=true;//-[3]
                                 warp_inst_issued = true;
+                                if( dual_issue ) 
+                                    issued_units |= ISSUED_SP;
                             } else if ( (pI->op == SFU_OP) || (pI->op == ALU_SFU_OP) ) {
                                 if( sfu_pipe_avail ) {
-                                    m_shader->issue_warp(*m_sfu_out,pI,active_mask,warp_id);//- issue to sfu ------------
+                                    compact_warps( m_shader->issue_warp(*m_sfu_out,pI,active_mask,warp_id), pI );//- issue to sfu ------------
                                     issued++;
                                     issued_inst=true;//-[3]-
                                     warp_inst_issued = true;
+                                    if( dual_issue ) 
+                                        issued_units |= ISSUED_SFU;
                                 }
                             } 
                         }
@@ -959,11 +1140,18 @@ void scheduler_unit::cycle()    //-Core not issue a insn in every cycle.So the w
                                (*iter)->get_dynamic_warp_id(),
                                issued );
                 do_on_warp_issued( warp_id, issued, iter );// i_buffer pointer move to next.
+                // do_on_warp_issued() may have reordered the list, point back at the issued warp
+                iter = std::find( m_next_cycle_prioritized_warps.begin(), m_next_cycle_prioritized_warps.end(), cur_warp );
+                assert( iter != m_next_cycle_prioritized_warps.end() );
             }
             checked++;
         }// while
     
-        if ( issued ) {
+        if ( issued && sched_issued ) {
+            // second warp of a dual issue cycle, the first one keeps the priority
+            sched_issued += issued;
+            break;
+        } else if ( issued ) {
             // This might be a bit inefficient, but we need to maintain
             // two ordered list for proper scheduler execution.
             // We could remove the need for this loop by associating a
@@ -972,7 +1160,7 @@ void scheduler_unit::cycle()    //-Core not issue a insn in every cycle.So the w
             for ( std::vector< shd_warp_t* >::const_iterator supervised_iter = m_supervised_warps.begin();
                   supervised_iter != m_supervised_warps.end();
                   ++supervised_iter ) {
-                if ( *iter == *supervised_iter ) {
+                if ( cur_warp == *supervised_iter ) {
                     /*if(m_last_supervised_issued == supervised_iter)
                         printf("[@@@]{%2d}gto use, no switch (%lld)\n",warp_id,gpu_sim_cycle);
                     else 
@@ -980,10 +1168,18 @@ void scheduler_unit::cycle()    //-Core not issue a insn in every cycle.So the w
                     m_last_supervised_issued = supervised_iter;//-find the issued warp, and record it.
                 }
             }
-            break;// go out of for{}. only issue a warp in one call. 
+            sched_issued = issued;
+            if ( sched_issued >= max_sched_issue || !dual_issue )
+                break;// go out of for{}. only issue a warp in one call. 
+            // do_on_warp_issued() may have reordered the list (two level scheduler), so look for
+            // the second warp from the top again, the warps tested already are skipped
+            n = -1;
         }// if 
     }// for(every warp ) line:810
 
+    if( sched_issued > 1 ) 
+        m_stats->gpgpu_n_dual_issue++;
+
     // issue stall statistics, after trace all warps. whether is issued or not.
     if( !valid_inst ) 
         m_stats->shader_cycle_distro[0]++; // idle or control hazard                            "W0_Idle"
@@ -1160,7 +1356,9 @@ unsigned shader_core_ctx::translate_local_memaddr( address_type localaddr, unsig
 
    address_type thread_base = 0;
    unsigned max_concurrent_threads=0;
-   if (m_config->gpgpu_local_mem_map) {
+   // CTAs of different kernels on one core have different sizes, so the 
+   // per-CTA mapping below only applies when cores are not shared
+   if (m_config->gpgpu_local_mem_map && !m_gpu->shares_cores()) {
       // Dnew = D*N + T%nTpC + nTpC*C
       // N = nTpC*nCpS*nS (max concurent threads)
       // C = nS*K + S (hw cta number per gpu)
@@ -1231,7 +1429,7 @@ void shader_core_ctx::execute()
             m_fu[n]->cycle();
         m_fu[n]->active_lanes_in_pipeline();
         enum pipeline_stage_name_t issue_port = m_issue_port[n];
-        register_set& issue_inst = m_pipeline_reg[ issue_port ];
+        register_set& issue_inst = *pipeline_reg( issue_port, m_fu_sub_core[n] );
     	warp_inst_t** ready_reg = issue_inst.get_ready();//-get the ready inst for issue.
         if( issue_inst.has_ready() && m_fu[n]->can_issue( **ready_reg ) ) {
             bool schedule_wb_now = !m_fu[n]->stallable();//-ture for ldst/ faluse for simd_unit
@@ -1291,6 +1489,8 @@ void shader_core_ctx::warp_inst_complete(const warp_inst_t &inst)
 	  m_stats->m_num_sfu_committed[m_sid]++;
   else if(inst.op_pipe==MEM__OP)
 	  m_stats->m_num_mem_committed[m_sid]++;
+  else if(inst.op_pipe==TENSOR__OP)
+	  m_stats->m_num_tensor_committed[m_sid]++;
 
   if(m_config->gpgpu_clock_gated_lanes==false)
 	  m_stats->m_num_sim_insn[m_sid] += m_config->warp_size;
@@ -1299,6 +1499,7 @@ void shader_core_ctx::warp_inst_complete(const warp_inst_t &inst)
 
   m_stats->m_num_sim_winsn[m_sid]++;
   m_gpu->gpu_sim_insn += inst.active_count(); // all active thread in this warp finish a insn.[1..32]
+  m_cta_resource[m_warp[inst.warp_id()].get_cta_id()].kernel->inc_sim_insn(inst.active_count());
   inst.completed(gpu_tot_sim_cycle + gpu_sim_cycle);
 }
 
@@ -1335,6 +1536,7 @@ void shader_core_ctx::writeback()
         m_scoreboard->releaseRegisters( pipe_reg );//score board.releaseReg()
         m_warp[warp_id].dec_inst_in_pipeline();
         warp_inst_complete(*pipe_reg);
+        retire_compacted_warps(*pipe_reg);
         m_gpu->gpu_sim_insn_last_update_sid = m_sid;
         m_gpu->gpu_sim_insn_last_update = gpu_sim_cycle;
         m_last_inst_gpu_sim_cycle = gpu_sim_cycle;
@@ -1410,9 +1612,15 @@ mem_stage_stall_type ldst_unit::process_memory_access_queue( cache_t *cache, war
     if( !cache->data_port_free() ) 
         return DATA_PORT_STALL; 
 
-    //const mem_access_t &access = inst.accessq_back();
-    mem_fetch *mf = m_mf_allocator->alloc(inst,inst.accessq_back()); // copy a pointer of  mf form tail of accessQ of inst.
+    const mem_access_t &access = inst.accessq_back();
     std::list<cache_event> events;// list< cache_event >
+    if( !access.is_write() && !inst.isatomic() ) {
+        // loads that hit (or cannot be accepted this cycle) are resolved without a mem_fetch
+        enum cache_request_status status = cache->probe_read(access.get_addr(),access.get_type(),access.get_size(),gpu_sim_cycle+gpu_tot_sim_cycle);
+        if( status != MISS ) 
+            return process_cache_access( cache, access.get_addr(), inst, events, NULL, status );
+    }
+    mem_fetch *mf = m_mf_allocator->alloc(inst,access); // copy a pointer of  mf form tail of accessQ of inst.
     enum cache_request_status status = cache->access(mf->get_addr(),mf,gpu_sim_cycle+gpu_tot_sim_cycle,events);//-modify cache
     //cjllean@L1 cache	
     /* int tp=mf->get_access_type(); 
@@ -1468,6 +1676,13 @@ bool ldst_unit::memory_cycle( warp_inst_t &inst, mem_stage_stall_type &stall_rea
    mem_stage_stall_type stall_cond = NO_RC_FAIL;
    const mem_access_t &access = inst.accessq_back();
 
+   if( m_tlb && m_tlb->access(access.get_addr()) != TLB_HIT ) {
+       // wait for the translation of this access' page
+       stall_reason = TLB_STALL;
+       access_type = inst.space.is_local()? (inst.is_store()?L_MEM_ST:L_MEM_LD) : (inst.is_store()?G_MEM_ST:G_MEM_LD);
+       return false;
+   }
+
    bool bypassL1D = false; 
    if ( CACHE_GLOBAL == inst.cache_op || (m_L1D == NULL) ) {
        bypassL1D = true; 
@@ -1512,6 +1727,85 @@ bool ldst_unit::memory_cycle( warp_inst_t &inst, mem_stage_stall_type &stall_rea
    return inst.accessq_empty(); 
 }
 
+// hand the copies of a dispatched cp.async.bulk over to the bulk copy engine;
+// the instruction leaves the pipeline once all of them are queued
+bool ldst_unit::bulk_copy_cycle( warp_inst_t &inst, mem_stage_stall_type &stall_reason, mem_stage_access_type &access_type )
+{
+   if( inst.empty() || inst.op != BULK_COPY_OP ) 
+       return true;
+   for( ; m_bulk_copy_lane < m_config->warp_size; m_bulk_copy_lane++ ) {
+       if( !inst.active(m_bulk_copy_lane) ) 
+           continue;
+       if( m_bulk_copies.size() >= m_config->gpgpu_bulk_copy_queue_size ) {
+           stall_reason = COAL_STALL;
+           access_type = G_MEM_LD;
+           return false;
+       }
+       bulk_copy_t copy;
+       copy.inst = inst;
+       copy.lane = m_bulk_copy_lane;
+       copy.next_addr = inst.get_addr(m_bulk_copy_lane);
+       copy.end_addr = copy.next_addr + inst.data_size;
+       copy.outstanding = 0;
+       m_bulk_copies.push_back(copy);
+       m_stats->gpgpu_n_bulk_copy++;
+       m_stats->gpgpu_n_bulk_copy_bytes += inst.data_size;
+   }
+   m_bulk_copy_lane = 0;
+   return true;
+}
+
+// send at most one read per cycle for the oldest copy with data left to request,
+// covering the 32B sectors of one 128B block
+void ldst_unit::bulk_copy_stream()
+{
+   const unsigned block_size = 128;
+   const unsigned sector_size = 32;
+   std::list<bulk_copy_t>::iterator c;
+   for( c=m_bulk_copies.begin(); c != m_bulk_copies.end(); ++c ) 
+       if( c->next_addr < c->end_addr ) 
+           break;
+   if( c == m_bulk_copies.end() ) 
+       return;
+
+   new_addr_type block = c->next_addr & ~(new_addr_type)(block_size-1);
+   new_addr_type end = gs_min2( block + block_size, c->end_addr );
+   new_addr_type addr = c->next_addr & ~(new_addr_type)(sector_size-1);
+   unsigned size = ((end - addr + sector_size - 1) / sector_size) * sector_size;
+   if( m_tlb && m_tlb->access(addr) != TLB_HIT ) 
+       return;
+   if( m_icnt->full(size + READ_PACKET_SIZE, false) ) 
+       return;
+
+   active_mask_t lane;
+   lane.set(c->lane);
+   mem_access_byte_mask_t bytes;
+   for( new_addr_type a = c->next_addr; a < end; a++ ) 
+       bytes.set(a - block);
+   mem_access_t access( GLOBAL_ACC_R, addr, size, false, lane, bytes );
+   m_icnt->push( m_mf_allocator->alloc(c->inst, access) );
+   m_stats->gpgpu_n_bulk_copy_req++;
+   c->next_addr = end;
+   c->outstanding++;
+}
+
+// data of a bulk copy request is written to shared memory; the copy arrives 
+// on its barrier with its last request
+void ldst_unit::bulk_copy_fill( mem_fetch *mf )
+{
+   const active_mask_t &lane = mf->get_access_warp_mask();
+   std::list<bulk_copy_t>::iterator c;
+   for( c=m_bulk_copies.begin(); c != m_bulk_copies.end(); ++c ) 
+       if( c->inst.get_uid() == mf->get_inst().get_uid() && lane.test(c->lane) ) 
+           break;
+   assert( c != m_bulk_copies.end() && c->outstanding > 0 );
+   c->outstanding--;
+   if( !c->outstanding && c->next_addr >= c->end_addr ) {
+       m_core->bulk_copy_arrive( c->inst.warp_id(), c->inst.bulk_copy_barrier );
+       m_bulk_copies.erase(c);
+   }
+}
+
 
 bool ldst_unit::response_buffer_full() const
 {
@@ -1552,6 +1846,27 @@ void sfu::issue( register_set& source_reg )
 	pipelined_simd_unit::issue(source_reg);
 }
 
+tensor_core::tensor_core( register_set* result_port, const shader_core_config *config, shader_core_ctx *core )
+    : pipelined_simd_unit(result_port,config,config->max_tensor_core_latency,core)
+{ 
+    m_name = "TC "; 
+}
+
+void tensor_core::issue( register_set& source_reg )
+{
+    warp_inst_t** ready_reg = source_reg.get_ready();
+	(*ready_reg)->op_pipe=TENSOR__OP;
+	m_core->inctensor_stat((*ready_reg)->mma_m*(*ready_reg)->mma_n*(*ready_reg)->mma_k);
+	pipelined_simd_unit::issue(source_reg);
+}
+
+void tensor_core::active_lanes_in_pipeline(){
+	unsigned active_count=pipelined_simd_unit::get_active_lanes_in_pipeline();
+	assert(active_count<=m_core->get_config()->warp_size);
+	m_core->incfuactivelanes_stat(active_count);
+	m_core->incfumemactivelanes_stat(active_count);
+}
+
 void ldst_unit::active_lanes_in_pipeline(){
 	unsigned active_count=pipelined_simd_unit::get_active_lanes_in_pipeline();
 	assert(active_count<=m_core->get_config()->warp_size);
@@ -1579,6 +1894,19 @@ sp_unit::sp_unit( register_set* result_port, const shader_core_config *config,sh
     m_name = "SP "; 
 }
 
+bool sp_unit::can_issue( const warp_inst_t &inst ) const
+{
+    switch(inst.op) {
+    case SFU_OP: return false; 
+    case LOAD_OP: return false;
+    case STORE_OP: return false;
+    case MEMORY_BARRIER_OP: return false;
+    case TENSOR_CORE_OP: if( m_config->gpgpu_num_tensor_core_units > 0 ) return false; break;
+    default: break;
+    }
+    return pipelined_simd_unit::can_issue(inst);
+}
+
 void sp_unit :: issue(register_set& source_reg)
 {
     warp_inst_t** ready_reg = source_reg.get_ready(); // a pointer to a inst
@@ -1647,10 +1975,17 @@ void ldst_unit::init( mem_fetch_interface *icnt,
     m_L1T = new tex_cache(L1T_name,m_config->m_L1T_config,m_sid,get_shader_texture_cache_id(),icnt,IN_L1T_MISS_QUEUE,IN_SHADER_L1T_ROB);
     m_L1C = new read_only_cache(L1C_name,m_config->m_L1C_config,m_sid,get_shader_constant_cache_id(),icnt,IN_L1C_MISS_QUEUE);
     m_L1D = NULL;
+    m_tlb = NULL;
+    if (core->get_gpu()->get_mmu()) {
+        gpu_mmu *mmu = core->get_gpu()->get_mmu();
+        m_tlb = new l1_tlb(mmu->get_config(), m_sid, mmu);
+    }
     m_mem_rc = NO_RC_FAIL;
     m_num_writeback_clients=5; // = shared memory, global/local (uncached), L1D, L1T, L1C
     m_writeback_arb = 0;
     m_next_global=NULL;
+    m_bulk_copy_lane=0;
+    assert( m_config->gpgpu_bulk_copy_queue_size > 0 );
     m_last_inst_gpu_sim_cycle=0;
     m_last_inst_gpu_tot_sim_cycle=0;
 }
@@ -1868,7 +2203,13 @@ void ldst_unit::cycle()
 
    if( !m_response_fifo.empty() ) {
        mem_fetch *mf = m_response_fifo.front();// get form head, test if it can be sent to L1 Cache.
-       if (mf->istexture()) {
+       if (mf->get_inst().op == BULK_COPY_OP) {
+           // bulk copy data goes straight to shared memory
+           mf->set_status(IN_SHADER_FETCHED,gpu_sim_cycle+gpu_tot_sim_cycle);
+           bulk_copy_fill(mf);
+           m_response_fifo.pop_front();
+           delete mf;
+       } else if (mf->istexture()) {
            if (m_L1T->fill_port_free()) {
                m_L1T->fill(mf,gpu_sim_cycle+gpu_tot_sim_cycle);
                m_response_fifo.pop_front();// put in cache, del from ldst fifo. 
@@ -1913,6 +2254,7 @@ void ldst_unit::cycle()
    m_L1T->cycle();
    m_L1C->cycle();
    if( m_L1D ) m_L1D->cycle();
+   bulk_copy_stream();
 
    warp_inst_t &pipe_reg = *m_dispatch_reg;
    enum mem_stage_stall_type rc_fail = NO_RC_FAIL;
@@ -1922,6 +2264,7 @@ void ldst_unit::cycle()
    done &= constant_cycle(pipe_reg, rc_fail, type);
    done &= texture_cycle(pipe_reg, rc_fail, type);
    done &= memory_cycle(pipe_reg, rc_fail, type);
+   done &= bulk_copy_cycle(pipe_reg, rc_fail, type);
    m_mem_rc = rc_fail;
 
    if (!done) { // log stall types and return
@@ -1969,7 +2312,7 @@ void ldst_unit::cycle()
                m_dispatch_reg->clear();
            }
        } else {
-           // stores exit pipeline here
+           // stores and bulk copies exit pipeline here
            m_core->dec_inst_in_pipeline(warp_id);
            m_core->warp_inst_complete(*m_dispatch_reg);
            m_dispatch_reg->clear();
@@ -1982,28 +2325,100 @@ void shader_core_ctx::register_cta_thread_exit( unsigned cta_num )
    assert( m_cta_status[cta_num] > 0 );
    m_cta_status[cta_num]--; //-threads num of this CTA -1;
    if (!m_cta_status[cta_num]) {//- m_cta_status[cta_num] == 0, all warps in this CTA is finished.
+      kernel_info_t *kernel = m_cta_resource[cta_num].kernel;
+      assert( kernel != NULL );
+      m_gpu->cta_done( kernel, m_cta_resource[cta_num].threads / m_config->warp_size );
+      m_cta_resource[cta_num].kernel = NULL;
       m_n_active_cta--;
       m_barriers.deallocate_barrier(cta_num);
       shader_CTA_count_unlog(m_sid, 1);
       printf("GPGPU-Sim uArch: Shader %d finished CTA #%d (%lld,%lld), %u CTAs running\n", m_sid, cta_num, gpu_sim_cycle, gpu_tot_sim_cycle,
              m_n_active_cta );//- this CTA is finished.
-      if( m_n_active_cta == 0 ) {//-all CTAs in THIS core is 0, mean Kernel finished in THIS core.
-          assert( m_kernel != NULL );
-          m_kernel->dec_running(); //-Cores run this Kernel -1.
-          printf("GPGPU-Sim uArch: Shader %u empty (release kernel %u \'%s\').\n", m_sid, m_kernel->get_uid(),
-                 m_kernel->name().c_str() );
-          if( m_kernel->no_more_ctas_to_run() ) {// all CTAs of this Kernel is finished. kernel done.
-              if( !m_kernel->running() ) {
-                  printf("GPGPU-Sim uArch: GPU detected kernel \'%s\' finished on shader %u.\n", m_kernel->name().c_str(), m_sid );
-                  m_gpu->set_kernel_done( m_kernel );
+      if( n_resident_ctas(kernel) == 0 ) {//-no CTA of this kernel left on THIS core (the whole core when it is not shared).
+          kernel->dec_running(); //-Cores run this Kernel -1.
+          printf("GPGPU-Sim uArch: Shader %u %s (release kernel %u \'%s\').\n", m_sid, m_n_active_cta? "shared" : "empty", 
+                 kernel->get_uid(), kernel->name().c_str() );
+          if( kernel->no_more_ctas_to_run() ) {// all CTAs of this Kernel is finished. kernel done.
+              if( !kernel->running() ) {
+                  printf("GPGPU-Sim uArch: GPU detected kernel \'%s\' finished on shader %u.\n", kernel->name().c_str(), m_sid );
+                  m_gpu->set_kernel_done( kernel );
               }
           }
-          m_kernel=NULL;
+          if( m_kernel == kernel ) 
+              m_kernel=NULL;
           fflush(stdout);
       }
    } //-if m_cta_status[cta_num] == 0 
 }
 
+unsigned shader_core_ctx::n_resident_ctas( const kernel_info_t *kernel ) const
+{
+   unsigned n = 0;
+   for (unsigned i=0; i < MAX_CTA_PER_SHADER; i++) 
+      if( m_cta_resource[i].kernel == kernel ) 
+         n++;
+   return n;
+}
+
+unsigned shader_core_ctx::find_free_threads( unsigned padded_cta_size ) const
+{
+   // first fit over warp aligned hardware thread ranges not held by a resident CTA
+   for (unsigned start=0; start + padded_cta_size <= m_config->n_thread_per_shader; start += m_config->warp_size) {
+      bool overlap = false;
+      for (unsigned i=0; i < MAX_CTA_PER_SHADER && !overlap; i++) {
+         const cta_resource_t &r = m_cta_resource[i];
+         if( r.kernel && start < r.start_thread + r.threads && r.start_thread < start + padded_cta_size ) 
+            overlap = true;
+      }
+      if( !overlap ) 
+         return start;
+   }
+   return (unsigned)-1;
+}
+
+bool shader_core_ctx::can_issue_shared_cta( const kernel_info_t &kernel, unsigned n_sharing ) const
+{
+   // every kernel with CTAs left gets 1/n_sharing of each core resource; a 
+   // kernel may always place its first CTA so that it cannot be starved
+   if( m_n_active_cta >= m_config->max_cta_per_core || m_n_active_cta >= MAX_CTA_PER_SHADER ) 
+      return false;
+   unsigned padded_cta_size = kernel.threads_per_cta();
+   if (padded_cta_size % m_config->warp_size) 
+      padded_cta_size = ((padded_cta_size/m_config->warp_size)+1)*(m_config->warp_size);
+   const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(kernel.entry());
+   unsigned regs = padded_cta_size * ((kernel_info->regs+3)&~3);
+   unsigned smem = kernel_info->smem;
+
+   unsigned used_threads = 0, used_regs = 0, used_smem = 0;
+   unsigned k_ctas = 0, k_threads = 0, k_regs = 0, k_smem = 0;
+   for (unsigned i=0; i < MAX_CTA_PER_SHADER; i++) {
+      const cta_resource_t &r = m_cta_resource[i];
+      if( !r.kernel ) 
+         continue;
+      used_threads += r.threads;
+      used_regs += r.regs;
+      used_smem += r.smem;
+      if( r.kernel == &kernel ) {
+         k_ctas++;
+         k_threads += r.threads;
+         k_regs += r.regs;
+         k_smem += r.smem;
+      }
+   }
+   if( used_threads + padded_cta_size > m_config->n_thread_per_shader ||
+       used_regs + regs > m_config->gpgpu_shader_registers ||
+       used_smem + smem > m_config->gpgpu_shmem_size ) 
+      return false;
+   if( k_ctas > 0 && n_sharing > 1 ) {
+      if( (k_threads + padded_cta_size) * n_sharing > m_config->n_thread_per_shader ||
+          (k_regs + regs) * n_sharing > m_config->gpgpu_shader_registers ||
+          (k_smem + smem) * n_sharing > m_config->gpgpu_shmem_size ||
+          (k_ctas + 1) * n_sharing > m_config->max_cta_per_core ) 
+         return false;
+   }
+   return find_free_threads(padded_cta_size) != (unsigned)-1;
+}
+
 void gpgpu_sim::shader_print_runtime_stat( FILE *fout ) 
 {
     /*
@@ -2090,6 +2505,14 @@ void gpgpu_sim::shader_print_cache_stats( FILE *fout ) const{
         printf("\n");
         fprintf(fout, "\tL1I_total_cache_pending_hits      = %u\n", total_css.pending_hits);
         fprintf(fout, "\tL1I_total_cache_reservation_fails = %u  (not include in accesses)\n", total_css.res_fails);
+
+        if( m_shader_config->m_iprefetch_config.enabled() ) {
+            ifetch_prefetcher_stats total_ips;
+            fprintf(fout, "L1I_prefetcher: %s\n", m_shader_config->m_iprefetch_config.m_policy_string);
+            for ( unsigned i = 0; i < m_shader_config->n_simt_clusters; ++i ) 
+                m_cluster[i]->print_iprefetch_stats(fout, total_ips);
+            total_ips.print(fout, "L1I_prefetch_total");
+        }
     }
 
     // L1D
@@ -2286,6 +2709,9 @@ void shader_core_ctx::incexecstat(warp_inst_t *&inst)
 void shader_core_ctx::print_stage(unsigned int stage, FILE *fout ) const
 {
    m_pipeline_reg[stage].print(fout);// print again in 'dp' command.
+   if( sub_core_stage((pipeline_stage_name_t)stage) ) 
+      for( unsigned i=stage; i < m_sub_core_reg.size(); i+=N_PIPELINE_STAGES ) 
+         m_sub_core_reg[i].print(fout);
 }
 
 void shader_core_ctx::display_simt_state(FILE *fout, int mask ) const
@@ -2624,6 +3050,166 @@ unsigned int shader_core_config::max_cta( const kernel_info_t &k ) const
     return result;
 }
 
+void shader_core_config::init_carveouts()
+{
+   m_shmem_carveouts.clear();
+   m_kernel_carveout.clear();
+   if (!unified_l1d()) 
+      return;
+
+   char *toks = new char[strlen(gpgpu_shmem_carveouts_opt)+1];
+   char *tokd = toks;
+   strcpy(toks,gpgpu_shmem_carveouts_opt);
+   for (toks = strtok(toks,","); toks; toks = strtok(NULL,",")) {
+      unsigned kb;
+      int ntok = sscanf(toks,"%u",&kb);
+      assert(ntok == 1);
+      if (kb > gpgpu_unified_l1d_size) {
+         printf("GPGPU-Sim uArch: WARNING shared memory carveout %uKB exceeds -gpgpu_unified_l1d_size, ignored\n", kb);
+         continue;
+      }
+      m_shmem_carveouts.push_back(kb*1024);
+   }
+   delete[] tokd;
+   if (m_shmem_carveouts.empty()) {
+      printf("GPGPU-Sim uArch: error no valid shared memory carveout in -gpgpu_shmem_carveouts\n");
+      abort();
+   }
+   std::sort(m_shmem_carveouts.begin(), m_shmem_carveouts.end());
+
+   if (strcmp(gpgpu_kernel_carveout_opt,"none")) {
+      toks = new char[strlen(gpgpu_kernel_carveout_opt)+1];
+      tokd = toks;
+      strcpy(toks,gpgpu_kernel_carveout_opt);
+      for (toks = strtok(toks,","); toks; toks = strtok(NULL,",")) {
+         char *sep = strrchr(toks,':');
+         unsigned kb;
+         if (sep == NULL || sscanf(sep+1,"%u",&kb) != 1 || kb > gpgpu_unified_l1d_size) {
+            printf("GPGPU-Sim uArch: error while parsing -gpgpu_kernel_carveout entry '%s'\n", toks);
+            abort();
+         }
+         m_kernel_carveout[std::string(toks, sep-toks)] = kb*1024;
+      }
+      delete[] tokd;
+   }
+}
+
+// In the sub-core model every SP/SFU resource is split evenly among the
+// schedulers, so each of them has to be a multiple of the scheduler count.
+void shader_core_config::init_sub_core_model()
+{
+   if (!gpgpu_sub_core_model)
+      return;
+   unsigned n = gpgpu_num_sched_per_core;
+   struct { const char *name; unsigned value; bool may_be_zero; } res[] = {
+      { "gpgpu_num_sp_units", (unsigned)gpgpu_num_sp_units, false },
+      { "gpgpu_num_sfu_units", (unsigned)gpgpu_num_sfu_units, false },
+      { "gpgpu_num_tensor_core_units", (unsigned)gpgpu_num_tensor_core_units, true },
+      { "gpgpu_num_reg_banks", gpgpu_num_reg_banks, false },
+      { "gpgpu_operand_collector_num_units_sp", (unsigned)gpgpu_operand_collector_num_units_sp, false },
+      { "gpgpu_operand_collector_num_units_sfu", (unsigned)gpgpu_operand_collector_num_units_sfu, false },
+      { "gpgpu_operand_collector_num_units_gen", (unsigned)gpgpu_operand_collector_num_units_gen, true },
+      { "gpgpu_operand_collector_num_in_ports_sp", gpgpu_operand_collector_num_in_ports_sp, false },
+      { "gpgpu_operand_collector_num_in_ports_sfu", gpgpu_operand_collector_num_in_ports_sfu, false },
+      { "gpgpu_operand_collector_num_in_ports_gen", gpgpu_operand_collector_num_in_ports_gen, true },
+      { "gpgpu_operand_collector_num_out_ports_sp", gpgpu_operand_collector_num_out_ports_sp, false },
+      { "gpgpu_operand_collector_num_out_ports_sfu", gpgpu_operand_collector_num_out_ports_sfu, false },
+      { "gpgpu_operand_collector_num_out_ports_gen", gpgpu_operand_collector_num_out_ports_gen, true },
+      { "ID_OC_SP pipeline width", (unsigned)pipe_widths[ID_OC_SP], false },
+      { "ID_OC_SFU pipeline width", (unsigned)pipe_widths[ID_OC_SFU], false },
+      { "OC_EX_SP pipeline width", (unsigned)pipe_widths[OC_EX_SP], false },
+      { "OC_EX_SFU pipeline width", (unsigned)pipe_widths[OC_EX_SFU], false },
+   };
+   for (unsigned i = 0; i < sizeof(res)/sizeof(res[0]); i++) {
+      if ((res[i].value % n) || (!res[i].value && !res[i].may_be_zero)) {
+         printf("GPGPU-Sim uArch: error -gpgpu_sub_core_model needs %s (%u) to be a multiple of -gpgpu_num_sched_per_core (%u)\n",
+                res[i].name, res[i].value, n);
+         abort();
+      }
+   }
+}
+
+void shader_core_config::init_tensor_core()
+{
+   int ntok = sscanf(gpgpu_tensor_core_config_opt, "%u:%u:%u:%u:%u",
+                     &m_tensor_tile_m, &m_tensor_tile_n, &m_tensor_tile_k,
+                     &m_tensor_cycles_per_tile, &m_tensor_latency);
+   if (ntok != 5 || !m_tensor_tile_m || !m_tensor_tile_n || !m_tensor_tile_k || !m_tensor_cycles_per_tile) {
+      printf("GPGPU-Sim uArch: error while parsing -gpgpu_tensor_core_config '%s'\n", gpgpu_tensor_core_config_opt);
+      abort();
+   }
+}
+
+// A tensor core unit computes the mma one tile per pass: the warp occupies the
+// unit for all passes and the last result leaves the pipeline m_tensor_latency
+// cycles later.
+void shader_core_config::tensor_core_timing( warp_inst_t &inst ) const
+{
+   assert( inst.op == TENSOR_CORE_OP && inst.mma_m && inst.mma_n && inst.mma_k );
+   unsigned passes = ((inst.mma_m + m_tensor_tile_m - 1) / m_tensor_tile_m)
+                   * ((inst.mma_n + m_tensor_tile_n - 1) / m_tensor_tile_n)
+                   * ((inst.mma_k + m_tensor_tile_k - 1) / m_tensor_tile_k);
+   inst.initiation_interval = passes * m_tensor_cycles_per_tile;
+   inst.latency = m_tensor_latency + inst.initiation_interval;
+   if (inst.latency >= max_tensor_core_latency) {
+      printf("GPGPU-Sim uArch: error mma latency %u from -gpgpu_tensor_core_config exceeds the tensor core pipeline (%u)\n",
+             inst.latency, max_tensor_core_latency);
+      abort();
+   }
+}
+
+// Pick the shared memory carveout (in bytes) of the unified L1D/shared SRAM for
+// a kernel.  An explicit -gpgpu_kernel_carveout wins; PreferShared takes the
+// largest carveout, PreferL1 the smallest that fits one CTA.  Otherwise the
+// smallest carveout reaching the occupancy allowed by the other CTA limits is
+// taken so that the rest of the SRAM goes to the L1D.
+unsigned shader_core_config::shmem_carveout( const kernel_info_t &k, FuncCache pref ) const
+{
+   assert( unified_l1d() && !m_shmem_carveouts.empty() );
+   const struct gpgpu_ptx_sim_kernel_info *kernel_info = ptx_sim_kernel_info(k.entry());
+   unsigned smem = kernel_info->smem;
+
+   unsigned fit = 0; 
+   while (fit < m_shmem_carveouts.size() && m_shmem_carveouts[fit] < smem) 
+      fit++;
+   if (fit == m_shmem_carveouts.size()) 
+      return m_shmem_carveouts.back(); // max_cta reports the kernel as too large
+
+   std::map<std::string,unsigned>::const_iterator f = m_kernel_carveout.find(k.name());
+   if (f != m_kernel_carveout.end()) {
+      if (f->second >= smem) 
+         return f->second;
+      printf("GPGPU-Sim uArch: WARNING carveout %uKB for kernel '%s' cannot hold a CTA (%u bytes of shared memory)\n", 
+             f->second/1024, k.name().c_str(), smem);
+      return m_shmem_carveouts[fit];
+   }
+   if (pref == FuncCachePreferShared)
+      return m_shmem_carveouts.back();
+   if (pref == FuncCachePreferL1 || smem == 0)
+      return m_shmem_carveouts[fit];
+
+   // CTA/core allowed by everything but shared memory (see max_cta)
+   unsigned padded_cta_size = k.threads_per_cta();
+   if (padded_cta_size % warp_size) 
+      padded_cta_size = ((padded_cta_size/warp_size)+1)*(warp_size);
+   unsigned limit = gs_min2(n_thread_per_shader / padded_cta_size, max_cta_per_core);
+   if (kernel_info->regs > 0)
+      limit = gs_min2(limit, gpgpu_shader_registers / (padded_cta_size * ((kernel_info->regs+3)&~3)));
+   unsigned needed = (k.num_blocks() + num_shader() - 1) / num_shader();
+   limit = gs_min2(limit, needed);
+
+   unsigned best = m_shmem_carveouts[fit];
+   unsigned best_ctas = gs_min2(best / smem, limit);
+   for (unsigned i = fit+1; i < m_shmem_carveouts.size(); i++) {
+      unsigned ctas = gs_min2(m_shmem_carveouts[i] / smem, limit);
+      if (ctas > best_ctas) {
+         best = m_shmem_carveouts[i];
+         best_ctas = ctas;
+      }
+   }
+   return best;
+}
+
 void shader_core_ctx::cycle()
 {
 	m_stats->shader_cycles[m_sid]++;
@@ -2735,6 +3321,7 @@ barrier_set_t::barrier_set_t( unsigned max_warps_per_core, unsigned max_cta_per_
    }
    m_warp_active.reset();
    m_warp_at_barrier.reset();
+   m_warp_at_bulk_copy.reset();
 }
 
 // during cta allocation
@@ -2748,6 +3335,7 @@ void barrier_set_t::allocate_barrier( unsigned cta_id, warp_set_t warps )
   
    m_warp_active |= warps;
    m_warp_at_barrier &= ~warps;
+   m_warp_at_bulk_copy &= ~warps;
 }
 
 // during cta deallocation
@@ -2761,6 +3349,8 @@ void barrier_set_t::deallocate_barrier( unsigned cta_id )
    assert( at_barrier.any() == false ); // no warps stuck at barrier
    warp_set_t active = warps & m_warp_active;
    assert( active.any() == false ); // no warps in CTA still running
+   std::map<bulk_copy_barrier_t,bulk_copy_count_t>::iterator b = m_bulk_copy_barriers.lower_bound(bulk_copy_barrier_t(cta_id,0));
+   assert( b == m_bulk_copy_barriers.end() || b->first.first != cta_id ); // no bulk copy still writing the CTA's shared memory
    m_warp_active &= ~warps;
    m_warp_at_barrier &= ~warps;
    m_cta_to_warps.erase(w);
@@ -2818,10 +3408,49 @@ void barrier_set_t::warp_exit( unsigned warp_id )
    }
 }
 
+void barrier_set_t::bulk_copy_issued( unsigned cta_id, unsigned bar, unsigned n )
+{
+   assert( m_cta_to_warps.find(cta_id) != m_cta_to_warps.end() );
+   if( n ) 
+      m_bulk_copy_barriers[bulk_copy_barrier_t(cta_id,bar)].issued += n;
+}
+
+// copies complete in any order, so a waiter is released once as many copies 
+// have arrived as had been issued when it started waiting
+void barrier_set_t::bulk_copy_arrive( unsigned cta_id, unsigned bar )
+{
+   std::map<bulk_copy_barrier_t,bulk_copy_count_t>::iterator p = m_bulk_copy_barriers.find(bulk_copy_barrier_t(cta_id,bar));
+   assert( p != m_bulk_copy_barriers.end() && p->second.arrived < p->second.issued );
+   bulk_copy_count_t &count = p->second;
+   count.arrived++;
+   std::map<unsigned,unsigned long long>::iterator w = count.waiters.begin();
+   while( w != count.waiters.end() ) {
+      if( w->second <= count.arrived ) {
+         m_warp_at_bulk_copy.reset(w->first);
+         count.waiters.erase(w++);
+      } else {
+         ++w;
+      }
+   }
+   if( count.arrived == count.issued ) {
+      assert( count.waiters.empty() );
+      m_bulk_copy_barriers.erase(p);
+   }
+}
+
+void barrier_set_t::warp_waits_bulk_copy( unsigned cta_id, unsigned warp_id, unsigned bar )
+{
+   std::map<bulk_copy_barrier_t,bulk_copy_count_t>::iterator p = m_bulk_copy_barriers.find(bulk_copy_barrier_t(cta_id,bar));
+   if( p == m_bulk_copy_barriers.end() ) 
+      return; // nothing in flight
+   p->second.waiters[warp_id] = p->second.issued;
+   m_warp_at_bulk_copy.set(warp_id);
+}
+
 // assertions
 bool barrier_set_t::warp_waiting_at_barrier( unsigned warp_id ) const
 { 
-   return m_warp_at_barrier.test(warp_id);
+   return m_warp_at_barrier.test(warp_id) || m_warp_at_bulk_copy.test(warp_id);
 }
 
 void barrier_set_t::dump() const
@@ -2839,6 +3468,7 @@ void barrier_set_t::dump() const
    }
    printf("  warp_active: %s\n", m_warp_active.to_string().c_str() );
    printf("  warp_at_barrier: %s\n", m_warp_at_barrier.to_string().c_str() );
+   printf("  warp_at_bulk_copy: %s\n", m_warp_at_bulk_copy.to_string().c_str() );
    fflush(stdout); 
 }
 
@@ -2894,6 +3524,14 @@ void shader_core_ctx::decrement_atomic_count( unsigned wid, unsigned n )
    m_warp[wid].dec_n_atomic(n);
 }
 
+// a bulk copy issued by warp wid has written all of its data to shared memory
+// (the warp cannot exit before, so its cta is still the one that issued the copy)
+void shader_core_ctx::bulk_copy_arrive( unsigned wid, unsigned bar )
+{
+   m_barriers.bulk_copy_arrive( m_warp[wid].get_cta_id(), bar );
+   m_warp[wid].dec_bulk_copy();
+}
+
 
 bool shader_core_ctx::fetch_unit_response_buffer_full() const
 {
@@ -2959,7 +3597,7 @@ bool shd_warp_t::functional_done() const
 
 bool shd_warp_t::hardware_done() const
 {
-    return functional_done() && stores_done() && !inst_in_pipeline();//-func() ok && store insn over && pipeline is empty. 
+    return functional_done() && stores_done() && bulk_copies_done() && !inst_in_pipeline();//-func() ok && store insn over && pipeline is empty. 
 }
 
 bool shd_warp_t::waiting() 
@@ -3059,6 +3697,8 @@ void opndcoll_rfu_t::init( unsigned num_banks, shader_core_ctx *shader )
    //for( unsigned n=0; n<m_num_ports;n++ ) 
    //    m_dispatch_units[m_output[n]].init( m_num_collector_units[n] );
    m_num_banks = num_banks;
+   m_num_sub_cores = shader->get_config()->num_sub_cores();
+   assert( !(m_num_banks % m_num_sub_cores) );
    m_bank_warp_shift = 0; 
    m_warp_size = shader->get_config()->warp_size;
    m_bank_warp_shift = (unsigned)(int) (log(m_warp_size+0.5) / log(2.0));
@@ -3067,15 +3707,90 @@ void opndcoll_rfu_t::init( unsigned num_banks, shader_core_ctx *shader )
    for( unsigned j=0; j<m_cu.size(); j++) {
        m_cu[j]->init(j,num_banks,m_bank_warp_shift,shader->get_config(),this);
    }
+
+   m_rf_cache_entries = shader->get_config()->gpgpu_rf_cache_entries;
+   m_rf_cache_policy = shader->get_config()->gpgpu_rf_cache_policy;
+   if( m_rf_cache_policy != 'L' && m_rf_cache_policy != 'R' ) {
+      printf("GPGPU-Sim uArch: error unknown register-file cache policy '%c'\n", m_rf_cache_policy);
+      abort();
+   }
+   if( m_rf_cache_entries ) 
+      m_rf_cache.resize(shader->get_config()->max_warps_per_shader);
    m_initialized=true;
 }
 
-int register_bank(int regnum, int wid, unsigned num_banks, unsigned bank_warp_shift)
+// returns true if the operand is supplied by the warp's register-file cache
+bool opndcoll_rfu_t::rf_cache_read( const warp_inst_t &inst, unsigned reg )
+{
+   if( !m_rf_cache_entries ) 
+      return false;
+   std::list<unsigned> &regs = m_rf_cache[inst.warp_id()];
+   std::list<unsigned>::iterator r = std::find(regs.begin(),regs.end(),reg);
+   bool hit = (r != regs.end());
+   m_shader->incrf_cache_access(hit);
+   if( hit ) {
+      regs.splice(regs.begin(),regs,r);
+      // the cache read replaces a register file read in the power model
+      m_shader->incnon_rf_operands(rf_active_count(inst.get_active_mask()));
+   }
+   return hit;
+}
+
+void opndcoll_rfu_t::rf_cache_fill( unsigned wid, unsigned reg )
 {
+   std::list<unsigned> &regs = m_rf_cache[wid];
+   std::list<unsigned>::iterator r = std::find(regs.begin(),regs.end(),reg);
+   if( r != regs.end() ) {
+      regs.splice(regs.begin(),regs,r);
+      return;
+   }
+   if( regs.size() >= m_rf_cache_entries ) 
+      regs.pop_back();
+   regs.push_front(reg);
+}
+
+// PTX carries no operand reuse flags, so they are derived the way the assembler
+// sets them: a source operand is kept if the next instruction of the warp reads it.
+bool opndcoll_rfu_t::rf_cache_reused( const warp_inst_t &inst, unsigned reg ) const
+{
+   if( m_rf_cache_policy == 'L' ) 
+      return true;
+   const warp_inst_t *next = ptx_fetch_inst(inst.pc + inst.isize);
+   if( next == NULL ) 
+      return false;
+   for( unsigned op=0; op < MAX_REG_OPERANDS; op++ ) 
+      if( next->arch_reg.src[op] == (int)reg ) 
+         return true;
+   return false;
+}
+
+unsigned opndcoll_rfu_t::rf_active_count( const active_mask_t &mask ) const
+{
+   const shader_core_config *config = m_shader->get_config();
+   if( !config->gpgpu_clock_gated_reg_file ) 
+      return config->warp_size;
+   unsigned active_count=0;
+   for(unsigned i=0;i<config->warp_size;i=i+config->n_regfile_gating_group){
+      for(unsigned j=0;j<config->n_regfile_gating_group;j++){
+         if(mask.test(i+j)){
+            active_count+=config->n_regfile_gating_group;
+            break;
+         }
+      }
+   }
+   return active_count;
+}
+
+// with sub-cores, warp wid is served by scheduler wid % num_sub_cores and only
+// reaches that scheduler's slice of the banks
+int register_bank(int regnum, int wid, unsigned num_banks, unsigned bank_warp_shift, unsigned num_sub_cores)
+{
+   unsigned banks_per_sub_core = num_banks / num_sub_cores;
+   unsigned sub_core = wid % num_sub_cores;
    int bank = regnum;
    if (bank_warp_shift)
-      bank += wid;
-   return bank % num_banks;
+      bank += wid / num_sub_cores;
+   return sub_core * banks_per_sub_core + bank % banks_per_sub_core;
 }
 
 bool opndcoll_rfu_t::writeback( const warp_inst_t &inst )
@@ -3087,13 +3802,22 @@ bool opndcoll_rfu_t::writeback( const warp_inst_t &inst )
    //-simulate the write back to register procedure.
    for( r=regs.begin(); r!=regs.end();r++,n++ ) {
       unsigned reg = *r;
-      unsigned bank = register_bank( reg , inst.warp_id() , m_num_banks , m_bank_warp_shift );
+      unsigned bank = register_bank( reg , inst.warp_id() , m_num_banks , m_bank_warp_shift , m_num_sub_cores );
       if( m_arbiter.bank_idle(bank) ) {
-          m_arbiter.allocate_bank_for_write( bank , op_t(&inst , reg , m_num_banks , m_bank_warp_shift) );
+          m_arbiter.allocate_bank_for_write( bank , op_t(&inst , reg , m_num_banks , m_bank_warp_shift , m_num_sub_cores) );
       } else {
           return false;
       }
    }
+   // results go to the register file; the LRU register-file cache also keeps them,
+   // otherwise a cached copy is updated in place
+   if( m_rf_cache_entries ) {
+      std::list<unsigned> &cached = m_rf_cache[inst.warp_id()];
+      for( r=regs.begin(); r!=regs.end();r++ ) {
+         if( m_rf_cache_policy == 'L' || std::find(cached.begin(),cached.end(),*r) != cached.end() ) 
+            rf_cache_fill(inst.warp_id(),*r);
+      }
+   }
    // static the write times of reg.
    for(unsigned i=0; i<(unsigned)regs.size(); i++){
 	      if(m_shader->get_config()->gpgpu_clock_gated_reg_file){
@@ -3174,16 +3898,19 @@ void opndcoll_rfu_t::allocate_reads()
       const op_t &rr = *r;
       unsigned reg = rr.get_reg();
       unsigned wid = rr.get_wid();
-      unsigned bank = register_bank(reg,wid,m_num_banks,m_bank_warp_shift);
+      unsigned bank = register_bank(reg,wid,m_num_banks,m_bank_warp_shift,m_num_sub_cores);
       m_arbiter.allocate_for_read(bank,rr);
       read_ops[bank] = rr;
    }
+   m_shader->increg_bank_conflict_stalls(m_arbiter.num_waiting_banks());
    std::map<unsigned,op_t>::iterator r;
    for(r=read_ops.begin();r!=read_ops.end();++r ) {
       op_t &op = r->second;
       unsigned cu = op.get_oc_id();
       unsigned operand = op.get_operand();
       m_cu[cu]->collect_operand(operand);
+      if( m_rf_cache_entries && m_cu[cu]->reuse_operand(operand) ) 
+         rf_cache_fill(op.get_wid(),op.get_reg());
       if(m_shader->get_config()->gpgpu_clock_gated_reg_file){
     	  unsigned active_count=0;
     	  for(unsigned i=0;i<m_shader->get_config()->warp_size;i=i+m_shader->get_config()->n_regfile_gating_group){
@@ -3233,6 +3960,7 @@ void opndcoll_rfu_t::collector_unit_t::init( unsigned n,
    assert(m_warp==NULL); 
    m_warp = new warp_inst_t(config);
    m_bank_warp_shift=log2_warp_size;
+   m_num_sub_cores=rfu->m_num_sub_cores;
 }
 
 bool opndcoll_rfu_t::collector_unit_t::allocate( register_set* pipeline_reg_set, register_set* output_reg_set ) 
@@ -3244,11 +3972,16 @@ bool opndcoll_rfu_t::collector_unit_t::allocate( register_set* pipeline_reg_set,
    warp_inst_t **pipeline_reg = pipeline_reg_set->get_ready();
    if( (pipeline_reg) and !((*pipeline_reg)->empty()) ) {
       m_warp_id = (*pipeline_reg)->warp_id();
+      m_reuse.reset();
       for( unsigned op=0; op < MAX_REG_OPERANDS; op++ ) {
          int reg_num = (*pipeline_reg)->arch_reg.src[op]; // this math needs to match that used in function_info::ptx_decode_inst
-         if( reg_num >= 0 ) { // valid register
-            m_src_op[op] = op_t( this, op, reg_num, m_num_banks, m_bank_warp_shift );
+         if( reg_num >= 0 && m_rfu->rf_cache_read(**pipeline_reg,reg_num) ) {
+            m_src_op[op] = op_t(); // operand comes from the register-file cache
+         } else if( reg_num >= 0 ) { // valid register
+            m_src_op[op] = op_t( this, op, reg_num, m_num_banks, m_bank_warp_shift, m_num_sub_cores );
             m_not_ready.set(op);
+            if( m_rfu->m_rf_cache_entries && m_rfu->rf_cache_reused(**pipeline_reg,reg_num) ) 
+               m_reuse.set(op);
          } else 
             m_src_op[op] = op_t();
       }
@@ -3351,15 +4084,27 @@ unsigned simt_core_cluster::issue_block2core()
     unsigned num_blocks_issued=0;
     for( unsigned i=0; i < m_config->n_simt_cores_per_cluster; i++ ) {
         unsigned core = (i+m_cta_issue_next_core+1)%m_config->n_simt_cores_per_cluster;
+        if( m_gpu->shares_cores() ) {
+            // CTAs of different kernels may be co-resident on the core
+            kernel_info_t *kernel = m_gpu->select_shared_kernel(m_core[core]);
+            if( kernel ) {
+                m_core[core]->issue_block2core(*kernel);
+                num_blocks_issued++;
+                m_cta_issue_next_core=core; 
+                break;
+            }
+            continue;
+        }
         if( m_core[core]->get_not_completed() == 0 ) {
             if( m_core[core]->get_kernel() == NULL ) {
-                kernel_info_t *k = m_gpu->select_kernel();
+                kernel_info_t *k = m_gpu->select_kernel(m_core[core]->get_sid());
                 if( k ) 
                     m_core[core]->set_kernel(k);
             }
         }
         kernel_info_t *kernel = m_core[core]->get_kernel();
-        if( kernel && !kernel->no_more_ctas_to_run() && (m_core[core]->get_n_active_cta() < m_config->max_cta(*kernel)) ) {
+        if( kernel && !kernel->no_more_ctas_to_run() && (m_core[core]->get_n_active_cta() < m_config->max_cta(*kernel)) 
+            && m_gpu->may_issue(m_core[core]->get_sid(),kernel) ) {
             m_core[core]->issue_block2core(*kernel);
             num_blocks_issued++;
             m_cta_issue_next_core=core; 
@@ -3502,6 +4247,16 @@ void simt_core_cluster::get_cache_stats(cache_stats &cs) const{
     }
 }
 
+void simt_core_cluster::print_iprefetch_stats( FILE *fp, ifetch_prefetcher_stats &total ) const{
+    char name[32];
+    for ( unsigned i = 0; i < m_config->n_simt_cores_per_cluster; ++i ) {
+        const ifetch_prefetcher_stats &s = m_core[i]->get_iprefetch_stats();
+        snprintf(name, sizeof(name), "L1I_prefetch_core[%u]", m_config->cid_to_sid(i,m_cluster_id));
+        s.print(fp, name);
+        total += s;
+    }
+}
+
 void simt_core_cluster::get_L1I_sub_stats(struct cache_sub_stats &css) const{
     struct cache_sub_stats temp_css;
     struct cache_sub_stats total_css;
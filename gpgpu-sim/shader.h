@@ -53,6 +53,7 @@
 #include "stats.h"
 #include "gpu-cache.h"
 #include "traffic_breakdown.h"
+#include "ifetch_prefetcher.h"
 
 
 
@@ -93,12 +94,14 @@ public:
         : m_shader(shader), m_warp_size(warp_size)
     {
         m_stores_outstanding=0;
+        m_bulk_copies_outstanding=0;
         m_inst_in_pipeline=0;
         reset(); 
     }
     void reset()
     {
         assert( m_stores_outstanding==0);
+        assert( m_bulk_copies_outstanding==0);
         assert( m_inst_in_pipeline==0);
         m_imiss_pending=false;
         m_warp_id=(unsigned)-1;
@@ -201,6 +204,14 @@ public:
         m_stores_outstanding--;
     }
 
+    bool bulk_copies_done() const { return m_bulk_copies_outstanding == 0; }
+    void inc_bulk_copies( unsigned n ) { m_bulk_copies_outstanding += n; }
+    void dec_bulk_copy() 
+    {
+        assert( m_bulk_copies_outstanding > 0 );
+        m_bulk_copies_outstanding--;
+    }
+
     bool inst_in_pipeline() const { return m_inst_in_pipeline > 0; }
     void inc_inst_in_pipeline() { m_inst_in_pipeline++; }
     void dec_inst_in_pipeline() 
@@ -244,6 +255,7 @@ private:
     unsigned long long  m_last_fetch; //- record last fetch instrution time.
 
     unsigned    m_stores_outstanding; // number of store requests sent but not yet acknowledged.//-waiting for mf back from mem. why has not m_load_outstanding?
+    unsigned    m_bulk_copies_outstanding; // cp.async.bulk copies whose data is not in shared memory yet
     unsigned    m_inst_in_pipeline;
 };
 
@@ -255,7 +267,7 @@ inline unsigned wid_from_hw_tid(unsigned tid, unsigned warp_size){return tid/war
 const unsigned WARP_PER_CTA_MAX = 48;
 typedef std::bitset<WARP_PER_CTA_MAX> warp_set_t;
 
-int register_bank(int regnum, int wid, unsigned num_banks, unsigned bank_warp_shift);
+int register_bank(int regnum, int wid, unsigned num_banks, unsigned bank_warp_shift, unsigned num_sub_cores);
 
 class shader_core_ctx;
 class shader_core_config;
@@ -341,6 +353,7 @@ public:
     virtual void order_warps() = 0;
 
 protected:
+    void compact_warps( const warp_inst_t *leader, const warp_inst_t *pI );
     virtual void do_on_warp_issued( unsigned warp_id,
                                     unsigned num_issued,
                                     const std::vector< shd_warp_t* >::const_iterator& prioritized_iter );
@@ -487,8 +500,11 @@ public:
    opndcoll_rfu_t()
    {
       m_num_banks=0;
+      m_num_sub_cores=1;
       m_shader=NULL;
       m_initialized=false;
+      m_rf_cache_entries=0;
+      m_rf_cache_policy='R';
    }
    void add_cu_set(unsigned cu_set, unsigned num_cu, unsigned num_dispatch);
    typedef std::vector<register_set*>  port_vector_t;// like core::m_pipelin_reg
@@ -498,6 +514,7 @@ public:
 
    // modifiers
    bool writeback( const warp_inst_t &warp ); // might cause stall 
+   void rf_cache_flush( unsigned wid ) { if( !m_rf_cache.empty() ) m_rf_cache[wid].clear(); }
 
    void step()
    {
@@ -538,6 +555,13 @@ private:
    void allocate_cu( unsigned port );
    void allocate_reads();
 
+   // register-file cache: a few registers per warp kept in front of the banks.
+   // Operands found there are collected without a bank read.
+   bool rf_cache_read( const warp_inst_t &inst, unsigned reg );
+   void rf_cache_fill( unsigned wid, unsigned reg );
+   bool rf_cache_reused( const warp_inst_t &inst, unsigned reg ) const;
+   unsigned rf_active_count( const active_mask_t &mask ) const;
+
    // types
 
    class collector_unit_t;
@@ -546,23 +570,23 @@ private:
    public:
 
       op_t() { m_valid = false; }
-      op_t( collector_unit_t *cu, unsigned op, unsigned reg, unsigned num_banks, unsigned bank_warp_shift )
+      op_t( collector_unit_t *cu, unsigned op, unsigned reg, unsigned num_banks, unsigned bank_warp_shift, unsigned num_sub_cores )
       {
          m_valid = true;
          m_warp=NULL;
          m_cu = cu;
          m_operand = op;
          m_register = reg;
-         m_bank = register_bank(reg,cu->get_warp_id(),num_banks,bank_warp_shift);
+         m_bank = register_bank(reg,cu->get_warp_id(),num_banks,bank_warp_shift,num_sub_cores);
       }
-      op_t( const warp_inst_t *warp, unsigned reg, unsigned num_banks, unsigned bank_warp_shift )
+      op_t( const warp_inst_t *warp, unsigned reg, unsigned num_banks, unsigned bank_warp_shift, unsigned num_sub_cores )
       {
          m_valid=true;
          m_warp=warp;
          m_register=reg;
          m_cu=NULL;
          m_operand = -1;
-         m_bank = register_bank(reg,warp->warp_id(),num_banks,bank_warp_shift);
+         m_bank = register_bank(reg,warp->warp_id(),num_banks,bank_warp_shift,num_sub_cores);
       }
 
       // accessors
@@ -737,6 +761,14 @@ private:
             }
          }
       }
+      unsigned num_waiting_banks() const
+      {
+         unsigned n=0;
+         for( unsigned b=0; b<m_num_banks; b++ ) 
+            if( !m_queue[b].empty() ) 
+               n++;
+         return n;
+      }
       bool bank_idle( unsigned bank ) const
       {
           return m_allocated_bank[bank].is_free();
@@ -798,6 +830,7 @@ private:
                m_warp_id = -1;
                m_num_banks = 0;
                m_bank_warp_shift = 0;
+               m_num_sub_cores = 1;
            }
            // accessors
            bool ready() const;
@@ -822,6 +855,7 @@ private:
            {
                m_not_ready.reset(op);
            }
+           bool reuse_operand( unsigned op ) const { return m_reuse.test(op); }
            unsigned get_num_operands() const{
                return m_warp->get_num_operands();
            }
@@ -839,8 +873,10 @@ private:
            register_set* m_output_register; // pipeline register to issue to when ready
            op_t *m_src_op;// op_t[] 
            std::bitset<MAX_REG_OPERANDS*2> m_not_ready;
+           std::bitset<MAX_REG_OPERANDS*2> m_reuse; // read by the next instruction of the warp
            unsigned m_num_banks;
            unsigned m_bank_warp_shift;
+           unsigned m_num_sub_cores;
            opndcoll_rfu_t *m_rfu;
 
    };
@@ -881,6 +917,7 @@ private:
 
    unsigned m_num_banks;
    unsigned m_bank_warp_shift;
+   unsigned m_num_sub_cores; // the banks are split evenly among the sub-cores
    unsigned m_warp_size;
    std::vector<collector_unit_t *>  m_cu;//-vec < CU >
    arbiter_t    m_arbiter;
@@ -891,6 +928,10 @@ private:
    cu_sets_t    m_cus;//-map[int,vec< CU >]
    std::vector<dispatch_unit_t>     m_dispatch_units;//- vec< dispatch_unit >
 
+   unsigned m_rf_cache_entries;
+   char     m_rf_cache_policy;
+   std::vector< std::list<unsigned> > m_rf_cache; // warp -> cached registers, most recently used first
+
    shader_core_ctx                 *m_shader;
 };// end of class oprdcoll_rfu_t
 
@@ -915,6 +956,15 @@ public:
    // warp reaches exit 
    void warp_exit( unsigned warp_id );
 
+   // asynchronous bulk copies: each copy issued on barrier bar of a cta arrives 
+   // there once its data is in shared memory
+   void bulk_copy_issued( unsigned cta_id, unsigned bar, unsigned n );
+   void bulk_copy_arrive( unsigned cta_id, unsigned bar );
+
+   // warp waits until as many copies have arrived on barrier bar of its cta as
+   // had been issued on it when the wait issued
+   void warp_waits_bulk_copy( unsigned cta_id, unsigned warp_id, unsigned bar );
+
    // assertions
    bool warp_waiting_at_barrier( unsigned warp_id ) const;
 
@@ -928,6 +978,16 @@ private:
    cta_to_warp_t    m_cta_to_warps; 
    warp_set_t       m_warp_active;
    warp_set_t       m_warp_at_barrier;
+
+   typedef std::pair<unsigned/*cta_id*/,unsigned/*bar*/> bulk_copy_barrier_t;
+   struct bulk_copy_count_t {
+      bulk_copy_count_t() : issued(0), arrived(0) {}
+      unsigned long long issued;  // copies issued on the barrier, in issue order
+      unsigned long long arrived;
+      std::map<unsigned/*warp_id*/,unsigned long long/*issued*/> waiters; // copies each waiting warp waits for
+   };
+   std::map<bulk_copy_barrier_t,bulk_copy_count_t> m_bulk_copy_barriers; // barriers with copies in flight or waiters
+   warp_set_t       m_warp_at_bulk_copy;
 };
 
 struct insn_latency_info {
@@ -1082,15 +1142,19 @@ class sp_unit : public pipelined_simd_unit
 {
 public:
     sp_unit( register_set* result_port, const shader_core_config *config, shader_core_ctx *core );
+    virtual bool can_issue( const warp_inst_t &inst ) const;
+    virtual void active_lanes_in_pipeline();
+    virtual void issue( register_set& source_reg );
+};
+
+class tensor_core : public pipelined_simd_unit
+{
+public:
+    tensor_core( register_set* result_port, const shader_core_config *config, shader_core_ctx *core );
     virtual bool can_issue( const warp_inst_t &inst ) const
     {
-        switch(inst.op) {
-        case SFU_OP: return false; 
-        case LOAD_OP: return false;
-        case STORE_OP: return false;
-        case MEMORY_BARRIER_OP: return false;
-        default: break;
-        }
+        if( inst.op != TENSOR_CORE_OP ) 
+            return false;
         return pipelined_simd_unit::can_issue(inst);
     }
     virtual void active_lanes_in_pipeline();
@@ -1131,6 +1195,7 @@ public:
         case LOAD_OP: break;
         case STORE_OP: break;
         case MEMORY_BARRIER_OP: break;
+        case BULK_COPY_OP: break;
         default: return false;
         }
         return m_dispatch_reg->empty();
@@ -1176,6 +1241,9 @@ protected:
    bool constant_cycle( warp_inst_t &inst, mem_stage_stall_type &rc_fail, mem_stage_access_type &fail_type);
    bool texture_cycle( warp_inst_t &inst, mem_stage_stall_type &rc_fail, mem_stage_access_type &fail_type);
    bool memory_cycle( warp_inst_t &inst, mem_stage_stall_type &rc_fail, mem_stage_access_type &fail_type);
+   bool bulk_copy_cycle( warp_inst_t &inst, mem_stage_stall_type &rc_fail, mem_stage_access_type &fail_type);
+   void bulk_copy_stream();
+   void bulk_copy_fill( mem_fetch *mf );
 
    virtual mem_stage_stall_type process_cache_access( cache_t* cache,
                                                       new_addr_type address,
@@ -1195,6 +1263,7 @@ protected:
    tex_cache *m_L1T; // texture cache  ,  pointers to a instance;
    read_only_cache *m_L1C; // constant cache
    l1_cache *m_L1D; // data cache
+   class l1_tlb *m_tlb; // NULL unless -gpgpu_tlb
    std::map<unsigned/*warp_id*/, std::map<unsigned/*regnum*/,unsigned/*count*/> > m_pending_writes;//map[wid,map<regNo,c>]
    std::list<mem_fetch*> m_response_fifo;
    opndcoll_rfu_t *m_operand_collector;
@@ -1202,6 +1271,18 @@ protected:
 
    mem_fetch *m_next_global;
    warp_inst_t m_next_wb;// a inst
+
+   // asynchronous global -> shared copies (one per thread of a cp.async.bulk), 
+   // streamed into shared memory without going through the L1D or the registers
+   struct bulk_copy_t {
+       warp_inst_t   inst;        // issuing instruction, carried by the copy's requests
+       unsigned      lane;
+       new_addr_type next_addr;   // next global address to request
+       new_addr_type end_addr;
+       unsigned      outstanding; // requests whose data is not in shared memory yet
+   };
+   std::list<bulk_copy_t> m_bulk_copies;
+   unsigned m_bulk_copy_lane; // next lane of the dispatched cp.async.bulk to enqueue
    unsigned m_writeback_arb; // round-robin arbiter for writeback contention between L1T, L1C, shared
    unsigned m_num_writeback_clients;
 
@@ -1274,16 +1355,28 @@ struct shader_core_config : public core_config
         assert( !(n_thread_per_shader % warp_size) );
         max_sfu_latency = 512;
         max_sp_latency = 32;
+        max_tensor_core_latency = 256;
         m_L1I_config.init(m_L1I_config.m_config_string,FuncCachePreferNone);
         m_L1T_config.init(m_L1T_config.m_config_string,FuncCachePreferNone);
         m_L1C_config.init(m_L1C_config.m_config_string,FuncCachePreferNone);
         m_L1D_config.init(m_L1D_config.m_config_string,FuncCachePreferNone);
+        init_carveouts();
+        init_sub_core_model();
+        init_tensor_core();
+        m_iprefetch_config.init();
         gpgpu_cache_texl1_linesize = m_L1T_config.get_line_sz();
         gpgpu_cache_constl1_linesize = m_L1C_config.get_line_sz();
         m_valid = true;
     }
     void reg_options(class OptionParser * opp );
     unsigned max_cta( const kernel_info_t &k ) const;
+    void init_carveouts();
+    void init_sub_core_model();
+    void init_tensor_core();
+    void tensor_core_timing( warp_inst_t &inst ) const;
+    unsigned num_sub_cores() const { return gpgpu_sub_core_model ? gpgpu_num_sched_per_core : 1; }
+    bool unified_l1d() const { return gpgpu_unified_l1d_size > 0; }
+    unsigned shmem_carveout( const kernel_info_t &k, FuncCache pref ) const;
     unsigned num_shader() const { return n_simt_clusters*n_simt_cores_per_cluster; }
     unsigned sid_to_cluster( unsigned sid ) const { return sid / n_simt_cores_per_cluster; }
     unsigned sid_to_cid( unsigned sid )     const { return sid % n_simt_cores_per_cluster; }
@@ -1306,16 +1399,26 @@ struct shader_core_config : public core_config
     int pipe_widths[N_PIPELINE_STAGES];
 
     mutable cache_config m_L1I_config;
+    ifetch_prefetcher_config m_iprefetch_config;
     mutable cache_config m_L1T_config;
     mutable cache_config m_L1C_config;
     mutable cache_config m_L1D_config;
 
     bool gmem_skip_L1D; // on = global memory access always skip the L1 cache 
+
+    // unified L1D/shared memory: the L1D gets whatever the shared memory carveout leaves
+    unsigned gpgpu_unified_l1d_size; // total SRAM in KB, 0 = separate L1D and shared memory
+    char *gpgpu_shmem_carveouts_opt;
+    char *gpgpu_kernel_carveout_opt;
+    std::vector<unsigned> m_shmem_carveouts;             // sorted, in bytes
+    std::map<std::string,unsigned> m_kernel_carveout;    // kernel name -> carveout in bytes
     
     bool gpgpu_dwf_reg_bankconflict;
 
     int gpgpu_num_sched_per_core;
     int gpgpu_max_insn_issue_per_warp;
+    bool gpgpu_sub_core_model;             // each scheduler owns its SP/SFU units, collector units and register banks
+    bool gpgpu_dual_issue_diff_exec_units; // a scheduler issues up to two instructions per cycle to different unit types
 
     //op collector
     int gpgpu_operand_collector_num_units_sp;
@@ -1335,23 +1438,35 @@ struct shader_core_config : public core_config
 
     int gpgpu_num_sp_units;
     int gpgpu_num_sfu_units;
+    int gpgpu_num_tensor_core_units; // 0 = mma runs on the SP units
     int gpgpu_num_mem_units;
 
+    // tensor core: each pass computes a tile_m x tile_n x tile_k block of the mma
+    char *gpgpu_tensor_core_config_opt;
+    unsigned m_tensor_tile_m, m_tensor_tile_n, m_tensor_tile_k;
+    unsigned m_tensor_cycles_per_tile;
+    unsigned m_tensor_latency;
+
     //Shader core resources
     unsigned gpgpu_shader_registers;
     int gpgpu_warpdistro_shader;
     int gpgpu_warp_issue_shader;
     unsigned gpgpu_num_reg_banks;
     bool gpgpu_reg_bank_use_warp_id;
+    unsigned gpgpu_rf_cache_entries; // per warp, 0 = no register-file cache
+    char gpgpu_rf_cache_policy;      // 'L' = LRU, 'R' = reuse of the next instruction
+    unsigned gpgpu_dwf_max_warps;    // warps fused into one issue by dynamic warp formation, 1 = off
     bool gpgpu_local_mem_map;
     
     unsigned max_sp_latency;
     unsigned max_sfu_latency;
+    unsigned max_tensor_core_latency;
     
     unsigned n_simt_cores_per_cluster;
     unsigned n_simt_clusters; // num of cluster
     unsigned n_simt_ejection_buffer_size; //-two list size.
     unsigned ldst_unit_response_queue_size;
+    unsigned gpgpu_bulk_copy_queue_size; // bulk copies the ldst unit streams concurrently
 
     int simt_core_sim_order; 
     
@@ -1381,12 +1496,14 @@ struct shader_core_stats_pod {
     unsigned *m_num_fpdiv_acesses;
     unsigned *m_num_sp_acesses;
     unsigned *m_num_sfu_acesses;
+    unsigned *m_num_tensor_acesses; // multiply-accumulates done by the tensor core units
     unsigned *m_num_trans_acesses;
     unsigned *m_num_mem_acesses;
     unsigned *m_num_sp_committed;
     unsigned *m_num_tlb_hits;
     unsigned *m_num_tlb_accesses;
     unsigned *m_num_sfu_committed;
+    unsigned *m_num_tensor_committed;
     unsigned *m_num_mem_committed;
     unsigned *m_read_regfile_acesses;//-reg statics.
     unsigned *m_write_regfile_acesses;
@@ -1410,6 +1527,16 @@ struct shader_core_stats_pod {
     unsigned gpgpu_n_cmem_portconflict;
     unsigned gpu_stall_shd_mem_breakdown[N_MEM_STAGE_ACCESS_TYPE][N_MEM_STAGE_STALL_TYPE];
     unsigned gpu_reg_bank_conflict_stalls;
+    unsigned gpgpu_n_rf_cache_access;
+    unsigned gpgpu_n_rf_cache_hit;
+    unsigned gpgpu_n_dwf_warp_insn;        // SP/SFU warp instructions issued (fused ones included)
+    unsigned long long gpgpu_n_dwf_thread_insn; // active lanes of those
+    unsigned gpgpu_n_dwf_merged_warp_insn; // issued inside another warp's slot
+    unsigned gpgpu_n_dwf_fused_issue;      // issue slots carrying more than one warp
+    unsigned gpgpu_n_dual_issue;           // scheduler cycles that issued two instructions
+    unsigned gpgpu_n_bulk_copy;            // cp.async.bulk copies (one per active thread)
+    unsigned long long gpgpu_n_bulk_copy_bytes;
+    unsigned gpgpu_n_bulk_copy_req;        // global read requests sent by the bulk copy engines
     unsigned *shader_cycle_distro;
     unsigned *last_shader_cycle_distro;
     unsigned *num_warps_issuable;
@@ -1465,6 +1592,7 @@ public:
         m_num_fpdiv_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_sp_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_sfu_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
+        m_num_tensor_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_trans_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_mem_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_sp_committed= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
@@ -1475,6 +1603,7 @@ public:
         m_active_fu_lanes= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_active_fu_mem_lanes= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_sfu_committed= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
+        m_num_tensor_committed= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_num_mem_committed= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_read_regfile_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
         m_write_regfile_acesses= (unsigned*) calloc(config->num_shader(),sizeof(unsigned));
@@ -1623,6 +1752,7 @@ public:
     unsigned isactive() const {if(m_n_active_cta>0) return 1; else return 0;}
     kernel_info_t *get_kernel() { return m_kernel; }
     unsigned get_sid() const {return m_sid;}
+    bool can_issue_shared_cta( const kernel_info_t &kernel, unsigned n_sharing ) const;
 
 // used by functional simulation:
     // modifiers
@@ -1636,6 +1766,7 @@ public:
     // modifiers
     void mem_instruction_stats(const warp_inst_t &inst);
     void decrement_atomic_count( unsigned wid, unsigned n );
+    void bulk_copy_arrive( unsigned wid, unsigned bar );
     void inc_store_req( unsigned warp_id) { m_warp[warp_id].inc_store_req(); }
     void dec_inst_in_pipeline( unsigned warp_id ) { m_warp[warp_id].dec_inst_in_pipeline(); } // also used in writeback()
     void store_ack( class mem_fetch *mf );
@@ -1653,6 +1784,7 @@ public:
     void get_L1D_sub_stats(struct cache_sub_stats &css) const;
     void get_L1C_sub_stats(struct cache_sub_stats &css) const;
     void get_L1T_sub_stats(struct cache_sub_stats &css) const;
+    const ifetch_prefetcher_stats &get_iprefetch_stats() const { return m_iprefetcher->get_stats(); }
 
     void get_icnt_power_stats(long &n_simt_to_mem, long &n_mem_to_simt) const;
 
@@ -1742,6 +1874,7 @@ public:
 	 }
 
 	 void incsfu_stat(unsigned active_count,double latency) {m_stats->m_num_sfu_acesses[m_sid]=m_stats->m_num_sfu_acesses[m_sid]+active_count*latency;}
+	 void inctensor_stat(unsigned macs) {m_stats->m_num_tensor_acesses[m_sid]=m_stats->m_num_tensor_acesses[m_sid]+macs;}
 	 void incsp_stat(unsigned active_count,double latency) {m_stats->m_num_sp_acesses[m_sid]=m_stats->m_num_sp_acesses[m_sid]+active_count*latency;}
 	 void incmem_stat(unsigned active_count,double latency) {
 		if(m_config->gpgpu_clock_gated_lanes==false){
@@ -1756,6 +1889,8 @@ public:
 	 void incregfile_reads(unsigned active_count) {m_stats->m_read_regfile_acesses[m_sid]=m_stats->m_read_regfile_acesses[m_sid]+active_count;}
 	 void incregfile_writes(unsigned active_count){m_stats->m_write_regfile_acesses[m_sid]=m_stats->m_write_regfile_acesses[m_sid]+active_count;}
 	 void incnon_rf_operands(unsigned active_count){m_stats->m_non_rf_operands[m_sid]=m_stats->m_non_rf_operands[m_sid]+active_count;}
+	 void increg_bank_conflict_stalls(unsigned n) {m_stats->gpu_reg_bank_conflict_stalls+=n;}
+	 void incrf_cache_access(bool hit) {m_stats->gpgpu_n_rf_cache_access++; if(hit) m_stats->gpgpu_n_rf_cache_hit++;}
 
 	 void incspactivelanes_stat(unsigned active_count) {m_stats->m_active_sp_lanes[m_sid]=m_stats->m_active_sp_lanes[m_sid]+active_count;}
 	 void incsfuactivelanes_stat(unsigned active_count) {m_stats->m_active_sfu_lanes[m_sid]=m_stats->m_active_sfu_lanes[m_sid]+active_count;}
@@ -1777,15 +1912,19 @@ private:
     virtual void checkExecutionStatusAndUpdate(warp_inst_t &inst, unsigned t, unsigned tid);
     address_type next_pc( int tid ) const;
     void fetch();
+    void issue_iprefetch( unsigned warp_id );
     void register_cta_thread_exit( unsigned cta_num );
 
     void decode();
     
     void issue();
+    register_set *pipeline_reg( enum pipeline_stage_name_t stage, unsigned sub_core );
     friend class scheduler_unit; //this is needed to use private issue warp.
     friend class TwoLevelScheduler;
     friend class LooseRoundRobbinScheduler;
-    void issue_warp( register_set& warp, const warp_inst_t *pI, const active_mask_t &active_mask, unsigned warp_id );
+    warp_inst_t *issue_warp( register_set& warp, const warp_inst_t *pI, const active_mask_t &active_mask, unsigned warp_id );
+    void issue_compacted_warp( const warp_inst_t &leader, const warp_inst_t *pI, const active_mask_t &active_mask, unsigned warp_id );
+    void retire_compacted_warps( const warp_inst_t &leader );
     void func_exec_inst( warp_inst_t &inst );
 
      // Returns numbers of addresses in translated_addrs
@@ -1816,6 +1955,16 @@ private:
     // CTA scheduling / hardware thread allocation
     unsigned m_n_active_cta; // number of Cooperative Thread Arrays (blocks) currently running on this shader.
     unsigned m_cta_status[MAX_CTA_PER_SHADER]; // CTAs status //- max cta pre core =32. threads num of this CTA.
+    struct cta_resource_t {
+        kernel_info_t *kernel; // NULL if the CTA slot is free
+        unsigned start_thread;
+        unsigned threads;      // padded to a multiple of the warp size
+        unsigned regs;
+        unsigned smem;
+    };
+    cta_resource_t m_cta_resource[MAX_CTA_PER_SHADER]; // per CTA slot, lets CTAs of several kernels share the core
+    unsigned n_resident_ctas( const kernel_info_t *kernel ) const;
+    unsigned find_free_threads( unsigned padded_cta_size ) const;
     unsigned m_not_completed; // number of threads to be completed (==0 when all thread on this core completed) 
     std::bitset<MAX_THREAD_PER_SM> m_active_threads;// bitset<2048> ?
     
@@ -1832,9 +1981,11 @@ private:
 
     // decode/dispatch
     std::vector<shd_warp_t>   m_warp;  //-warps in this core. 
+    std::map<unsigned,std::vector<warp_inst_t*> > m_compacted_warps; // leader uid -> warps issued in its slot
     barrier_set_t             m_barriers;
     ifetch_buffer_t           m_inst_fetch_buffer;// a structure. 4 vars. L1I-> this structure-> ibuffer[]
     std::vector<register_set> m_pipeline_reg;// 7 stages
+    std::vector<register_set> m_sub_core_reg; // sub-core model: N_PIPELINE_STAGES private sets per scheduler
     Scoreboard               *m_scoreboard;
     opndcoll_rfu_t            m_operand_collector;
 
@@ -1845,6 +1996,7 @@ private:
     unsigned                            m_num_function_units;
     std::vector<pipeline_stage_name_t>  m_dispatch_port; // vector < enum >
     std::vector<pipeline_stage_name_t>  m_issue_port;    // vector < enum >
+    std::vector<unsigned>               m_fu_sub_core;   // scheduler owning the unit in the sub-core model
     std::vector<simd_function_unit*>    m_fu; // stallable pipelines should be last in this array
     ldst_unit *m_ldst_unit;
     static const unsigned               MAX_ALU_LATENCY = 512;
@@ -1860,8 +2012,9 @@ private:
     // run on this shader, where the warp_id is the static warp slot.
     unsigned    m_dynamic_warp_id;
 
-    //2015.11.27 add a list to record i-prefetch mf.
-    std::deque< address_type > m_i_prefetch_pc; // deque< unsigned  >
+    // L1I prefetcher
+    ifetch_prefetcher                  *m_iprefetcher;
+    std::vector<new_addr_type>          m_iprefetch_candidates;
 };// shader_core_ctx
 
 class simt_core_cluster {
@@ -1907,6 +2060,7 @@ public:
     void get_L1D_sub_stats(struct cache_sub_stats &css) const;
     void get_L1C_sub_stats(struct cache_sub_stats &css) const;
     void get_L1T_sub_stats(struct cache_sub_stats &css) const;
+    void print_iprefetch_stats( FILE *fp, ifetch_prefetcher_stats &total ) const;
 
     void get_icnt_stats(long &n_simt_to_mem, long &n_mem_to_simt) const;
 
@@ -0,0 +1,343 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include "tlb.h"
+#include <assert.h>
+#include <stdlib.h>
+#include "../option_parser.h"
+#include "gpu-sim.h"
+#include "l2cache.h"
+#include "mem_fetch.h"
+
+#define VIRTUAL_ADDRESS_BITS 48
+#define PTE_SIZE 8
+
+void tlb_config::reg_options( class OptionParser * opp )
+{
+   option_parser_register(opp, "-gpgpu_tlb", OPT_BOOL, &enabled,
+                          "Model virtual to physical address translation with TLBs and page table walks (1=on, 0=off)", "0");
+   option_parser_register(opp, "-gpgpu_page_size", OPT_UINT32, &page_size,
+                          "Page size in bytes (4096, 65536 or 2097152)", "4096");
+   option_parser_register(opp, "-gpgpu_l1_tlb", OPT_CSTR, &l1_tlb_string,
+                          "per-SM L1 TLB config {<entries>:<assoc>:<max pending misses>}", "64:64:8");
+   option_parser_register(opp, "-gpgpu_l2_tlb", OPT_CSTR, &l2_tlb_string,
+                          "shared L2 TLB config {<entries>:<assoc>:<lookup latency>}", "1024:16:20");
+   option_parser_register(opp, "-gpgpu_ptw_threads", OPT_UINT32, &n_walkers,
+                          "Number of concurrent page table walks", "8");
+   option_parser_register(opp, "-gpgpu_page_table_base", OPT_UINT64, &pt_base,
+                          "Physical address of the page table", "0x800000000000");
+}
+
+void tlb_config::init()
+{
+   if (!enabled) 
+      return;
+   switch (page_size) {
+   case 4096:    page_shift = 12; break;
+   case 65536:   page_shift = 16; break;
+   case 2097152: page_shift = 21; break;
+   default:
+      printf("GPGPU-Sim uArch: ERROR ** -gpgpu_page_size must be 4096, 65536 or 2097152\n");
+      abort();
+   }
+   // 512 entries (9 bits) per page table node
+   n_levels = (VIRTUAL_ADDRESS_BITS - page_shift + 8) / 9;
+   int ntok = sscanf(l1_tlb_string, "%u:%u:%u", &l1_entries, &l1_assoc, &l1_max_pending);
+   if (ntok != 3 || l1_entries == 0 || l1_assoc == 0 || l1_entries % l1_assoc || l1_max_pending == 0) {
+      printf("GPGPU-Sim uArch: ERROR ** invalid -gpgpu_l1_tlb \"%s\"\n", l1_tlb_string);
+      abort();
+   }
+   ntok = sscanf(l2_tlb_string, "%u:%u:%u", &l2_entries, &l2_assoc, &l2_latency);
+   if (ntok != 3 || l2_entries == 0 || l2_assoc == 0 || l2_entries % l2_assoc) {
+      printf("GPGPU-Sim uArch: ERROR ** invalid -gpgpu_l2_tlb \"%s\"\n", l2_tlb_string);
+      abort();
+   }
+   if (n_walkers == 0) {
+      printf("GPGPU-Sim uArch: ERROR ** -gpgpu_ptw_threads must be positive\n");
+      abort();
+   }
+}
+
+void tlb_array::init( unsigned entries, unsigned assoc )
+{
+   m_assoc = assoc;
+   m_n_sets = entries / assoc;
+   m_entry.assign(entries, entry());
+}
+
+bool tlb_array::access( new_addr_type vpn, unsigned long long time )
+{
+   entry *set = &m_entry[(vpn % m_n_sets) * m_assoc];
+   for (unsigned w=0; w < m_assoc; w++) {
+      if (set[w].valid && set[w].vpn == vpn) {
+         set[w].last_used = time;
+         return true;
+      }
+   }
+   return false;
+}
+
+void tlb_array::fill( new_addr_type vpn, unsigned long long time )
+{
+   entry *set = &m_entry[(vpn % m_n_sets) * m_assoc];
+   unsigned victim = 0;
+   for (unsigned w=0; w < m_assoc; w++) {
+      if (set[w].valid && set[w].vpn == vpn) {
+         victim = w;
+         break;
+      }
+      if (!set[w].valid) {
+         victim = w;
+         break;
+      }
+      if (set[w].last_used < set[victim].last_used) 
+         victim = w;
+   }
+   set[victim].valid = true;
+   set[victim].vpn = vpn;
+   set[victim].last_used = time;
+}
+
+l1_tlb::l1_tlb( const tlb_config &config, unsigned sid, class gpu_mmu *mmu )
+   : m_config(config)
+{
+   m_sid = sid;
+   m_mmu = mmu;
+   m_array.init(m_config.l1_entries, m_config.l1_assoc);
+   m_n_access = 0;
+   m_n_miss = 0;
+   m_n_pending_full = 0;
+   m_tot_miss_latency = 0;
+   m_mmu->register_l1_tlb(this);
+}
+
+enum tlb_request_status l1_tlb::access( new_addr_type addr )
+{
+   // the L1 TLB is looked up in parallel with the L1D tag (VIPT), so a hit 
+   // adds no latency; the LD/ST unit retries the access until it hits
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+   new_addr_type vpn = addr >> m_config.page_shift;
+   if (m_pending.find(vpn) != m_pending.end()) 
+      return TLB_PENDING;
+   if (m_array.access(vpn, now)) {
+      m_n_access++;
+      return TLB_HIT;
+   }
+   if (m_pending.size() >= m_config.l1_max_pending) {
+      // counted as an access when it is retried
+      m_n_pending_full++;
+      return TLB_PENDING;
+   }
+   m_n_access++;
+   m_n_miss++;
+   m_pending[vpn] = now;
+   m_mmu->translate(this, vpn);
+   return TLB_PENDING;
+}
+
+void l1_tlb::fill( new_addr_type vpn )
+{
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+   std::map<new_addr_type,unsigned long long>::iterator p = m_pending.find(vpn);
+   assert( p != m_pending.end() );
+   m_tot_miss_latency += now - p->second;
+   m_pending.erase(p);
+   m_array.fill(vpn, now);
+}
+
+gpu_mmu::gpu_mmu( const tlb_config &config, 
+                  const class memory_config *mem_config, 
+                  class memory_sub_partition **sub_partition )
+   : m_config(config)
+{
+   m_memory_config = mem_config;
+   m_sub_partition = sub_partition;
+   m_l2.init(m_config.l2_entries, m_config.l2_assoc);
+   m_walker.resize(m_config.n_walkers);
+   m_n_l2_access = 0;
+   m_n_l2_hit = 0;
+   m_n_walks = 0;
+   m_n_walks_done = 0;
+   m_n_pte_reads = 0;
+   m_pte_stalls = 0;
+   m_tot_walk_latency = 0;
+   m_max_walk_latency = 0;
+   m_tot_walk_queue = 0;
+   printf("GPGPU-Sim uArch: address translation on, page size = %u B (%u levels), L1 TLB = %s, L2 TLB = %s, %u walkers\n",
+          m_config.page_size, m_config.n_levels, m_config.l1_tlb_string, m_config.l2_tlb_string, m_config.n_walkers);
+}
+
+void gpu_mmu::translate( l1_tlb *requester, new_addr_type vpn )
+{
+   // misses to the same page from several SMs share one L2 lookup / walk
+   std::map<new_addr_type, std::vector<l1_tlb*> >::iterator w = m_waiting.find(vpn);
+   if (w != m_waiting.end()) {
+      w->second.push_back(requester);
+      return;
+   }
+   m_waiting[vpn].push_back(requester);
+   m_l2_pipe.push_back( std::make_pair(vpn, gpu_sim_cycle + gpu_tot_sim_cycle + m_config.l2_latency) );
+}
+
+void gpu_mmu::complete( new_addr_type vpn )
+{
+   std::map<new_addr_type, std::vector<l1_tlb*> >::iterator w = m_waiting.find(vpn);
+   assert( w != m_waiting.end() );
+   for (unsigned i=0; i < w->second.size(); i++) 
+      w->second[i]->fill(vpn);
+   m_waiting.erase(w);
+}
+
+new_addr_type gpu_mmu::pte_address( new_addr_type vpn, unsigned level ) const
+{
+   // radix page table with 512 entries per node; level 0 is the root. Each 
+   // level lives in its own region and nodes of a level are laid out 
+   // contiguously, so neighbouring pages share PTE cache lines.
+   unsigned shift = 9 * (m_config.n_levels - 1 - level);
+   return m_config.pt_base + ((new_addr_type)level << 40) + (vpn >> shift) * PTE_SIZE;
+}
+
+bool gpu_mmu::issue_pte_read( unsigned w )
+{
+   walker &wk = m_walker[w];
+   new_addr_type addr = pte_address(wk.vpn, wk.level);
+   addrdec_t tlx;
+   m_memory_config->m_address_mapping.addrdec_tlx(addr,&tlx);
+   memory_sub_partition *sub_partition = m_sub_partition[tlx.sub_partition];
+   if (sub_partition->full()) {
+      m_pte_stalls++;
+      return false;
+   }
+
+   mem_access_byte_mask_t byte_mask;
+   for (unsigned b=0; b < PTE_SIZE; b++) 
+      byte_mask.set(b);
+   mem_access_t access( PTW_ACC_R, addr, PTE_SIZE, false, active_mask_t(), byte_mask );
+   // like copy engine DMA, walks do not belong to a shader core; the warp id 
+   // field names the walker so that walk_reply() can find it
+   mem_fetch *mf = new mem_fetch( access, 
+                                  NULL,
+                                  READ_PACKET_SIZE, 
+                                  w, 
+                                  -1, 
+                                  -1,
+                                  m_memory_config );
+   sub_partition->push( mf, gpu_sim_cycle + gpu_tot_sim_cycle );
+   wk.waiting = true;
+   m_n_pte_reads++;
+   return true;
+}
+
+void gpu_mmu::walk_reply( class mem_fetch *mf )
+{
+   unsigned w = mf->get_wid();
+   assert( w < m_walker.size() && m_walker[w].busy && m_walker[w].waiting );
+   walker &wk = m_walker[w];
+   wk.waiting = false;
+   wk.level++;
+   delete mf;
+   if (wk.level < m_config.n_levels) 
+      return; // next level is issued by cycle()
+
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+   unsigned long long latency = now - wk.start;
+   m_n_walks_done++;
+   m_tot_walk_latency += latency;
+   if (latency > m_max_walk_latency) 
+      m_max_walk_latency = latency;
+   m_l2.fill(wk.vpn, now);
+   complete(wk.vpn);
+   wk.busy = false;
+}
+
+void gpu_mmu::cycle()
+{
+   unsigned long long now = gpu_sim_cycle + gpu_tot_sim_cycle;
+
+   // L2 TLB lookups have a fixed latency, so the pipe is in ready order
+   while (!m_l2_pipe.empty() && m_l2_pipe.front().second <= now) {
+      new_addr_type vpn = m_l2_pipe.front().first;
+      m_l2_pipe.pop_front();
+      m_n_l2_access++;
+      if (m_l2.access(vpn, now)) {
+         m_n_l2_hit++;
+         complete(vpn);
+      } else {
+         m_walk_queue.push_back(vpn);
+      }
+   }
+
+   m_tot_walk_queue += m_walk_queue.size();
+   for (unsigned w=0; w < m_walker.size(); w++) {
+      walker &wk = m_walker[w];
+      if (!wk.busy) {
+         if (m_walk_queue.empty()) 
+            continue;
+         wk.busy = true;
+         wk.vpn = m_walk_queue.front();
+         wk.level = 0;
+         wk.waiting = false;
+         wk.start = now;
+         m_walk_queue.pop_front();
+         m_n_walks++;
+      }
+      if (!wk.waiting) 
+         issue_pte_read(w);
+   }
+}
+
+void gpu_mmu::print_stats( FILE *fout ) const
+{
+   unsigned long long l1_access = 0, l1_miss = 0, l1_pending_full = 0, l1_miss_latency = 0;
+   for (unsigned i=0; i < m_l1_tlb.size(); i++) {
+      const l1_tlb *t = m_l1_tlb[i];
+      l1_access += t->m_n_access;
+      l1_miss += t->m_n_miss;
+      l1_pending_full += t->m_n_pending_full;
+      l1_miss_latency += t->m_tot_miss_latency;
+   }
+   fprintf(fout, "l1_tlb_accesses = %llu\n", l1_access);
+   fprintf(fout, "l1_tlb_misses = %llu\n", l1_miss);
+   fprintf(fout, "l1_tlb_hit_rate = %.4f\n", l1_access? 1.0 - (double)l1_miss / l1_access : 0.0);
+   fprintf(fout, "l1_tlb_pending_full = %llu\n", l1_pending_full);
+   fprintf(fout, "l1_tlb_avg_miss_latency = %.2f\n", l1_miss? (double)l1_miss_latency / l1_miss : 0.0);
+   fprintf(fout, "l1_tlb_hit_rate_per_sm = ");
+   for (unsigned i=0; i < m_l1_tlb.size(); i++) {
+      const l1_tlb *t = m_l1_tlb[i];
+      fprintf(fout, "%.3f ", t->m_n_access? 1.0 - (double)t->m_n_miss / t->m_n_access : 0.0);
+   }
+   fprintf(fout, "\n");
+   fprintf(fout, "l2_tlb_accesses = %llu\n", m_n_l2_access);
+   fprintf(fout, "l2_tlb_hit_rate = %.4f\n", m_n_l2_access? (double)m_n_l2_hit / m_n_l2_access : 0.0);
+   fprintf(fout, "page_walks = %llu\n", m_n_walks);
+   fprintf(fout, "page_walk_pte_reads = %llu\n", m_n_pte_reads);
+   fprintf(fout, "page_walk_pte_stalls = %llu\n", m_pte_stalls);
+   fprintf(fout, "page_walk_avg_latency = %.2f\n", m_n_walks_done? (double)m_tot_walk_latency / m_n_walks_done : 0.0);
+   fprintf(fout, "page_walk_max_latency = %llu\n", m_max_walk_latency);
+   fprintf(fout, "page_walk_tot_queue_occupancy = %llu\n", m_tot_walk_queue);
+}
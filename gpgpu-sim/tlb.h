@@ -0,0 +1,160 @@
+// Copyright (c) 2009-2011, Tor M. Aamodt
+// The University of British Columbia
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, this
+// list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+// Neither the name of The University of British Columbia nor the names of its
+// contributors may be used to endorse or promote products derived from this
+// software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef TLB_H
+#define TLB_H
+
+#include <stdio.h>
+#include <list>
+#include <map>
+#include <vector>
+#include "../abstract_hardware_model.h"
+#include "stats.h"
+
+// Virtual memory and GPU TLB hierarchy (-gpgpu_tlb 1).
+//
+// Global and local accesses look up a per-SM L1 TLB in the LD/ST unit before 
+// they reach the L1D. Misses go to a shared L2 TLB and, when that misses too, 
+// to a multi-threaded page table walker. Every level of a walk is a PTE read 
+// (PTW_ACC_R) sent through the L2 cache and DRAM. The page table models the 
+// timing of translation only: physical addresses equal virtual addresses, so 
+// functional simulation and address decoding are unchanged.
+
+struct tlb_config {
+   void reg_options( class OptionParser * opp );
+   void init();
+
+   bool     enabled;
+   unsigned page_size;         // bytes: 4KB, 64KB or 2MB
+   char    *l1_tlb_string;     // <entries>:<assoc>:<max pending misses>
+   char    *l2_tlb_string;     // <entries>:<assoc>:<lookup latency>
+   unsigned n_walkers;         // concurrent page table walks
+   unsigned long long pt_base; // physical address of the page table
+
+   unsigned page_shift;
+   unsigned n_levels;          // page table levels for a 48-bit virtual address
+   unsigned l1_entries, l1_assoc, l1_max_pending;
+   unsigned l2_entries, l2_assoc, l2_latency;
+};
+
+// set associative array of virtual page numbers with LRU replacement
+class tlb_array {
+public:
+   void init( unsigned entries, unsigned assoc );
+   bool access( new_addr_type vpn, unsigned long long time );
+   void fill( new_addr_type vpn, unsigned long long time );
+
+private:
+   struct entry {
+      entry() : valid(false), vpn(0), last_used(0) {}
+      bool valid;
+      new_addr_type vpn;
+      unsigned long long last_used;
+   };
+   unsigned m_n_sets;
+   unsigned m_assoc;
+   std::vector<entry> m_entry; // [set * assoc + way]
+};
+
+class l1_tlb {
+public:
+   l1_tlb( const tlb_config &config, unsigned sid, class gpu_mmu *mmu );
+
+   // TLB_HIT, or TLB_PENDING while the translation is being fetched
+   enum tlb_request_status access( new_addr_type addr );
+   void fill( new_addr_type vpn );
+
+   unsigned get_sid() const { return m_sid; }
+   unsigned long long get_accesses() const { return m_n_access; }
+   unsigned long long get_misses() const { return m_n_miss; }
+
+private:
+   const tlb_config &m_config;
+   unsigned m_sid;
+   class gpu_mmu *m_mmu;
+   tlb_array m_array;
+   std::map<new_addr_type,unsigned long long> m_pending; // vpn -> cycle of the miss
+
+   unsigned long long m_n_access;
+   unsigned long long m_n_miss;
+   unsigned long long m_n_pending_full; // misses that found no free pending entry
+   unsigned long long m_tot_miss_latency;
+   friend class gpu_mmu;
+};
+
+// shared L2 TLB and page table walkers
+class gpu_mmu {
+public:
+   gpu_mmu( const tlb_config &config, 
+            const class memory_config *mem_config, 
+            class memory_sub_partition **sub_partition );
+
+   const tlb_config &get_config() const { return m_config; }
+   void register_l1_tlb( l1_tlb *tlb ) { m_l1_tlb.push_back(tlb); }
+   void translate( l1_tlb *requester, new_addr_type vpn );
+   void cycle();
+   void walk_reply( class mem_fetch *mf );
+   void print_stats( FILE *fout ) const;
+
+private:
+   struct walker {
+      walker() : busy(false), vpn(0), level(0), waiting(false), start(0) {}
+      bool busy;
+      new_addr_type vpn;
+      unsigned level;     // page table level of the next PTE read
+      bool waiting;       // PTE read in flight
+      unsigned long long start;
+   };
+
+   new_addr_type pte_address( new_addr_type vpn, unsigned level ) const;
+   bool issue_pte_read( unsigned w );
+   void complete( new_addr_type vpn );
+
+   const tlb_config &m_config;
+   const class memory_config *m_memory_config;
+   class memory_sub_partition **m_sub_partition;
+   std::vector<l1_tlb*> m_l1_tlb;
+
+   tlb_array m_l2;
+   std::list<std::pair<new_addr_type,unsigned long long> > m_l2_pipe; // (vpn, ready cycle)
+   std::map<new_addr_type, std::vector<l1_tlb*> > m_waiting;           // requesters merged per vpn
+   std::list<new_addr_type> m_walk_queue;
+   std::vector<walker> m_walker;
+
+   // stats
+   unsigned long long m_n_l2_access;
+   unsigned long long m_n_l2_hit;
+   unsigned long long m_n_walks;
+   unsigned long long m_n_walks_done;
+   unsigned long long m_n_pte_reads;
+   unsigned long long m_pte_stalls;
+   unsigned long long m_tot_walk_latency;
+   unsigned long long m_max_walk_latency;
+   unsigned long long m_tot_walk_queue;
+};
+
+#endif
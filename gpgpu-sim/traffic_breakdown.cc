@@ -38,6 +38,9 @@ std::string traffic_breakdown::classify_memfetch(class mem_fetch * mf)
    case L2_WRBK_ACC:    
    case L1_WR_ALLOC_R:  
    case L2_WR_ALLOC_R:  
+   case DMA_ACC_R:      
+   case DMA_ACC_W:      
+   case PTW_ACC_R:      
       traffic_name = mem_access_type_str(access_type); 
       break; 
    case GLOBAL_ACC_R:   
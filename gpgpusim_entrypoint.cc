@@ -89,6 +89,7 @@ void *gpgpu_sim_thread_sequential(void*)
 }
 
 pthread_mutex_t g_sim_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t g_sim_idle_cond = PTHREAD_COND_INITIALIZER; // signaled when g_sim_active becomes false
 bool g_sim_active = false;
 bool g_sim_done = true; // outer while condition, means program finished,and over.
 
@@ -101,11 +102,10 @@ void *gpgpu_sim_thread_concurrent(void*)
     // concurrent kernel execution simulation thread
     do { // outer while
        if(g_debug_execution >= 3) {
-          printf("GPGPU-Sim: *** simulation thread starting and spinning waiting for work ***\n");
+          printf("GPGPU-Sim: *** simulation thread starting and waiting for work ***\n");
           fflush(stdout);
        }
-        while( g_stream_manager->empty_protected() && !g_sim_done )
-            ;
+        g_stream_manager->wait_for_work(&g_sim_done);
         if(g_debug_execution >= 3) {
            printf("GPGPU-Sim: ** START simulation thread (detected work) **\n");
            g_stream_manager->print(stdout);
@@ -131,7 +131,9 @@ void *gpgpu_sim_thread_concurrent(void*)
             if(g_stream_manager->operation(&sim_cycles) && !g_the_gpu->active())//-call m_gpu->print_stats(),output result
                 break; // go out of inner while
 
-            if( g_the_gpu->active() ) {
+            // copy engines keep the clock running even when no kernel is 
+            // resident so transfers from other streams make progress
+            if( g_the_gpu->active() || g_the_gpu->copy_engine_busy() ) {
                 g_the_gpu->cycle();
                 sim_cycles = true;
                 g_the_gpu->deadlock_check();
@@ -150,6 +152,7 @@ void *gpgpu_sim_thread_concurrent(void*)
         }
         pthread_mutex_lock(&g_sim_lock);// the lock can stop the program to continue;
         g_sim_active = false;
+        pthread_cond_broadcast(&g_sim_idle_cond);
         pthread_mutex_unlock(&g_sim_lock);
         outwhile++;
         fprintf(stderr,"[@@@]out while=%d, in while=%d \n",outwhile,inwhile); //-grep only dule with stdout.this mess can show without disturbed by grep.
@@ -172,12 +175,10 @@ void synchronize()
     g_stream_manager->print(stdout);
     fflush(stdout);
 //    sem_wait(&g_sim_signal_finish);
-    bool done = false;
-    do {
-        pthread_mutex_lock(&g_sim_lock);
-        done = g_stream_manager->empty() && !g_sim_active;
-        pthread_mutex_unlock(&g_sim_lock);
-    } while (!done);
+    pthread_mutex_lock(&g_sim_lock);
+    while( !g_stream_manager->empty() || g_sim_active ) 
+        pthread_cond_wait(&g_sim_idle_cond,&g_sim_lock);
+    pthread_mutex_unlock(&g_sim_lock);
     printf("GPGPU-Sim: detected inactive GPU simulation thread\n");
     fflush(stdout);
 //    sem_post(&g_sim_signal_start);
@@ -186,6 +187,7 @@ void synchronize()
 void exit_simulation()
 {
     g_sim_done=true;
+    g_stream_manager->wake_gpu_thread();
     printf("GPGPU-Sim: exit_simulation called\n");
     fflush(stdout);
     sem_wait(&g_sim_signal_exit);
@@ -195,50 +197,9 @@ void exit_simulation()
 
 extern bool g_cuda_launch_blocking;
 
-int  g_prefetch_rec_max_size=0; //-defined and inited here, used in "shader.cc:604"
-int  g_prefetch_interval    =0; //-defined and inited here, used in "shader.cc:605"
-int  g_prefetch_length      =0; //-defined and inited here, used in "shader.cc:606"
-long g_prefetch_mem         =0; //-defined and inited here, used in "shader.cc:607","gpu-sim.cc":883
-long g_prefetch             =0; //-defined and inited here, used in "shader.cc:607","gpu-sim.cc":883
-long g_fetch                =0; //-defined and inited here, used in "shader.cc:607","gpu-sim.cc":883
-long g_fetch_stage_cycles   =0; //-
-
-#include <fstream> 
-#include <cstdlib>
-using namespace std;
-void read_my_config(){ //-read my own global vars.
-    ifstream myfile("my_options.config"); //- open file.
-    if(!myfile){
-        printf("Unable to open myfile\n");
-        exit(1);// -quit sim ,return to OS.
-    }
-    else 
-        printf("Open my_options.config OK!\n");
-    char buffer[256];
-    char option_name[20];
-    int option_value;
-    // get rec len
-    myfile.getline (buffer,256); 
-    sscanf(buffer,"%s %d" , &option_name , &option_value);
-    g_prefetch_rec_max_size = option_value; //- init global var 'g_prefetch_rec_max_size'
-    printf("my_options.config :{%s   %d} g_prefetch_rec_max_size=%d\n",option_name,option_value,g_prefetch_rec_max_size);
-    // get begin pos
-    myfile.getline (buffer,256); 
-    sscanf(buffer,"%s %d" , &option_name , &option_value);
-    g_prefetch_interval = option_value; //- init global var 'g_prefetch_interval'
-    printf("my_options.config : {%s   %d}      g_prefetch_interval =%d\n", option_name , option_value,g_prefetch_interval);
-    // get prefetch length
-    myfile.getline (buffer,256); 
-    sscanf(buffer,"%s %d" , &option_name , &option_value);
-    g_prefetch_length = option_value; //- init global var 'g_prefetch_length'
-    printf("my_options.config : {%s   %d}      g_prefetch_length=%d\n", option_name , option_value,g_prefetch_length);
-    myfile.close();
-    printf("rec max size = %d; prefetch interval = %d; prefetch length=%d\n",g_prefetch_rec_max_size,g_prefetch_interval,g_prefetch_length);
-}
 gpgpu_sim *gpgpu_ptx_sim_init_perf()
 {
 	system("echo -e \"\\033[1;33m ******** gpgpu_ptx_sim_init_pref() begin **********\\033[0m\" ");
-   read_my_config();//-read my own vars from file 'my_options.config'
    srand(1);
    print_splash();
    read_sim_environment_variables(); //-read shell vars
@@ -306,8 +267,10 @@ void print_simulation_time()
    fflush(stdout); //-performence simulate output.
 }
 
+// OpenCL kernels do not go through the stream manager, so they are assembled here
 int gpgpu_opencl_ptx_sim_main_perf( kernel_info_t *grid )
 {
+   gpgpu_ptx_assemble_kernel( grid->entry() );
    g_the_gpu->launch(grid);
    sem_post(&g_sim_signal_start);
    sem_wait(&g_sim_signal_finish);
@@ -323,6 +286,7 @@ int gpgpu_opencl_ptx_sim_main_func( kernel_info_t *grid )
     //calling the CUDA PTX simulator, sending the kernel by reference and a flag set to true,
     //the flag used by the function to distinguish OpenCL calls from the CUDA simulation calls which
     //it is needed by the called function to not register the exit the exit of OpenCL kernel as it doesn't register entering in the first place as the CUDA kernels does
+   gpgpu_ptx_assemble_kernel( grid->entry() );
    gpgpu_cuda_ptx_sim_main_func( *grid, true );
    return 0;
 }
@@ -46,9 +46,15 @@
 #include "uca.h"
 
 #include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
 #include <iostream>
+#include <sstream>
 #include <algorithm>
 #include <list>
+#include <map>
 
 using namespace std;
 
@@ -681,7 +687,195 @@ void filter_data_arr(list<mem_array *> & curr_list)
  *    above results
  * 4. Cache model with least cost is picked from sol_list
  */
+/*
+ * Solution cache: the organization picked by solve() only depends on the
+ * input parameters, so results are memoized by the full InputParameter
+ * content.  Arrays with identical parameters share one solver run, and with
+ * cacti_solution_cache_open() the results are also appended to a file that
+ * later runs (e.g. the points of a power-enabled sweep) load at startup.
+ */
+struct cached_solution
+{
+  uca_org_t res;
+  bool      has_tag;
+  bool      has_data;
+  mem_array tag;
+  mem_array data;
+};
+
+static map<string, cached_solution> solution_cache;
+static int solution_cache_fd = -1;
+
+static const char     solution_cache_magic[8] = {'C','A','C','T','I','S','O','L'};
+static const uint32_t solution_cache_version  = 1;
+
+static string solution_key(const InputParameter & ip)
+{
+  ostringstream key;
+  key.precision(17);
+  key << ip.cache_sz << ' ' << ip.line_sz << ' ' << ip.assoc << ' ' << ip.nbanks << ' '
+      << ip.out_w << ' ' << ip.specific_tag << ' ' << ip.tag_w << ' ' << ip.access_mode << ' '
+      << ip.obj_func_dyn_energy << ' ' << ip.obj_func_dyn_power << ' '
+      << ip.obj_func_leak_power << ' ' << ip.obj_func_cycle_t << ' '
+      << ip.F_sz_nm << ' ' << ip.F_sz_um << ' '
+      << ip.num_rw_ports << ' ' << ip.num_rd_ports << ' ' << ip.num_wr_ports << ' '
+      << ip.num_se_rd_ports << ' ' << ip.num_search_ports << ' '
+      << ip.is_main_mem << ' ' << ip.is_cache << ' ' << ip.pure_ram << ' ' << ip.pure_cam << ' '
+      << ip.rpters_in_htree << ' ' << ip.ver_htree_wires_over_array << ' '
+      << ip.broadcast_addr_din_over_ver_htrees << ' ' << ip.temp << ' '
+      << ip.ram_cell_tech_type << ' ' << ip.peri_global_tech_type << ' '
+      << ip.data_arr_ram_cell_tech_type << ' ' << ip.data_arr_peri_global_tech_type << ' '
+      << ip.tag_arr_ram_cell_tech_type << ' ' << ip.tag_arr_peri_global_tech_type << ' '
+      << ip.burst_len << ' ' << ip.int_prefetch_w << ' ' << ip.page_sz_bits << ' '
+      << ip.ic_proj_type << ' ' << ip.wire_is_mat_type << ' ' << ip.wire_os_mat_type << ' '
+      << ip.wt << ' ' << ip.force_wiretype << ' ' << ip.nuca_cache_sz << ' '
+      << ip.ndbl << ' ' << ip.ndwl << ' ' << ip.nspd << ' ' << ip.ndsam1 << ' '
+      << ip.ndsam2 << ' ' << ip.ndcm << ' ' << ip.force_cache_config << ' '
+      << ip.cache_level << ' ' << ip.cores << ' ' << ip.nuca_bank_count << ' ' << ip.force_nuca_bank << ' '
+      << ip.delay_wt << ' ' << ip.dynamic_power_wt << ' ' << ip.leakage_power_wt << ' '
+      << ip.cycle_time_wt << ' ' << ip.area_wt << ' '
+      << ip.delay_wt_nuca << ' ' << ip.dynamic_power_wt_nuca << ' ' << ip.leakage_power_wt_nuca << ' '
+      << ip.cycle_time_wt_nuca << ' ' << ip.area_wt_nuca << ' '
+      << ip.delay_dev << ' ' << ip.dynamic_power_dev << ' ' << ip.leakage_power_dev << ' '
+      << ip.cycle_time_dev << ' ' << ip.area_dev << ' '
+      << ip.delay_dev_nuca << ' ' << ip.dynamic_power_dev_nuca << ' ' << ip.leakage_power_dev_nuca << ' '
+      << ip.cycle_time_dev_nuca << ' ' << ip.area_dev_nuca << ' '
+      << ip.ed << ' ' << ip.nuca << ' ' << ip.fast_access << ' ' << ip.block_sz << ' '
+      << ip.tag_assoc << ' ' << ip.data_assoc << ' ' << ip.is_seq_acc << ' ' << ip.fully_assoc << ' '
+      << ip.nsets << ' ' << ip.add_ecc_b_ << ' '
+      << ip.throughput << ' ' << ip.latency << ' ' << ip.pipelinable << ' '
+      << ip.pipeline_stages << ' ' << ip.per_stage_vector << ' ' << ip.with_clock_grid;
+  return key.str();
+}
+
+static uint64_t solution_checksum(const char * buf, size_t len)
+{
+  uint64_t h = 14695981039346656037ULL; // FNV-1a
+  for (size_t i = 0; i < len; i++)
+  {
+    h ^= (unsigned char)buf[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// record: key length, key, cached_solution bytes, checksum over all of it
+static void solution_cache_load(int fd)
+{
+  uint32_t key_len;
+  while (read(fd, &key_len, sizeof(key_len)) == sizeof(key_len) && key_len < 4096)
+  {
+    size_t len = sizeof(key_len) + key_len + sizeof(cached_solution);
+    char * buf = new char[len];
+    uint64_t sum;
+    memcpy(buf, &key_len, sizeof(key_len));
+    bool ok = read(fd, buf + sizeof(key_len), len - sizeof(key_len)) == (ssize_t)(len - sizeof(key_len)) &&
+              read(fd, &sum, sizeof(sum)) == sizeof(sum) &&
+              sum == solution_checksum(buf, len);
+    if (ok)
+    {
+      cached_solution sol;
+      memcpy((void *)&sol, buf + sizeof(key_len) + key_len, sizeof(sol));
+      sol.tag.arr_min  = NULL;
+      sol.data.arr_min = NULL;
+      solution_cache[string(buf + sizeof(key_len), key_len)] = sol;
+    }
+    delete [] buf;
+    if (!ok) break; // truncated or interleaved record, ignore the rest
+  }
+}
+
+void cacti_solution_cache_open(const char * file)
+{
+  if (solution_cache_fd >= 0 || file == NULL || !strcmp(file, "none")) return;
+
+  // the header ties the file to this CACTI build's result layout
+  char header[sizeof(solution_cache_magic) + 3*sizeof(uint32_t)];
+  uint32_t layout[3] = { solution_cache_version, (uint32_t)sizeof(uca_org_t), (uint32_t)sizeof(mem_array) };
+  memcpy(header, solution_cache_magic, sizeof(solution_cache_magic));
+  memcpy(header + sizeof(solution_cache_magic), layout, sizeof(layout));
+
+  int fd = open(file, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd < 0)
+  {
+    cout << "WARNING: cannot open CACTI solution cache " << file << endl;
+    return;
+  }
+  char found[sizeof(header)];
+  ssize_t n = read(fd, found, sizeof(found));
+  if (n == 0)
+  {
+    if (write(fd, header, sizeof(header)) != (ssize_t)sizeof(header))
+    {
+      close(fd);
+      return;
+    }
+  }
+  else if (n != (ssize_t)sizeof(header) || memcmp(found, header, sizeof(header)))
+  {
+    cout << "WARNING: CACTI solution cache " << file << " was written by a different build, not used" << endl;
+    close(fd);
+    return;
+  }
+  solution_cache_load(fd);
+  solution_cache_fd = fd;
+  cout << "CACTI solution cache " << file << ": " << solution_cache.size() << " solutions loaded" << endl;
+}
+
+static bool solution_cache_lookup(const string & key, uca_org_t * fin_res)
+{
+  map<string, cached_solution>::const_iterator s = solution_cache.find(key);
+  if (s == solution_cache.end()) return false;
+
+  // the caller owns (and may clean up) the arrays, hand out fresh copies
+  *fin_res = s->second.res;
+  fin_res->tag_array2  = s->second.has_tag  ? new mem_array(s->second.tag)  : NULL;
+  fin_res->data_array2 = s->second.has_data ? new mem_array(s->second.data) : NULL;
+  return true;
+}
+
+static void solution_cache_insert(const string & key, const uca_org_t & res)
+{
+  cached_solution & sol = solution_cache[key];
+  sol.res      = res;
+  sol.has_tag  = (res.tag_array2 != NULL);
+  sol.has_data = (res.data_array2 != NULL);
+  if (sol.has_tag)  sol.tag  = *res.tag_array2;
+  if (sol.has_data) sol.data = *res.data_array2;
+  sol.tag.arr_min  = NULL;
+  sol.data.arr_min = NULL;
+
+  if (solution_cache_fd < 0) return;
+  // one write() per record so that concurrent runs appending to the same file do not interleave
+  uint32_t key_len = key.size();
+  size_t len = sizeof(key_len) + key_len + sizeof(sol);
+  char * buf = new char[len + sizeof(uint64_t)];
+  memcpy(buf, &key_len, sizeof(key_len));
+  memcpy(buf + sizeof(key_len), key.data(), key_len);
+  memcpy(buf + sizeof(key_len) + key_len, (const void *)&sol, sizeof(sol));
+  uint64_t sum = solution_checksum(buf, len);
+  memcpy(buf + len, &sum, sizeof(sum));
+  if (write(solution_cache_fd, buf, len + sizeof(sum)) != (ssize_t)(len + sizeof(sum)))
+    cout << "WARNING: cannot write to CACTI solution cache" << endl;
+  delete [] buf;
+}
+
+
+static void solve_organizations(uca_org_t *fin_res);
+
 void solve(uca_org_t *fin_res)
+{
+  string key = solution_key(*g_ip);
+  if (solution_cache_lookup(key, fin_res))
+  {
+    init_tech_params(g_ip->F_sz_um, false); // technology state solve_organizations() leaves behind
+    return;
+  }
+  solve_organizations(fin_res);
+  solution_cache_insert(key, *fin_res);
+}
+
+static void solve_organizations(uca_org_t *fin_res)
 {
   int    pure_ram = g_ip->pure_ram;
   bool   pure_cam = g_ip->pure_cam;
@@ -383,6 +383,9 @@ class uca_org_t
 
 void reconfigure(InputParameter *local_interface, uca_org_t *fin_res);
 
+//reuse solve() results across identical arrays and runs, file "none" = in-memory only
+void cacti_solution_cache_open(const char * file);
+
 uca_org_t cacti_interface(const string & infile_name);
 //McPAT's plain interface, please keep !!!
 uca_org_t cacti_interface(InputParameter * const local_interface);
@@ -58,7 +58,7 @@ enum pwr_cmp_t {
 };
 
 
-gpgpu_sim_wrapper::gpgpu_sim_wrapper( bool power_simulation_enabled, char* xmlfile) {
+gpgpu_sim_wrapper::gpgpu_sim_wrapper( bool power_simulation_enabled, char* xmlfile, char* cacti_cache_file) {
 	   kernel_sample_count=0;
 	   total_sample_count=0;
 
@@ -83,6 +83,8 @@ gpgpu_sim_wrapper::gpgpu_sim_wrapper( bool power_simulation_enabled, char* xmlfi
 
 	   const_dynamic_power=0;
 	   proc_power=0;
+	   sample_dvfs_power=0;
+	   kernel_tot_scaled_power=0;
 
 	   g_power_filename = NULL;
 	   g_power_trace_filename = NULL;
@@ -101,6 +103,7 @@ gpgpu_sim_wrapper::gpgpu_sim_wrapper( bool power_simulation_enabled, char* xmlfi
 	   p=new ParseXML();
 	   if (g_power_simulation_enabled){
 	       p->parse(xml_filename);
+	       cacti_solution_cache_open(cacti_cache_file);
 	   }
 	   proc = new Processor(p);
 	   power_trace_file = NULL;
@@ -232,6 +235,11 @@ void gpgpu_sim_wrapper::reset_counters(){
 	kernel_sample_count = 0;
 	kernel_tot_power = 0;
 	kernel_power = init;
+	kernel_tot_scaled_power = 0;
+	for(unsigned i=0; i<kernel_core_pwr.size(); ++i)
+		kernel_core_pwr[i] = 0;
+	for(unsigned i=0; i<kernel_mem_pwr.size(); ++i)
+		kernel_mem_pwr[i] = 0;
 
 	return;
 }
@@ -378,6 +386,36 @@ void gpgpu_sim_wrapper::set_active_lanes_power(double sp_avg_active_lane, double
 	p->sys.core[0].sfu_average_active_lanes = sfu_avg_active_lane;
 }
 
+void gpgpu_sim_wrapper::set_core_activity(unsigned sid, const std::vector<double> &counters)
+{
+	if(sid >= core_perf_counters.size()){
+		core_perf_counters.resize(sid+1, std::vector<double>(NUM_PERFORMANCE_COUNTERS, 0));
+		core_power_scale.resize(sid+1, 1.0);
+		sample_core_pwr.resize(sid+1, 0);
+		kernel_core_pwr.resize(sid+1, 0);
+	}
+	core_perf_counters[sid] = counters;
+}
+
+void gpgpu_sim_wrapper::set_mem_activity(unsigned mid, double reads, double writes, double dram_precharge)
+{
+	if(mid >= mem_perf_counters.size()){
+		mem_perf_counters.resize(mid+1, std::vector<double>(NUM_PERFORMANCE_COUNTERS, 0));
+		sample_mem_pwr.resize(mid+1, 0);
+		kernel_mem_pwr.resize(mid+1, 0);
+	}
+	mem_perf_counters[mid][MEM_RD] = reads;
+	mem_perf_counters[mid][MEM_WR] = writes;
+	mem_perf_counters[mid][MEM_PRE] = dram_precharge;
+}
+
+void gpgpu_sim_wrapper::set_core_power_scale(unsigned sid, double scale)
+{
+	if(sid >= core_power_scale.size())
+		core_power_scale.resize(sid+1, 1.0);
+	core_power_scale[sid] = scale;
+}
+
 void gpgpu_sim_wrapper::set_NoC_power(double noc_tot_reads, double noc_tot_writes )
 {
 	p->sys.NoC[0].total_accesses = noc_tot_reads * p->sys.scaling_coefficients[NOC_A] + noc_tot_writes * p->sys.scaling_coefficients[NOC_A];
@@ -393,6 +431,12 @@ void gpgpu_sim_wrapper::power_metrics_calculations()
     // Current sample power
     double sample_power = proc->rt_power.readOp.dynamic + sample_cmp_pwr[CONST_DYNAMICP];
 
+    kernel_tot_scaled_power += sample_dvfs_power;
+    for(unsigned i=0; i<sample_core_pwr.size(); ++i)
+        kernel_core_pwr[i] += sample_core_pwr[i];
+    for(unsigned i=0; i<sample_mem_pwr.size(); ++i)
+        kernel_mem_pwr[i] += sample_mem_pwr[i];
+
     // Average power
     // Previous + new + constant dynamic power (e.g., dynamic clocking power)
     kernel_tot_power += sample_power;
@@ -604,6 +648,35 @@ void gpgpu_sim_wrapper::update_components_power()
 	check=sanity_check(sum_pwr_cmp,proc_power);
 	assert("Total Power does not equal the sum of the components\n" && (check));
 
+	update_instance_power();
+}
+
+// The component model above is evaluated for one representative core, memory
+// controller and L2 bank. Split its per-event energy over the instances by
+// applying the per-access coefficients to every SM's and DRAM channel's own
+// counts. The L1, L2 and NoC counters are only kept GPU-wide, so they are not
+// part of the split.
+void gpgpu_sim_wrapper::update_instance_power()
+{
+	static const perf_count_t core_counters[] = {TOT_INST, FP_INT, REG_RD, REG_WR, NON_REG_OPs,
+			SHRD_ACC, SP_ACC, SFU_ACC, FPU_ACC};
+	static const perf_count_t mem_counters[] = {MEM_RD, MEM_WR, MEM_PRE};
+
+	double dvfs_saving=0;
+	for(unsigned sid=0; sid<core_perf_counters.size(); ++sid){
+		double pwr=0;
+		for(unsigned i=0; i<sizeof(core_counters)/sizeof(core_counters[0]); ++i)
+			pwr += effpower_coeff[core_counters[i]] * core_perf_counters[sid][core_counters[i]];
+		sample_core_pwr[sid] = pwr * core_power_scale[sid];
+		dvfs_saving += pwr - sample_core_pwr[sid];
+	}
+	for(unsigned mid=0; mid<mem_perf_counters.size(); ++mid){
+		double pwr=0;
+		for(unsigned i=0; i<sizeof(mem_counters)/sizeof(mem_counters[0]); ++i)
+			pwr += effpower_coeff[mem_counters[i]] * mem_perf_counters[mid][mem_counters[i]];
+		sample_mem_pwr[mid] = pwr;
+	}
+	sample_dvfs_power = proc_power - dvfs_saving;
 }
 
 void gpgpu_sim_wrapper::compute()
@@ -646,6 +719,25 @@ void gpgpu_sim_wrapper::print_power_kernel_stats(double gpu_sim_cycle, double gp
 				powerfile<<"gpu_min_"<<perf_count_label[i]<<" = "<<kernel_cmp_perf_counters[i].min<<std::endl;
 		   }
 
+		   if(kernel_sample_count){
+			   powerfile<<std::endl<<"Kernel Per-SM and Per-Channel Average Dynamic Power:"<<std::endl;
+			   for(unsigned i=0; i<kernel_core_pwr.size(); ++i){
+				   powerfile<<"sm_avg_power["<<i<<"] = "<<kernel_core_pwr[i]/kernel_sample_count<<std::endl;
+			   }
+			   for(unsigned i=0; i<kernel_mem_pwr.size(); ++i){
+				   powerfile<<"mem_avg_power["<<i<<"] = "<<kernel_mem_pwr[i]/kernel_sample_count<<std::endl;
+			   }
+
+			   // Energy-delay product, with per-SM dynamic power scaled by DVFS
+			   double kernel_time = gpu_sim_cycle/(p->sys.target_core_clockrate*1e6);
+			   double kernel_energy = kernel_tot_scaled_power/kernel_sample_count*kernel_time;
+			   powerfile<<std::endl<<"Kernel Energy Data:"<<std::endl;
+			   powerfile<<"kernel_dvfs_avg_power = "<<kernel_tot_scaled_power/kernel_sample_count<<std::endl;
+			   powerfile<<"kernel_time = "<<kernel_time<<std::endl;
+			   powerfile<<"kernel_energy = "<<kernel_energy<<std::endl;
+			   powerfile<<"kernel_edp = "<<kernel_energy*kernel_time<<std::endl;
+		   }
+
 		   powerfile<<std::endl<<"Accumulative Power Statistics Over Previous Kernels:"<<std::endl;
 		   powerfile<<"gpu_tot_avg_power = "<< gpu_tot_power.avg/total_sample_count<<std::endl;
 		   powerfile<<"gpu_tot_max_power = "<<gpu_tot_power.max<<std::endl;
@@ -52,7 +52,7 @@ struct avg_max_min_counters{
 
 class gpgpu_sim_wrapper {
 public:
-	gpgpu_sim_wrapper(bool power_simulation_enabled, char* xmlfile);
+	gpgpu_sim_wrapper(bool power_simulation_enabled, char* xmlfile, char* cacti_cache_file);
 	~gpgpu_sim_wrapper();
 
 	void init_mcpat(char* xmlfile, char* powerfile, char* power_trace_file,char* metric_trace_file,
@@ -85,10 +85,18 @@ public:
 	void set_active_lanes_power(double sp_avg_active_lane, double sfu_avg_active_lane);
 	void set_NoC_power(double noc_tot_reads, double noc_tot_write);
 	bool sanity_check(double a, double b);
+	// Per-SM (counters indexed by perf_count_t) and per-DRAM-channel activity of the current sample
+	void set_core_activity(unsigned sid, const std::vector<double> &counters);
+	void set_mem_activity(unsigned mid, double reads, double writes, double dram_precharge);
+	// Fraction of its nominal dynamic power an SM burns under DVFS, (V/Vnom)^2
+	void set_core_power_scale(unsigned sid, double scale);
+	// Last sample's total power with the DVFS voltage scaling applied
+	double get_sample_power() const { return sample_dvfs_power; }
 
 private:
 
 	void print_steady_state(int position, double init_val);
+	void update_instance_power();
 
 	Processor* proc;
 	ParseXML * p;
@@ -110,6 +118,17 @@ private:
 
     bool has_written_avg;
 
+    // Per-SM and per-DRAM-channel breakdown
+    std::vector< std::vector<double> > core_perf_counters; // [sid][perf_count_t], current sample
+    std::vector< std::vector<double> > mem_perf_counters; // [channel][perf_count_t], current sample
+    std::vector<double> core_power_scale; // [sid] DVFS (V/Vnom)^2
+    std::vector<double> sample_core_pwr; // [sid] current sample dynamic power
+    std::vector<double> sample_mem_pwr; // [channel] current sample dynamic power
+    std::vector<double> kernel_core_pwr; // [sid] per-kernel sum of sample powers
+    std::vector<double> kernel_mem_pwr; // [channel] per-kernel sum of sample powers
+    double sample_dvfs_power; // current sample total power, DVFS scaled
+    double kernel_tot_scaled_power; // per-kernel sum of sample_dvfs_power
+
     std::vector<double> sample_cmp_pwr; // Current sample component powers
     std::vector<double> sample_perf_counters; // Current sample component perf. counts
     std::vector<double> initpower_coeff;
@@ -32,6 +32,8 @@
 #include "gputrafficmanager.hpp"
 #include "interconnect_interface.hpp"
 #include "globals.hpp"
+#include "network.hpp"
+#include "router.hpp"
 
 
 GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<Network *> &net)
@@ -47,10 +49,134 @@ GPUTrafficManager::GPUTrafficManager( const Configuration &config, const vector<
       _input_queue[subnet][node].resize(_classes);
     }
   }
+  
+  _input_queue_flits.resize(_subnets);
+  for ( int subnet = 0; subnet < _subnets; ++subnet) {
+    _input_queue_flits[subnet].resize(_nodes, 0);
+  }
+  
+  _step_ejected_flits.resize(_subnets);
+  for ( int subnet = 0; subnet < _subnets; ++subnet) {
+    _step_ejected_flits[subnet].resize(_nodes, NULL);
+  }
+  
+  _step_threads = config.GetInt("parallel_step_threads");
+  if ( (_step_threads > 1) && !_ParallelStepSupported(config) ) {
+    cout << "WARNING: parallel_step_threads ignored, this network configuration "
+         << "is not deterministic when stepped in parallel." << endl;
+    _step_threads = 1;
+  }
+  if ( _step_threads > 1 ) {
+    _CreateStepWorkers();
+  }
 }
 
 GPUTrafficManager::~GPUTrafficManager()
 {
+  if ( _step_threads > 1 ) {
+    _RunStepPhase(_phase_exit);
+    for ( size_t t = 0; t < _step_workers.size(); ++t ) {
+      pthread_join(_step_workers[t], NULL);
+    }
+    pthread_barrier_destroy(&_step_start);
+    pthread_barrier_destroy(&_step_done);
+    Credit::SetThreadSafe(false);
+  }
+}
+
+// Routers and channels only touch their own state and the channel ends they
+// own during a phase, so they can be stepped in any order as long as nothing
+// draws from the shared random number generator or writes the watch/trace
+// streams.  The torus DOR functions are left out: dor_next_torus() breaks
+// ties and picks the VC set with RandomInt().
+bool GPUTrafficManager::_ParallelStepSupported( const Configuration &config ) const
+{
+  if ( gTrace || gWatchOut ) {
+    return false;
+  }
+  if ( config.GetStr("router") != "iq" ) {
+    return false;
+  }
+  if ( (config.GetStr("vc_allocator") == "pim") || (config.GetStr("sw_allocator") == "pim") ) {
+    return false;
+  }
+  string const rf = config.GetStr("routing_function") + "_" + config.GetStr("topology");
+  return ( (rf == "dim_order_mesh") || (rf == "dor_mesh") ||
+           (rf == "dim_order_ni_mesh") || (rf == "dest_tag_fly") ||
+           (rf == "nca_qtree") );
+}
+
+void GPUTrafficManager::_CreateStepWorkers( )
+{
+  // spread the routers evenly first, then the channels, over the workers
+  _step_modules.resize(_step_threads);
+  int next_router = 0;
+  int next_channel = 0;
+  for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+    deque<TimedModule *> const & modules = _net[subnet]->GetTimedModules();
+    for ( deque<TimedModule *>::const_iterator iter = modules.begin(); iter != modules.end(); ++iter ) {
+      if ( dynamic_cast<Router *>(*iter) ) {
+        _step_modules[next_router].push_back(*iter);
+        next_router = (next_router + 1) % _step_threads;
+      } else {
+        _step_modules[next_channel].push_back(*iter);
+        next_channel = (next_channel + 1) % _step_threads;
+      }
+    }
+  }
+  
+  Credit::SetThreadSafe(true);
+  pthread_barrier_init(&_step_start, NULL, _step_threads);
+  pthread_barrier_init(&_step_done, NULL, _step_threads);
+  _step_workers.resize(_step_threads - 1);
+  for ( int t = 1; t < _step_threads; ++t ) {
+    pthread_create(&_step_workers[t - 1], NULL, _StepWorker, new pair<GPUTrafficManager *, int>(this, t));
+  }
+  cout << "GPGPU-Sim: intersim2 stepping " << _subnets << " subnet(s) with "
+       << _step_threads << " threads" << endl;
+}
+
+void * GPUTrafficManager::_StepWorker( void * arg )
+{
+  pair<GPUTrafficManager *, int> * const worker = static_cast<pair<GPUTrafficManager *, int> *>(arg);
+  GPUTrafficManager * const tm = worker->first;
+  int const id = worker->second;
+  delete worker;
+  
+  while ( true ) {
+    pthread_barrier_wait(&tm->_step_start);
+    _StepPhase const phase = tm->_step_phase;
+    if ( phase == _phase_exit ) {
+      break;
+    }
+    tm->_StepModules(id, phase);
+    pthread_barrier_wait(&tm->_step_done);
+  }
+  return NULL;
+}
+
+void GPUTrafficManager::_RunStepPhase( _StepPhase phase )
+{
+  _step_phase = phase;
+  pthread_barrier_wait(&_step_start);
+  if ( phase == _phase_exit ) {
+    return;
+  }
+  _StepModules(0, phase);
+  pthread_barrier_wait(&_step_done);
+}
+
+void GPUTrafficManager::_StepModules( int worker, _StepPhase phase )
+{
+  vector<TimedModule *> const & modules = _step_modules[worker];
+  for ( vector<TimedModule *>::const_iterator iter = modules.begin(); iter != modules.end(); ++iter ) {
+    switch ( phase ) {
+      case _phase_read_inputs:   (*iter)->ReadInputs();   break;
+      case _phase_evaluate:      (*iter)->Evaluate();     break;
+      case _phase_write_outputs: (*iter)->WriteOutputs(); break;
+      default: assert(0);
+    }
+  }
 }
 
 void GPUTrafficManager::Init()
@@ -275,7 +401,8 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
     f->ctime  = time;
     f->record = record;
     f->cl     = cl;
-    f->data = data;
+    // only the tail flit hands the packet over at the boundary buffer
+    f->data = ( i == ( size - 1 ) ) ? data : NULL;
     
     _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
     if(record) {
@@ -329,6 +456,7 @@ void GPUTrafficManager::_GeneratePacket(int source, int stype, int cl, int time,
     }
     
     _input_queue[subnet][source][cl].push_back( f );
+    ++_input_queue_flits[subnet][source];
   }
 }
 
@@ -343,334 +471,366 @@ void GPUTrafficManager::_Step()
     cout << "WARNING: Possible network deadlock.\n";
   }
   
-  vector<map<int, Flit *> > flits(_subnets);
+  if ( _step_threads > 1 ) {
+    // subnets are independent, so all interface work is done first and the
+    // networks are then stepped together, phase by phase
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      _StepEject(subnet);
+    }
+    _RunStepPhase(_phase_read_inputs);
+    
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      _StepInject(subnet);
+    }
+    
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      _StepRetire(subnet);
+    }
+    _RunStepPhase(_phase_evaluate);
+    _RunStepPhase(_phase_write_outputs);
+  } else {
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      _StepEject(subnet);
+      _net[subnet]->ReadInputs( );
+    }
+    
+// GPGPUSim will generate/inject packets from interconnection interface
+#if 0
+    if ( !_empty_network ) {
+      _Inject();
+    }
+#endif
+    
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      _StepInject(subnet);
+    }
+    
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+      _StepRetire(subnet);
+      // _InteralStep here
+      _net[subnet]->Evaluate( );
+      _net[subnet]->WriteOutputs( );
+    }
+  }
+  
+  ++_time;
+  assert(_time);
+  if(gTrace){
+    cout<<"TIME "<<_time<<endl;
+  }
   
-  for ( int subnet = 0; subnet < _subnets; ++subnet ) {
-    for ( int n = 0; n < _nodes; ++n ) {
-      Flit * const f = _net[subnet]->ReadFlit( n );
-      if ( f ) {
-        if(f->watch) {
-          *gWatchOut << GetSimTime() << " | "
-          << "node" << n << " | "
-          << "Ejecting flit " << f->id
-          << " (packet " << f->pid << ")"
-          << " from VC " << f->vc
-          << "." << endl;
-        }
-        g_icnt_interface->WriteOutBuffer(subnet, n, f);
+}
+
+void GPUTrafficManager::_StepEject( int subnet )
+{
+  for ( int n = 0; n < _nodes; ++n ) {
+    Flit * const f = _net[subnet]->ReadFlit( n );
+    if ( f ) {
+      if(f->watch) {
+        *gWatchOut << GetSimTime() << " | "
+        << "node" << n << " | "
+        << "Ejecting flit " << f->id
+        << " (packet " << f->pid << ")"
+        << " from VC " << f->vc
+        << "." << endl;
       }
-      
-      g_icnt_interface->Transfer2BoundaryBuffer(subnet, n);
-      Flit* const ejected_flit = g_icnt_interface->GetEjectedFlit(subnet, n);
-      if (ejected_flit) {
-        if(ejected_flit->head)
-          assert(ejected_flit->dest == n);
-        if(ejected_flit->watch) {
-          *gWatchOut << GetSimTime() << " | "
-          << "node" << n << " | "
-          << "Ejected flit " << ejected_flit->id
-          << " (packet " << ejected_flit->pid
-          << " VC " << ejected_flit->vc << ")"
-          << "from ejection buffer." << endl;
-        }
-        flits[subnet].insert(make_pair(n, ejected_flit));
-        if((_sim_state == warming_up) || (_sim_state == running)) {
-          ++_accepted_flits[ejected_flit->cl][n];
-          if(ejected_flit->tail) {
-            ++_accepted_packets[ejected_flit->cl][n];
-          }
+      g_icnt_interface->WriteOutBuffer(subnet, n, f);
+    }
+    
+    g_icnt_interface->Transfer2BoundaryBuffer(subnet, n);
+    Flit* const ejected_flit = g_icnt_interface->GetEjectedFlit(subnet, n);
+    if (ejected_flit) {
+      if(ejected_flit->head)
+        assert(ejected_flit->dest == n);
+      if(ejected_flit->watch) {
+        *gWatchOut << GetSimTime() << " | "
+        << "node" << n << " | "
+        << "Ejected flit " << ejected_flit->id
+        << " (packet " << ejected_flit->pid
+        << " VC " << ejected_flit->vc << ")"
+        << "from ejection buffer." << endl;
+      }
+      _step_ejected_flits[subnet][n] = ejected_flit;
+      if((_sim_state == warming_up) || (_sim_state == running)) {
+        ++_accepted_flits[ejected_flit->cl][n];
+        if(ejected_flit->tail) {
+          ++_accepted_packets[ejected_flit->cl][n];
         }
       }
-    
-      // Processing the credit From the network
-      Credit * const c = _net[subnet]->ReadCredit( n );
-      if ( c ) {
+    }
+  
+    // Processing the credit From the network
+    Credit * const c = _net[subnet]->ReadCredit( n );
+    if ( c ) {
 #ifdef TRACK_FLOWS
-        for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-          int const vc = *iter;
-          assert(!_outstanding_classes[n][subnet][vc].empty());
-          int cl = _outstanding_classes[n][subnet][vc].front();
-          _outstanding_classes[n][subnet][vc].pop();
-          assert(_outstanding_credits[cl][subnet][n] > 0);
-          --_outstanding_credits[cl][subnet][n];
-        }
-#endif
-        _buf_states[n][subnet]->ProcessCredit(c);
-        c->Free();
+      for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
+        int const vc = *iter;
+        assert(!_outstanding_classes[n][subnet][vc].empty());
+        int cl = _outstanding_classes[n][subnet][vc].front();
+        _outstanding_classes[n][subnet][vc].pop();
+        assert(_outstanding_credits[cl][subnet][n] > 0);
+        --_outstanding_credits[cl][subnet][n];
       }
+#endif
+      _buf_states[n][subnet]->ProcessCredit(c);
+      c->Free();
     }
-    _net[subnet]->ReadInputs( );
   }
+}
 
-// GPGPUSim will generate/inject packets from interconnection interface
-#if 0
-  if ( !_empty_network ) {
-    _Inject();
-  }
-#endif
-  
-  for(int subnet = 0; subnet < _subnets; ++subnet) {
+void GPUTrafficManager::_StepInject( int subnet )
+{
+  for(int n = 0; n < _nodes; ++n) {
+    
+    Flit * f = NULL;
     
-    for(int n = 0; n < _nodes; ++n) {
+    BufferState * const dest_buf = _buf_states[n][subnet];
+    
+    int const last_class = _last_class[n][subnet];
+    
+    int class_limit = _classes;
+    
+    if(_hold_switch_for_packet) {
+      list<Flit *> const & pp = _input_queue[subnet][n][last_class];
+      if(!pp.empty() && !pp.front()->head &&
+         !dest_buf->IsFullFor(pp.front()->vc)) {
+        f = pp.front();
+        assert(f->vc == _last_vc[n][subnet][last_class]);
+        
+        // if we're holding the connection, we don't need to check that class
+        // again in the for loop
+        --class_limit;
+      }
+    }
+    
+    for(int i = 1; i <= class_limit; ++i) {
       
-      Flit * f = NULL;
+      int const c = (last_class + i) % _classes;
       
-      BufferState * const dest_buf = _buf_states[n][subnet];
+      list<Flit *> const & pp = _input_queue[subnet][n][c];
       
-      int const last_class = _last_class[n][subnet];
+      if(pp.empty()) {
+        continue;
+      }
       
-      int class_limit = _classes;
+      Flit * const cf = pp.front();
+      assert(cf);
+      assert(cf->cl == c);
       
-      if(_hold_switch_for_packet) {
-        list<Flit *> const & pp = _input_queue[subnet][n][last_class];
-        if(!pp.empty() && !pp.front()->head &&
-           !dest_buf->IsFullFor(pp.front()->vc)) {
-          f = pp.front();
-          assert(f->vc == _last_vc[n][subnet][last_class]);
-          
-          // if we're holding the connection, we don't need to check that class
-          // again in the for loop
-          --class_limit;
-        }
+      assert(cf->subnetwork == subnet);
+      
+      if(f && (f->pri >= cf->pri)) {
+        continue;
       }
       
-      for(int i = 1; i <= class_limit; ++i) {
-        
-        int const c = (last_class + i) % _classes;
-        
-        list<Flit *> const & pp = _input_queue[subnet][n][c];
+      if(cf->head && cf->vc == -1) { // Find first available VC
         
-        if(pp.empty()) {
-          continue;
+        OutputSet route_set;
+        _rf(NULL, cf, -1, &route_set, true);
+        set<OutputSet::sSetElement> const & os = route_set.GetSet();
+        assert(os.size() == 1);
+        OutputSet::sSetElement const & se = *os.begin();
+        assert(se.output_port == -1);
+        int vc_start = se.vc_start;
+        int vc_end = se.vc_end;
+        int vc_count = vc_end - vc_start + 1;
+        if(_noq) {
+          assert(_lookahead_routing);
+          const FlitChannel * inject = _net[subnet]->GetInject(n);
+          const Router * router = inject->GetSink();
+          assert(router);
+          int in_channel = inject->GetSinkPort();
+          
+          // NOTE: Because the lookahead is not for injection, but for the
+          // first hop, we have to temporarily set cf's VC to be non-negative
+          // in order to avoid seting of an assertion in the routing function.
+          cf->vc = vc_start;
+          _rf(router, cf, in_channel, &cf->la_route_set, false);
+          cf->vc = -1;
+          
+          if(cf->watch) {
+            *gWatchOut << GetSimTime() << " | "
+            << "node" << n << " | "
+            << "Generating lookahead routing info for flit " << cf->id
+            << " (NOQ)." << endl;
+          }
+          set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+          assert(sl.size() == 1);
+          int next_output = sl.begin()->output_port;
+          vc_count /= router->NumOutputs();
+          vc_start += next_output * vc_count;
+          vc_end = vc_start + vc_count - 1;
+          assert(vc_start >= se.vc_start && vc_start <= se.vc_end);
+          assert(vc_end >= se.vc_start && vc_end <= se.vc_end);
+          assert(vc_start <= vc_end);
         }
-        
-        Flit * const cf = pp.front();
-        assert(cf);
-        assert(cf->cl == c);
-        
-        assert(cf->subnetwork == subnet);
-        
-        if(f && (f->pri >= cf->pri)) {
-          continue;
+        if(cf->watch) {
+          *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+          << "Finding output VC for flit " << cf->id
+          << ":" << endl;
         }
-        
-        if(cf->head && cf->vc == -1) { // Find first available VC
-          
-          OutputSet route_set;
-          _rf(NULL, cf, -1, &route_set, true);
-          set<OutputSet::sSetElement> const & os = route_set.GetSet();
-          assert(os.size() == 1);
-          OutputSet::sSetElement const & se = *os.begin();
-          assert(se.output_port == -1);
-          int vc_start = se.vc_start;
-          int vc_end = se.vc_end;
-          int vc_count = vc_end - vc_start + 1;
-          if(_noq) {
-            assert(_lookahead_routing);
-            const FlitChannel * inject = _net[subnet]->GetInject(n);
-            const Router * router = inject->GetSink();
-            assert(router);
-            int in_channel = inject->GetSinkPort();
-            
-            // NOTE: Because the lookahead is not for injection, but for the
-            // first hop, we have to temporarily set cf's VC to be non-negative
-            // in order to avoid seting of an assertion in the routing function.
-            cf->vc = vc_start;
-            _rf(router, cf, in_channel, &cf->la_route_set, false);
-            cf->vc = -1;
-            
+        for(int i = 1; i <= vc_count; ++i) {
+          int const lvc = _last_vc[n][subnet][c];
+          int const vc =
+          (lvc < vc_start || lvc > vc_end) ?
+          vc_start :
+          (vc_start + (lvc - vc_start + i) % vc_count);
+          assert((vc >= vc_start) && (vc <= vc_end));
+          if(!dest_buf->IsAvailableFor(vc)) {
             if(cf->watch) {
-              *gWatchOut << GetSimTime() << " | "
-              << "node" << n << " | "
-              << "Generating lookahead routing info for flit " << cf->id
-              << " (NOQ)." << endl;
+              *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+              << "  Output VC " << vc << " is busy." << endl;
             }
-            set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
-            assert(sl.size() == 1);
-            int next_output = sl.begin()->output_port;
-            vc_count /= router->NumOutputs();
-            vc_start += next_output * vc_count;
-            vc_end = vc_start + vc_count - 1;
-            assert(vc_start >= se.vc_start && vc_start <= se.vc_end);
-            assert(vc_end >= se.vc_start && vc_end <= se.vc_end);
-            assert(vc_start <= vc_end);
-          }
-          if(cf->watch) {
-            *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-            << "Finding output VC for flit " << cf->id
-            << ":" << endl;
-          }
-          for(int i = 1; i <= vc_count; ++i) {
-            int const lvc = _last_vc[n][subnet][c];
-            int const vc =
-            (lvc < vc_start || lvc > vc_end) ?
-            vc_start :
-            (vc_start + (lvc - vc_start + i) % vc_count);
-            assert((vc >= vc_start) && (vc <= vc_end));
-            if(!dest_buf->IsAvailableFor(vc)) {
+          } else {
+            if(dest_buf->IsFullFor(vc)) {
               if(cf->watch) {
                 *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-                << "  Output VC " << vc << " is busy." << endl;
+                << "  Output VC " << vc << " is full." << endl;
               }
             } else {
-              if(dest_buf->IsFullFor(vc)) {
-                if(cf->watch) {
-                  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-                  << "  Output VC " << vc << " is full." << endl;
-                }
-              } else {
-                if(cf->watch) {
-                  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-                  << "  Selected output VC " << vc << "." << endl;
-                }
-                cf->vc = vc;
-                break;
+              if(cf->watch) {
+                *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+                << "  Selected output VC " << vc << "." << endl;
               }
+              cf->vc = vc;
+              break;
             }
           }
         }
-        
-        if(cf->vc == -1) {
+      }
+      
+      if(cf->vc == -1) {
+        if(cf->watch) {
+          *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+          << "No output VC found for flit " << cf->id
+          << "." << endl;
+        }
+      } else {
+        if(dest_buf->IsFullFor(cf->vc)) {
           if(cf->watch) {
             *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-            << "No output VC found for flit " << cf->id
+            << "Selected output VC " << cf->vc
+            << " is full for flit " << cf->id
             << "." << endl;
           }
         } else {
-          if(dest_buf->IsFullFor(cf->vc)) {
-            if(cf->watch) {
-              *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-              << "Selected output VC " << cf->vc
-              << " is full for flit " << cf->id
-              << "." << endl;
-            }
-          } else {
-            f = cf;
-          }
+          f = cf;
         }
       }
+    }
+    
+    if(f) {
       
-      if(f) {
-        
-        assert(f->subnetwork == subnet);
-        
-        int const c = f->cl;
+      assert(f->subnetwork == subnet);
+      
+      int const c = f->cl;
+      
+      if(f->head) {
         
-        if(f->head) {
-          
-          if (_lookahead_routing) {
-            if(!_noq) {
-              const FlitChannel * inject = _net[subnet]->GetInject(n);
-              const Router * router = inject->GetSink();
-              assert(router);
-              int in_channel = inject->GetSinkPort();
-              _rf(router, f, in_channel, &f->la_route_set, false);
-              if(f->watch) {
-                *gWatchOut << GetSimTime() << " | "
-                << "node" << n << " | "
-                << "Generating lookahead routing info for flit " << f->id
-                << "." << endl;
-              }
-            } else if(f->watch) {
+        if (_lookahead_routing) {
+          if(!_noq) {
+            const FlitChannel * inject = _net[subnet]->GetInject(n);
+            const Router * router = inject->GetSink();
+            assert(router);
+            int in_channel = inject->GetSinkPort();
+            _rf(router, f, in_channel, &f->la_route_set, false);
+            if(f->watch) {
               *gWatchOut << GetSimTime() << " | "
               << "node" << n << " | "
-              << "Already generated lookahead routing info for flit " << f->id
-              << " (NOQ)." << endl;
+              << "Generating lookahead routing info for flit " << f->id
+              << "." << endl;
             }
-          } else {
-            f->la_route_set.Clear();
+          } else if(f->watch) {
+            *gWatchOut << GetSimTime() << " | "
+            << "node" << n << " | "
+            << "Already generated lookahead routing info for flit " << f->id
+            << " (NOQ)." << endl;
           }
-          
-          dest_buf->TakeBuffer(f->vc);
-          _last_vc[n][subnet][c] = f->vc;
+        } else {
+          f->la_route_set.Clear();
         }
         
-        _last_class[n][subnet] = c;
-        
-        _input_queue[subnet][n][c].pop_front();
-        
+        dest_buf->TakeBuffer(f->vc);
+        _last_vc[n][subnet][c] = f->vc;
+      }
+      
+      _last_class[n][subnet] = c;
+      
+      _input_queue[subnet][n][c].pop_front();
+      --_input_queue_flits[subnet][n];
+      
 #ifdef TRACK_FLOWS
-        ++_outstanding_credits[c][subnet][n];
-        _outstanding_classes[n][subnet][f->vc].push(c);
+      ++_outstanding_credits[c][subnet][n];
+      _outstanding_classes[n][subnet][f->vc].push(c);
 #endif
-        
-        dest_buf->SendingFlit(f);
-        
-        if(_pri_type == network_age_based) {
-          f->pri = numeric_limits<int>::max() - _time;
-          assert(f->pri >= 0);
-        }
-        
-        if(f->watch) {
-          *gWatchOut << GetSimTime() << " | "
-          << "node" << n << " | "
-          << "Injecting flit " << f->id
-          << " into subnet " << subnet
-          << " at time " << _time
-          << " with priority " << f->pri
-          << "." << endl;
-        }
-        f->itime = _time;
-        
-        // Pass VC "back"
-        if(!_input_queue[subnet][n][c].empty() && !f->tail) {
-          Flit * const nf = _input_queue[subnet][n][c].front();
-          nf->vc = f->vc;
-        }
-        
-        if((_sim_state == warming_up) || (_sim_state == running)) {
-          ++_sent_flits[c][n];
-          if(f->head) {
-            ++_sent_packets[c][n];
-          }
+      
+      dest_buf->SendingFlit(f);
+      
+      if(_pri_type == network_age_based) {
+        f->pri = numeric_limits<int>::max() - _time;
+        assert(f->pri >= 0);
+      }
+      
+      if(f->watch) {
+        *gWatchOut << GetSimTime() << " | "
+        << "node" << n << " | "
+        << "Injecting flit " << f->id
+        << " into subnet " << subnet
+        << " at time " << _time
+        << " with priority " << f->pri
+        << "." << endl;
+      }
+      f->itime = _time;
+      
+      // Pass VC "back"
+      if(!_input_queue[subnet][n][c].empty() && !f->tail) {
+        Flit * const nf = _input_queue[subnet][n][c].front();
+        nf->vc = f->vc;
+      }
+      
+      if((_sim_state == warming_up) || (_sim_state == running)) {
+        ++_sent_flits[c][n];
+        if(f->head) {
+          ++_sent_packets[c][n];
         }
-        
+      }
+      
 #ifdef TRACK_FLOWS
-        ++_injected_flits[c][n];
+      ++_injected_flits[c][n];
 #endif
-        
-        _net[subnet]->WriteFlit(f, n);
-        
-      }
+      
+      _net[subnet]->WriteFlit(f, n);
+      
     }
   }
+}
+
+void GPUTrafficManager::_StepRetire( int subnet )
+{
   //Send the credit To the network
-  for(int subnet = 0; subnet < _subnets; ++subnet) {
-    for(int n = 0; n < _nodes; ++n) {
-      map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-      if(iter != flits[subnet].end()) {
-        Flit * const f = iter->second;
+  for(int n = 0; n < _nodes; ++n) {
+    Flit * const f = _step_ejected_flits[subnet][n];
+    if(f) {
+      _step_ejected_flits[subnet][n] = NULL;
 
-        f->atime = _time;
-        if(f->watch) {
-          *gWatchOut << GetSimTime() << " | "
-          << "node" << n << " | "
-          << "Injecting credit for VC " << f->vc
-          << " into subnet " << subnet
-          << "." << endl;
-        }
-        Credit * const c = Credit::New();
-        c->vc.insert(f->vc);
-        _net[subnet]->WriteCredit(c, n);
-        
+      f->atime = _time;
+      if(f->watch) {
+        *gWatchOut << GetSimTime() << " | "
+        << "node" << n << " | "
+        << "Injecting credit for VC " << f->vc
+        << " into subnet " << subnet
+        << "." << endl;
+      }
+      Credit * const c = Credit::New();
+      c->vc.insert(f->vc);
+      _net[subnet]->WriteCredit(c, n);
+      
 #ifdef TRACK_FLOWS
-        ++_ejected_flits[f->cl][n];
+      ++_ejected_flits[f->cl][n];
 #endif
-        
-        _RetireFlit(f, n);
-      }
+      
+      _RetireFlit(f, n);
     }
-    flits[subnet].clear();
-    // _InteralStep here
-    _net[subnet]->Evaluate( );
-    _net[subnet]->WriteOutputs( );
   }
-  
-  ++_time;
-  assert(_time);
-  if(gTrace){
-    cout<<"TIME "<<_time<<endl;
-  }
-  
 }
 
@@ -31,6 +31,7 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <pthread.h>
 
 #include "config_utils.hpp"
 #include "stats.hpp"
@@ -47,8 +48,39 @@ protected:
   virtual int  _IssuePacket( int source, int cl );
   virtual void _Step();
   
+  // the three parts of _Step() that interact with the interface buffers;
+  // they always run on the calling thread
+  void _StepEject( int subnet );
+  void _StepInject( int subnet );
+  void _StepRetire( int subnet );
+  
   // record size of _partial_packets for each subnet
   vector<vector<vector<list<Flit *> > > > _input_queue;
+  // number of flits in _input_queue of each node (all classes), size: [subnets][nodes]
+  // list::size() is linear, this is what InterconnectInterface::HasBuffer checks
+  vector<vector<unsigned> > _input_queue_flits;
+  
+  // flits ejected in the current step, size: [subnets][nodes]
+  vector<vector<Flit *> > _step_ejected_flits;
+  
+  // parallel stepping: the routers and channels of all subnets are split
+  // across _step_threads workers (the calling thread is worker 0). Each
+  // TimedModule phase is run by all workers between two barriers, so the
+  // ReadInputs/Evaluate/WriteOutputs ordering of the sequential model holds.
+  enum _StepPhase { _phase_read_inputs, _phase_evaluate, _phase_write_outputs, _phase_exit };
+  
+  int _step_threads;
+  vector<vector<TimedModule *> > _step_modules; // size: [_step_threads]
+  vector<pthread_t> _step_workers;
+  pthread_barrier_t _step_start;
+  pthread_barrier_t _step_done;
+  _StepPhase _step_phase;
+  
+  bool _ParallelStepSupported( const Configuration &config ) const;
+  void _CreateStepWorkers( );
+  void _RunStepPhase( _StepPhase phase );
+  void _StepModules( int worker, _StepPhase phase );
+  static void * _StepWorker( void * arg );
   
 public:
   
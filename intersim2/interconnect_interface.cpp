@@ -252,12 +252,10 @@ bool InterconnectInterface::HasBuffer(unsigned deviceID, unsigned int size) cons
 {
   bool has_buffer = false;
   unsigned int n_flits = size / _flit_size + ((size % _flit_size)? 1:0);
-  int icntID = _node_map.find(deviceID)->second;
-  
-  has_buffer = _traffic_manager->_input_queue[0][icntID][0].size() +n_flits <= _input_buffer_capacity;
+  int icntID = _node_map[deviceID];
   
-  if ((_subnets>1) && deviceID >= _n_shader) // deviceID is memory node
-    has_buffer = _traffic_manager->_input_queue[1][icntID][0].size() +n_flits <= _input_buffer_capacity;
+  int subnet = ((_subnets>1) && deviceID >= _n_shader) ? 1 : 0; // memory nodes inject into the reply network
+  has_buffer = _traffic_manager->_input_queue_flits[subnet][icntID] + n_flits <= _input_buffer_capacity;
 
   return has_buffer;
 }
@@ -378,12 +376,17 @@ void InterconnectInterface::_CreateBuffer()
     for (unsigned node=0;node < nodes;++node){
       _ejection_buffer[subnet][node].resize(_vcs);
       _boundary_buffer[subnet][node].resize(_vcs);
+      for (int vc=0;vc<_vcs;++vc) {
+        _boundary_buffer[subnet][node][vc].SetCapacity(_boundary_buffer_capacity);
+      }
     }
   }
 }
 
 void InterconnectInterface::_CreateNodeMap(unsigned n_shader, unsigned n_mem, unsigned n_node, int use_map)
 {
+  _node_map.assign(n_node, 0);
+  _reverse_node_map.assign(n_node, 0);
   if (use_map) {
     map<unsigned, vector<unsigned> > preset_memory_map;
     
@@ -477,40 +480,30 @@ void InterconnectInterface::_DisplayMap(int dim,int count)
 void* InterconnectInterface::_BoundaryBufferItem::PopPacket()
 {
   assert (_packet_n);
-  void * data = NULL;
-  void * flit_data = _buffer.front();
-  while (data == NULL) {
-    assert(flit_data == _buffer.front()); //all flits must belong to the same packet
-    if (_tail_flag.front()) {
-      data = _buffer.front();
-      _packet_n--;
-    }
-    _buffer.pop();
-    _tail_flag.pop();
-  }
+  void * data = _packets[_head];
+  _flits -= _packet_flits[_head];
+  _head = (_head + 1) % _packets.size();
+  _packet_n--;
   return data;
 }
 
 void* InterconnectInterface::_BoundaryBufferItem::TopPacket() const
 {
   assert (_packet_n);
-  void* data = NULL;
-  void* temp_d = _buffer.front();
-  while (data==NULL) {
-    if (_tail_flag.front()) {
-      data = _buffer.front();
-    }
-    assert(temp_d == _buffer.front()); //all flits must belong to the same packet
-  }
-  return data;
-  
+  return _packets[_head];
 }
 
 void InterconnectInterface::_BoundaryBufferItem::PushFlitData(void* data,bool is_tail)
 {
-  _buffer.push(data);
-  _tail_flag.push(is_tail);
+  assert (_flits < _packets.size());
+  _flits++;
+  _partial_flits++;
   if (is_tail) {
+    assert(data);
+    unsigned slot = (_head + _packet_n) % _packets.size();
+    _packets[slot] = data;
+    _packet_flits[slot] = _partial_flits;
+    _partial_flits = 0;
     _packet_n++;
   }
 }
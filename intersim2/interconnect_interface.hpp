@@ -76,19 +76,27 @@ public:
   
 protected:
   
+  // Reassembly buffer between the network and the node. Flits of a packet
+  // arrive back to back on a VC, so only the number of flits is tracked and
+  // the packet (carried by its tail flit) is stored once in a fixed-size
+  // ring when it is complete.
   class _BoundaryBufferItem {
   public:
-    _BoundaryBufferItem():_packet_n(0) {}
-    inline unsigned Size(void) const { return _buffer.size(); }
+    _BoundaryBufferItem():_head(0),_packet_n(0),_flits(0),_partial_flits(0) {}
+    void SetCapacity(unsigned flits) { _packets.resize(flits); _packet_flits.resize(flits); }
+    inline unsigned Size(void) const { return _flits; }
     inline bool HasPacket() const { return _packet_n; }
     void* PopPacket();
     void* TopPacket() const;
     void PushFlitData(void* data,bool is_tail);
     
   private:
-    queue<void *> _buffer;
-    queue<bool> _tail_flag;
+    vector<void *> _packets;        // ring of complete packets
+    vector<unsigned> _packet_flits; // flits held by each packet in _packets
+    unsigned _head;
     int _packet_n;
+    unsigned _flits;
+    unsigned _partial_flits;        // flits of the packet still being received
   };
   typedef queue<Flit*> _EjectionBufferItem;
   
@@ -120,10 +128,10 @@ protected:
   //deviceID to icntID map
   //deviceID : Starts from 0 for shaders and then continues until mem nodes
   //which starts at location n_shader and then continues to n_shader+n_mem (last device)
-  map<unsigned, unsigned> _node_map;
+  vector<unsigned> _node_map;
   
   //icntID to deviceID map
-  map<unsigned, unsigned> _reverse_node_map;
+  vector<unsigned> _reverse_node_map;
 
 };
 
@@ -51,4 +51,7 @@ IntersimConfig::IntersimConfig()
   _int_map["input_buffer_size"] = 0;
   _int_map["ejection_buffer_size"] = 0; // if left zero the simulator will use the vc_buf_size instead
   _int_map["boundary_buffer_size"] = 16;
+
+  // number of host threads stepping the routers and channels (0 or 1 = sequential)
+  _int_map["parallel_step_threads"] = 0;
 }
\ No newline at end of file
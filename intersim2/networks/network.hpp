@@ -111,6 +111,7 @@ public:
   const vector<CreditChannel *> & GetChannelsCred(){return _chan_cred;}
   const vector<Router *> & GetRouters(){return _routers;}
   Router * GetRouter(int index) {return _routers[index];}
+  const deque<TimedModule *> & GetTimedModules() const {return _timed_modules;}
   int NumRouters() const {return _size;}
 };
 
@@ -37,6 +37,7 @@ CUstream_st::CUstream_st()
     m_pending = false;
     m_uid = sm_next_stream_uid++;
     pthread_mutex_init(&m_lock,NULL);
+    pthread_cond_init(&m_done_cond,NULL);
 }
 
 bool CUstream_st::empty()
@@ -58,12 +59,10 @@ bool CUstream_st::busy()
 void CUstream_st::synchronize() 
 {
     // called by host thread
-    bool done=false;
-    do{
-        pthread_mutex_lock(&m_lock);
-        done = m_operations.empty();
-        pthread_mutex_unlock(&m_lock);
-    } while ( !done );
+    pthread_mutex_lock(&m_lock);
+    while( !m_operations.empty() ) 
+        pthread_cond_wait(&m_done_cond,&m_lock);
+    pthread_mutex_unlock(&m_lock);
 }
 
 void CUstream_st::push( const stream_operation &op )
@@ -81,6 +80,7 @@ void CUstream_st::record_next_done()
     assert(m_pending);
     m_operations.pop_front();
     m_pending=false;
+    pthread_cond_broadcast(&m_done_cond);
     pthread_mutex_unlock(&m_lock);
 }
 
@@ -124,35 +124,37 @@ void stream_operation::do_operation( gpgpu_sim *gpu )
         if(g_debug_execution >= 3)
             printf("memcpy host-to-device\n");
         gpu->memcpy_to_gpu(m_device_address_dst,m_host_address_src,m_cnt);
-        m_stream->record_next_done();
+        record_memcpy(gpu,COPY_HOST_TO_DEVICE,m_device_address_dst,0,true);
         break;
     case stream_memcpy_device_to_host:
         if(g_debug_execution >= 3)
             printf("memcpy device-to-host\n");
         gpu->memcpy_from_gpu(m_host_address_dst,m_device_address_src,m_cnt);
-        m_stream->record_next_done();
+        record_memcpy(gpu,COPY_DEVICE_TO_HOST,0,m_device_address_src,true);
         break;
     case stream_memcpy_device_to_device:
         if(g_debug_execution >= 3)
             printf("memcpy device-to-device\n");
         gpu->memcpy_gpu_to_gpu(m_device_address_dst,m_device_address_src,m_cnt); 
-        m_stream->record_next_done();
+        record_memcpy(gpu,COPY_DEVICE_TO_DEVICE,m_device_address_dst,m_device_address_src,true);
         break;
     case stream_memcpy_to_symbol:
         if(g_debug_execution >= 3)
             printf("memcpy to symbol\n");
         gpgpu_ptx_sim_memcpy_symbol(m_symbol,m_host_address_src,m_cnt,m_offset,1,gpu);
-        m_stream->record_next_done();
+        record_memcpy(gpu,COPY_HOST_TO_DEVICE,0,0,false);
         break;
     case stream_memcpy_from_symbol:
         if(g_debug_execution >= 3)
             printf("memcpy from symbol\n");
         gpgpu_ptx_sim_memcpy_symbol(m_symbol,m_host_address_dst,m_cnt,m_offset,0,gpu);
-        m_stream->record_next_done();
+        record_memcpy(gpu,COPY_DEVICE_TO_HOST,0,0,false);
         break;
     case stream_kernel_launch:
         if( gpu->can_start_kernel() ) {
-        	gpu->set_cache_config(m_kernel->name());
+        	gpgpu_ptx_assemble_kernel( m_kernel->entry() );
+        	gpu->set_cache_config(*m_kernel);
+        	m_kernel->set_stream_uid(m_stream->get_uid());
         	printf("kernel \'%s\' transfer to GPU hardware scheduler\n", m_kernel->name().c_str() );
             if( m_sim_mode )
                 gpgpu_cuda_ptx_sim_main_func( *m_kernel );
@@ -174,6 +176,17 @@ void stream_operation::do_operation( gpgpu_sim *gpu )
     fflush(stdout);
 }
 
+void stream_operation::record_memcpy( gpgpu_sim *gpu, enum copy_direction dir, size_t dst, size_t src, bool dma )
+{
+    // the data has already been copied functionally; with copy engines the 
+    // operation retires once the transfer completes in simulated time
+    // (symbol addresses are not global memory addresses, so no DMA traffic)
+    if( gpu->timed_memcpy() ) 
+        gpu->launch_memcpy(m_stream,dir,dst,src,m_cnt,dma);
+    else
+        m_stream->record_next_done();
+}
+
 void stream_operation::print( FILE *fp ) const
 {
     fprintf(fp," stream operation " );
@@ -195,6 +208,8 @@ stream_manager::stream_manager( gpgpu_sim *gpu, bool cuda_launch_blocking )
     m_service_stream_zero = false;
     m_cuda_launch_blocking = cuda_launch_blocking;
     pthread_mutex_init(&m_lock,NULL);
+    pthread_cond_init(&m_work_cond,NULL);
+    pthread_cond_init(&m_done_cond,NULL);
 }
 
 bool stream_manager::operation( bool * sim)
@@ -203,8 +218,11 @@ bool stream_manager::operation( bool * sim)
     bool check=check_finished_kernel();
     if(check)
         m_gpu->print_stats();// print cpu,net,mem status [@@@]
+    bool copied=check_finished_memcpy();
     stream_operation op =front();
     op.do_operation( m_gpu );
+    if( check || copied || !op.is_noop() ) 
+        pthread_cond_broadcast(&m_done_cond); // wake a host thread waiting in push()/destroy_stream()
     pthread_mutex_unlock(&m_lock);
     //pthread_mutex_lock(&m_lock);
     // simulate a clock cycle on the GPU
@@ -220,6 +238,18 @@ bool stream_manager::check_finished_kernel()
 
 }
 
+bool stream_manager::check_finished_memcpy()
+{
+    // called by gpu simulation thread
+    bool copied = false;
+    CUstream_st *stream;
+    while( (stream = m_gpu->finished_memcpy()) != NULL ) {
+        stream->record_next_done();
+        copied = true;
+    }
+    return copied;
+}
+
 bool stream_manager::register_finished_kernel(unsigned grid_uid)
 {
     // called by gpu simulation thread
@@ -285,7 +315,7 @@ void stream_manager::destroy_stream( CUstream_st *stream )
     // called by host thread
     pthread_mutex_lock(&m_lock);
     while( !stream->empty() )
-        ; 
+        pthread_cond_wait(&m_done_cond,&m_lock); 
     std::list<CUstream_st *>::iterator s;
     for( s=m_streams.begin(); s != m_streams.end(); s++ ) {
         if( *s == stream ) {
@@ -358,15 +388,13 @@ void stream_manager::push( stream_operation op )
 {
     struct CUstream_st *stream = op.get_stream();
 
+    pthread_mutex_lock(&m_lock);
     // block if stream 0 (or concurrency disabled) and pending concurrent operations exist
-    bool block= !stream || m_cuda_launch_blocking;
-    while(block) {
-        pthread_mutex_lock(&m_lock);
-        block = !concurrent_streams_empty();
-        pthread_mutex_unlock(&m_lock);
-    };
+    if( !stream || m_cuda_launch_blocking ) {
+        while( !concurrent_streams_empty() ) 
+            pthread_cond_wait(&m_done_cond,&m_lock);
+    }
 
-    pthread_mutex_lock(&m_lock);
     if( stream && !m_cuda_launch_blocking ) {
         stream->push(op);
     } else {
@@ -375,18 +403,30 @@ void stream_manager::push( stream_operation op )
     }
     if(g_debug_execution >= 3)
        print_impl(stdout);
-    pthread_mutex_unlock(&m_lock);
+    pthread_cond_broadcast(&m_work_cond);
+
     if( m_cuda_launch_blocking || stream == NULL ) {
-        unsigned int wait_amount = 100; 
-        unsigned int wait_cap = 100000; // 100ms 
-        while( !empty() ) {
-            // sleep to prevent CPU hog by empty spin
-            // sleep time increased exponentially ensure fast response when needed 
-            usleep(wait_amount); 
-            wait_amount *= 2; 
-            if (wait_amount > wait_cap) 
-               wait_amount = wait_cap; 
-        }
+        // the gpu thread signals m_done_cond each time it retires an operation
+        while( !empty() ) 
+            pthread_cond_wait(&m_done_cond,&m_lock);
     }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void stream_manager::wait_for_work( const bool *stop )
+{
+    // called by gpu simulation thread
+    pthread_mutex_lock(&m_lock);
+    while( empty() && !*stop ) 
+        pthread_cond_wait(&m_work_cond,&m_lock);
+    pthread_mutex_unlock(&m_lock);
+}
+
+void stream_manager::wake_gpu_thread()
+{
+    // called by host thread after changing the condition passed to wait_for_work()
+    pthread_mutex_lock(&m_lock);
+    pthread_cond_broadcast(&m_work_cond);
+    pthread_mutex_unlock(&m_lock);
 }
 
@@ -29,6 +29,7 @@
 #define STREAM_MANAGER_H_INCLUDED
 
 #include "abstract_hardware_model.h"
+#include "gpgpu-sim/copy_engine.h"
 #include <list>
 #include <pthread.h>
 #include <time.h>
@@ -156,6 +157,8 @@ public:
     void set_stream( CUstream_st *stream ) { m_stream = stream; }
 
 private:
+    void record_memcpy( gpgpu_sim *gpu, enum copy_direction dir, size_t dst, size_t src, bool dma );
+
     struct CUstream_st *m_stream;
 
     bool m_done;
@@ -230,6 +233,7 @@ private:
     bool m_pending; // front operation has started but not yet completed
 
     pthread_mutex_t m_lock; // ensure only one host or gpu manipulates stream operation at one time
+    pthread_cond_t m_done_cond; // signaled by the gpu thread when an operation completes
 };
 
 class stream_manager {
@@ -237,6 +241,7 @@ public:
     stream_manager( gpgpu_sim *gpu, bool cuda_launch_blocking );
     bool register_finished_kernel(unsigned grid_uid  );
     bool check_finished_kernel(  );
+    bool check_finished_memcpy(  );
     stream_operation front();
     void add_stream( CUstream_st *stream );
     void destroy_stream( CUstream_st *stream );
@@ -246,6 +251,8 @@ public:
     void print( FILE *fp);
     void push( stream_operation op );
     bool operation(bool * sim);
+    void wait_for_work( const bool *stop );
+    void wake_gpu_thread();
 private:
     void print_impl( FILE *fp);
 
@@ -256,6 +263,8 @@ private:
     CUstream_st m_stream_zero;
     bool m_service_stream_zero;
     pthread_mutex_t m_lock;
+    pthread_cond_t m_work_cond; // host -> gpu thread: an operation was pushed (or the simulation ends)
+    pthread_cond_t m_done_cond; // gpu thread -> host: an operation completed
 };
 
 #endif